@@ -0,0 +1,285 @@
+// Decode cost of a full-depth book message: JSON (the live decoder) against
+// the compact book codec, with the stream-VByte level arrays decoded by the
+// scalar loop and by the SSSE3 shuffle path.
+//
+// Before timing, the formats are checked on generated data: the SIMD and
+// scalar stream-VByte decoders must agree with the input, and decoding an
+// encoded sequence of keyframes, deltas, scale changes and level removals
+// must give back every frame, also when starting at a later keyframe. Out of
+// range values must be refused. Exits non-zero on any mismatch.
+//
+// Usage: book_codec_benchmark [levels] [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/utils.h"
+#include "storage/book_codec.h"
+#include "storage/stream_vbyte.h"
+#include "websocket/market_data_decoder.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string makeFrame(std::mt19937& rng, int levels) {
+    std::uniform_int_distribution<int> lots(1, 500000000);
+    char buf[96];
+    std::string frame = "{\"arg\":{\"channel\":\"books\",\"instId\":\"BTC-USDT\"},\"action\":\"snapshot\",\"data\":[{\"asks\":[";
+    for (int i = 0; i < levels; ++i) {
+        std::snprintf(buf, sizeof(buf), "%s[\"%.1f\",\"%.8f\",\"0\",\"%d\"]", i ? "," : "",
+                      95000.1 + 0.1 * i, lots(rng) / 1e8, 1 + i % 7);
+        frame += buf;
+    }
+    frame += "],\"bids\":[";
+    for (int i = 0; i < levels; ++i) {
+        std::snprintf(buf, sizeof(buf), "%s[\"%.1f\",\"%.8f\",\"0\",\"%d\"]", i ? "," : "",
+                      95000.0 - 0.1 * i, lots(rng) / 1e8, 1 + i % 7);
+        frame += buf;
+    }
+    frame += "],\"ts\":\"1700000000000\",\"checksum\":-1234,\"prevSeqId\":-1,\"seqId\":100}]}";
+    return frame;
+}
+
+// Mismatches found by the checks below
+int failures = 0;
+
+void expect(bool ok, const char* what, size_t index) {
+    if (!ok && failures++ < 10) {
+        std::fprintf(stderr, "round trip mismatch: %s (#%zu)\n", what, index);
+    }
+}
+
+// Every length class, count 0..70 so the SIMD tail and short inputs are covered
+void checkStreamVbyte(std::mt19937_64& rng) {
+    const uint64_t limits[] = {0xFF, 0xFFFF, 0xFFFFFFFF, UINT64_MAX};
+    for (size_t count = 0; count <= 70; ++count) {
+        std::vector<uint64_t> values(count);
+        for (auto& value : values) {
+            uint64_t limit = limits[rng() % 4];
+            value = limit == UINT64_MAX ? rng() : rng() % (limit + 1);
+        }
+        if (count > 0) {
+            values[0] = UINT64_MAX;
+        }
+
+        std::vector<uint8_t> packed;
+        storage::streamVbyteEncode(values.data(), values.size(), packed);
+        const uint8_t* end = packed.data() + packed.size();
+        std::vector<uint64_t> scalar(count);
+        std::vector<uint64_t> simd(count);
+        expect(storage::streamVbyteDecodeScalar(packed.data(), end, count, scalar.data()) == end &&
+                   scalar == values, "stream-VByte scalar", count);
+        expect(storage::streamVbyteDecode(packed.data(), end, count, simd.data()) == end && simd == values,
+               "stream-VByte SIMD", count);
+        if (count > 0) {
+            expect(!storage::streamVbyteDecode(packed.data(), end - 1, count, simd.data()),
+                   "stream-VByte truncated input accepted", count);
+        }
+    }
+}
+
+struct SourceFrame {
+    size_t stream;
+    bool snapshot;
+    int64_t receivedNs;
+    int64_t exchangeMs;
+    int64_t seqId;
+    int64_t prevSeqId;
+    storage::BookEncoder::StringLevels bids;
+    storage::BookEncoder::StringLevels asks;
+};
+
+bool sameLevels(const core::PriceLevels& decoded, const storage::BookEncoder::StringLevels& source) {
+    if (decoded.size() != source.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < source.size(); ++i) {
+        if (decoded[i].price != core::utils::parseDecimalDouble(source[i].first) ||
+            decoded[i].quantity != core::utils::parseDecimalDouble(source[i].second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameFrame(const storage::BookFrame& frame, const SourceFrame& source, const storage::BookDecoder& decoder,
+               const std::vector<storage::BookStreamInfo>& streams) {
+    const storage::BookStreamInfo* info = decoder.getStream(frame.stream);
+    return info && info->route == streams[source.stream].route && info->symbol == streams[source.stream].symbol &&
+           frame.isSnapshot() == source.snapshot && frame.receivedNs == source.receivedNs &&
+           frame.exchangeMs == source.exchangeMs && frame.seqId == source.seqId &&
+           frame.prevSeqId == source.prevSeqId && sameLevels(frame.bids, source.bids) &&
+           sameLevels(frame.asks, source.asks);
+}
+
+// Two interleaved streams whose price scale grows over time, with level
+// removals, gaps in the sequence, deep and empty sides, and a jump that
+// overflows the old touch at the new scale and forces a keyframe
+void checkBookCodec(std::mt19937_64& rng) {
+    std::vector<storage::BookStreamInfo> streams = {
+        {1, "OKX", "BTC-USDT", "books"}, {2, "OKX", "ETH-USDT", "books"}};
+    std::vector<SourceFrame> frames;
+    int64_t seq[2] = {100, 5000};
+    char price[48];
+    char size[48];
+    for (size_t n = 0; n < 400; ++n) {
+        SourceFrame frame{n % 2, n < 2 || n % 97 == 0, static_cast<int64_t>(1000 + n * 7919 - (n % 5) * 3000),
+                          static_cast<int64_t>(1700000000000 + n / 3), 0, 0, {}, {}};
+        size_t s = frame.stream;
+        frame.prevSeqId = frame.snapshot ? -1 : (n % 13 == 0 ? seq[s] + 3 : seq[s]);
+        frame.seqId = seq[s] = seq[s] + 1 + static_cast<int64_t>(n % 4 == 0 ? 10 : 0);
+
+        int decimals = 1 + static_cast<int>(n / 150); // grows from 1 to 3
+        double base = s == 0 ? 95000.0 : 3500.0;
+        size_t levels = n % 11 == 0 ? 0 : (n % 3 == 0 ? 1 + rng() % 40 : 1 + rng() % 8);
+        for (int side = 0; side < 2; ++side) {
+            auto& out = side == 0 ? frame.bids : frame.asks;
+            for (size_t i = 0; i < levels; ++i) {
+                double offset = (1 + i + rng() % 3) * 0.1 * (side == 0 ? -1 : 1);
+                std::snprintf(price, sizeof(price), "%.*f", decimals, base + offset + (n % 50) * 0.1);
+                bool remove = !frame.snapshot && rng() % 6 == 0;
+                std::snprintf(size, sizeof(size), "%.*f", static_cast<int>(rng() % 9),
+                              remove ? 0.0 : (1 + rng() % 100000000) / 1e4);
+                out.emplace_back(price, size);
+            }
+        }
+        frames.push_back(std::move(frame));
+    }
+    // A large touch at one decimal, then six decimals: the old touch no longer fits
+    frames.push_back({0, false, 9000000, 1700000001000, seq[0] + 1, seq[0], {{"9100000000.1", "1"}}, {}});
+    frames.push_back({0, false, 9000001, 1700000001001, seq[0] + 2, seq[0] + 1, {{"0.000001", "2"}}, {}});
+
+    constexpr size_t kBlockStart = 200;
+    storage::BookEncoder encoder;
+    std::vector<uint8_t> encoded;
+    std::vector<size_t> offsets;
+    for (size_t n = 0; n < frames.size(); ++n) {
+        const SourceFrame& frame = frames[n];
+        if (n == kBlockStart) {
+            encoder.reset(); // as at a compacted block boundary
+        }
+        offsets.push_back(encoded.size());
+        expect(encoder.encode(streams[frame.stream], frame.snapshot, frame.receivedNs, frame.exchangeMs, frame.seqId,
+                              frame.prevSeqId, frame.bids, frame.asks, encoded), "encode refused", n);
+    }
+    offsets.push_back(encoded.size());
+
+    // Beyond 2^53 units, and more than 18 digits: refused, nothing written
+    size_t before = encoded.size();
+    expect(!encoder.encode(streams[0], false, 0, 0, 0, 0, {{"123456789012.123456", "1"}}, {}, encoded) &&
+               !encoder.encode(streams[0], false, 0, 0, 0, 0, {{"1.0000000000000000001", "1"}}, {}, encoded) &&
+               encoded.size() == before, "out of range value accepted", 0);
+
+    storage::BookDecoder decoder;
+    storage::BookFrame decoded;
+    const uint8_t* in = encoded.data();
+    const uint8_t* end = in + encoded.size();
+    for (size_t n = 0; n < frames.size(); ++n) {
+        in = in ? decoder.decode(in, end, decoded) : nullptr;
+        expect(in && sameFrame(decoded, frames[n], decoder, streams), "decode", n);
+    }
+    expect(in == end, "trailing bytes", frames.size());
+    expect(in && decoded.isKeyframe(), "forced keyframe", frames.size() - 1);
+
+    // Starting at the block boundary, where both streams key again
+    storage::BookDecoder seeker;
+    in = encoded.data() + offsets[kBlockStart];
+    for (size_t n = kBlockStart; n < frames.size() && in; ++n) {
+        in = seeker.decode(in, end, decoded);
+        expect(in && sameFrame(decoded, frames[n], seeker, streams), "decode from keyframe", n);
+    }
+
+    // Starting mid-block: deltas of streams not yet keyed are skipped
+    in = encoded.data() + offsets[kBlockStart + 2];
+    seeker.reset();
+    in = seeker.decode(in, end, decoded);
+    expect(in && decoded.stream == storage::BookFrame::kUnknownStream, "delta without keyframe", kBlockStart + 2);
+
+    // Keyframes of rebuilt books, from numeric levels
+    core::PriceLevels bids = {{95000.1, 0.25}, {95000.0, 1.5}, {94999.9, 0.00000001}};
+    core::PriceLevels asks = {{95000.2, 3.0}};
+    std::vector<uint8_t> keyframe;
+    storage::BookEncoder keyEncoder;
+    storage::BookDecoder keyDecoder;
+    expect(keyEncoder.encodeKeyframe(streams[0], 42, 1700000000000, 7, bids, asks, keyframe) &&
+               keyDecoder.decode(keyframe.data(), keyframe.data() + keyframe.size(), decoded) &&
+               decoded.isKeyframe() && decoded.seqId == 7 && decoded.bids.size() == bids.size() &&
+               decoded.bids[2].quantity == bids[2].quantity && decoded.asks[0].price == asks[0].price,
+           "keyframe from numeric levels", 0);
+}
+
+template <typename Fn>
+double nanosPerCall(size_t iterations, Fn&& fn) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int levels = argc > 1 ? std::atoi(argv[1]) : 400;
+    size_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000;
+
+    std::mt19937_64 checkRng(7);
+    checkStreamVbyte(checkRng);
+    checkBookCodec(checkRng);
+
+    std::mt19937 rng(42);
+    std::string json = makeFrame(rng, levels);
+
+    processing::BookUpdate update;
+    processing::decodeMarketData(json, update);
+
+    storage::BookEncoder encoder;
+    std::vector<uint8_t> encoded;
+    storage::BookStreamInfo info{update.route, update.exchange, update.symbol, update.channel};
+    encoder.encode(info, true, 0, 1700000000000, update.seqId, update.prevSeqId, update.bids, update.asks, encoded);
+
+    // Level arrays on their own, as stored in a frame
+    std::vector<uint64_t> values;
+    for (size_t i = 0; i < 2 * update.bids.size() + 2 * update.asks.size(); ++i) {
+        values.push_back(i % 2 ? static_cast<uint64_t>(rng() % 500000000) : 2);
+    }
+    std::vector<uint8_t> packed;
+    storage::streamVbyteEncode(values.data(), values.size(), packed);
+    std::vector<uint64_t> unpacked(values.size());
+
+    storage::BookDecoder check;
+    storage::BookFrame checked;
+    expect(check.decode(encoded.data(), encoded.data() + encoded.size(), checked) &&
+               sameLevels(checked.bids, update.bids) && sameLevels(checked.asks, update.asks),
+           "full-depth frame", 0);
+
+    double jsonNs = nanosPerCall(iterations, [&] { processing::decodeMarketData(json, update); });
+
+    storage::BookDecoder decoder;
+    storage::BookFrame frame;
+    const uint8_t* begin = encoded.data();
+    const uint8_t* end = begin + encoded.size();
+    double codecNs = nanosPerCall(iterations * 10, [&] { decoder.reset(); decoder.decode(begin, end, frame); });
+
+    double scalarNs = nanosPerCall(iterations * 50, [&] {
+        storage::streamVbyteDecodeScalar(packed.data(), packed.data() + packed.size(), values.size(), unpacked.data());
+    });
+    double simdNs = nanosPerCall(iterations * 50, [&] {
+        storage::streamVbyteDecode(packed.data(), packed.data() + packed.size(), values.size(), unpacked.data());
+    });
+
+    std::printf("%d levels per side: %zu bytes of JSON, %zu encoded (%.1fx)\n", levels, json.size(),
+                encoded.size(), static_cast<double>(json.size()) / encoded.size());
+    std::printf("JSON decode          %10.0f ns/msg\n", jsonNs);
+    std::printf("codec decode         %10.0f ns/msg (%.0fx faster)\n", codecNs, jsonNs / codecNs);
+    std::printf("level arrays scalar  %10.0f ns\n", scalarNs);
+    std::printf("level arrays %-8s %10.0f ns\n", storage::streamVbyteSimdAvailable() ? "SSSE3" : "(scalar)", simdNs);
+    expect(unpacked == values, "level arrays", 0);
+    std::printf("round trip checks: %s\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// Cost of feed capture on the dispatcher, and sustained journal throughput.
+//
+// Replays synthetic full-depth frames through FeedRecorder::capture() in
+// dispatcher-sized batches at full speed, timing each capture() call (the
+// only part on the live path), then reports how fast the recorder thread
+// wrote the journal.
+//
+// Usage: capture_benchmark [directory] [messages] [levels] [segment_mb]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/utils.h"
+#include "storage/journal_reader.h"
+#include "websocket/feed_recorder.h"
+#include "websocket/latency_histogram.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string makeFrame(std::mt19937& rng, double& mid, int levels) {
+    std::uniform_real_distribution<double> drift(-0.5, 0.5);
+    std::uniform_real_distribution<double> qty(0.001, 5.0);
+    mid += drift(rng);
+
+    char buf[64];
+    std::string frame = "{\"timestamp\":\"2025-05-01T12:00:00Z\",\"exchange\":\"OKX\",\"symbol\":\"BTC-USDT-SWAP\",\"asks\":[";
+    for (int i = 0; i < levels; ++i) {
+        std::snprintf(buf, sizeof(buf), "%s[\"%.1f\",\"%.3f\"]", i ? "," : "", mid + 0.1 * (i + 1), qty(rng));
+        frame += buf;
+    }
+    frame += "],\"bids\":[";
+    for (int i = 0; i < levels; ++i) {
+        std::snprintf(buf, sizeof(buf), "%s[\"%.1f\",\"%.3f\"]", i ? "," : "", mid - 0.1 * (i + 1), qty(rng));
+        frame += buf;
+    }
+    frame += "]}";
+    return frame;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string directory = argc > 1 ? argv[1] : "capture_benchmark";
+    size_t messages = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+    int levels = argc > 3 ? std::atoi(argv[3]) : 50;
+    size_t segmentMb = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 64;
+
+    std::mt19937 rng(42);
+    double mid = 95000.0;
+    std::vector<std::string> frames;
+    for (int i = 0; i < 256; ++i) {
+        frames.push_back(makeFrame(rng, mid, levels));
+    }
+
+    processing::FeedRecorder recorder(directory, segmentMb * 1024 * 1024);
+    if (!recorder.start()) {
+        std::fprintf(stderr, "Could not open a journal in %s\n", directory.c_str());
+        return 1;
+    }
+
+    // Same batch shape the dispatcher hands over
+    processing::MessageBatch batch;
+    processing::LatencyHistogram perBatch;
+    size_t sent = 0;
+    size_t inFlight = processing::FeedRecorder::kRingBytes / 2 / storage::recordSize(frames[0].size());
+    auto start = Clock::now();
+    while (sent < messages) {
+        batch.count = std::min(batch.capacity(), messages - sent);
+        for (size_t i = 0; i < batch.count; ++i) {
+            batch.messages[i].data = frames[(sent + i) % frames.size()];
+            batch.messages[i].receivedNs = core::utils::steadyClockNanos();
+        }
+
+        int64_t before = core::utils::steadyClockNanos();
+        recorder.capture(batch);
+        perBatch.record(core::utils::steadyClockNanos() - before);
+        sent += batch.count;
+
+        // Keep the producer from lapping the recorder on a slow disk
+        while (recorder.getStats().recorded + recorder.getStats().dropped + inFlight < sent) {
+            std::this_thread::yield();
+        }
+    }
+    recorder.stop();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    processing::CaptureStats stats = recorder.getStats();
+    processing::LatencySummary s = perBatch.summary();
+    std::printf("frames=%zu levels=%d frame_bytes=%zu batch=%zu\n", messages, levels, frames[0].size(), batch.capacity());
+    std::printf("capture() per batch: mean %.2f us, p50 %.2f us, p99 %.2f us, max %.2f us (%.0f ns/frame)\n",
+                s.mean, s.p50, s.p99, s.max, s.mean * 1000.0 / batch.capacity());
+    std::printf("journal: %llu frames, %.1f MB in %llu segments, %llu dropped, %.0f frames/s, %.0f MB/s\n",
+                static_cast<unsigned long long>(stats.recorded), stats.bytes / (1024.0 * 1024.0),
+                static_cast<unsigned long long>(stats.segments), static_cast<unsigned long long>(stats.dropped),
+                stats.recorded / seconds, stats.bytes / (1024.0 * 1024.0) / seconds);
+
+    // Read everything back to check the journal is complete
+    size_t readBack = 0;
+    for (const auto& path : storage::JournalReader::listSegments(directory)) {
+        storage::JournalReader reader;
+        storage::JournalRecord record;
+        if (reader.open(path)) {
+            while (reader.next(record)) {
+                ++readBack;
+            }
+        }
+    }
+    std::printf("read back %zu frames\n", readBack);
+
+    std::error_code ec;
+    std::filesystem::remove_all(directory, ec);
+    return readBack == stats.recorded ? 0 : 1;
+}
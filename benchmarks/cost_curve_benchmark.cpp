@@ -0,0 +1,118 @@
+// Cost of a full slippage/impact curve over many order sizes: the per-size
+// path (one book capture and walk per point, as calculateSlippageProfile
+// used to do) against the single-sweep SlippageModel::calculateSlippageProfile
+// and Simulator::simulateCurve, with one Simulator::simulate for scale.
+// Also reports the largest difference between the sweep and the per-size
+// results, which should be rounding only.
+//
+// Usage: cost_curve_benchmark [levels] [points] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/config.h"
+#include "core/orderbook.h"
+#include "models/simulator.h"
+#include "models/slippage_model.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::shared_ptr<core::OrderBook> makeBook(int levels) {
+    std::vector<std::pair<std::string, std::string>> bids;
+    std::vector<std::pair<std::string, std::string>> asks;
+    for (int i = 0; i < levels; ++i) {
+        bids.emplace_back(std::to_string(95000.0 - 0.1 * i), std::to_string(0.05 + 0.01 * (i % 13)));
+        asks.emplace_back(std::to_string(95000.1 + 0.1 * i), std::to_string(0.05 + 0.01 * (i % 11)));
+    }
+    auto orderBook = std::make_shared<core::OrderBook>();
+    orderBook->update("OKX", "BTC-USDT", bids, asks, "2024-01-01T00:00:00.000Z");
+    return orderBook;
+}
+
+template <typename Fn>
+double microsPerCall(int iterations, Fn&& fn) {
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int levels = argc > 1 ? std::atoi(argv[1]) : 400;
+    int points = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int iterations = argc > 3 ? std::atoi(argv[3]) : 100;
+
+    auto config = std::make_shared<core::Config>();
+    config->load("config.json"); // fee tiers; defaults apply without it
+
+    auto orderBook = makeBook(levels);
+    models::SlippageModel slippageModel;
+    double maxQuantity = 0.0;
+    for (const auto& level : orderBook->getAsks()) {
+        maxQuantity += level.quantity; // the curve spans the whole ask side
+    }
+
+    std::map<double, double> perSize;
+    double perSizeUs = microsPerCall(iterations, [&] {
+        perSize.clear();
+        for (int i = 1; i <= points; ++i) {
+            double quantity = maxQuantity * i / points;
+            perSize[quantity] = slippageModel.calculateSlippage(orderBook, quantity, true);
+        }
+    });
+
+    std::map<double, double> profile;
+    double profileUs = microsPerCall(iterations, [&] {
+        profile = slippageModel.calculateSlippageProfile(orderBook, maxQuantity, true, points);
+    });
+
+    models::Simulator simulator(config);
+    simulator.init();
+    simulator.setOrderType("USD");
+    std::vector<double> sizes(points);
+    double mid = orderBook->getMidPrice();
+    for (int i = 0; i < points; ++i) {
+        sizes[i] = mid * maxQuantity * (i + 1) / points;
+    }
+    models::BatchResult curve;
+    double curveUs = microsPerCall(iterations, [&] { simulator.simulateCurve(orderBook, sizes, true, curve); });
+    double simulateUs = microsPerCall(iterations, [&] { simulator.simulate(orderBook); });
+
+    // Same sizes as scenarios, priced by binary search each
+    std::vector<models::Scenario> scenarios;
+    for (double size : sizes) {
+        scenarios.push_back({size, true, config->getDefaultFeeTier(), config->getDefaultVolatility()});
+    }
+    models::BatchResult batch;
+    simulator.simulateBatch(orderBook, scenarios, batch);
+
+    double maxProfile = 0.0;
+    for (auto it = perSize.begin(), jt = profile.begin(); it != perSize.end() && jt != profile.end(); ++it, ++jt) {
+        maxProfile = std::max(maxProfile, std::abs(it->second - jt->second) / std::max(std::abs(it->second), 1e-12));
+    }
+    double maxCurve = 0.0;
+    for (int i = 0; i < points; ++i) {
+        maxCurve = std::max(maxCurve, std::abs(curve.netCost[i] - batch.netCost[i]) / std::max(batch.netCost[i], 1e-9));
+    }
+
+    std::printf("%d-point curve on a %d-level book\n", points, levels);
+    std::printf("%-26s %12s\n", "", "us");
+    std::printf("%-26s %12.1f\n", "slippage per size", perSizeUs);
+    std::printf("%-26s %12.1f\n", "calculateSlippageProfile", profileUs);
+    std::printf("%-26s %12.1f\n", "simulateCurve", curveUs);
+    std::printf("%-26s %12.1f\n", "one simulate", simulateUs);
+    std::printf("max relative difference: profile %.2e, curve against batch %.2e\n", maxProfile, maxCurve);
+    return 0;
+}
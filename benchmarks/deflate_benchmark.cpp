@@ -0,0 +1,130 @@
+// Bytes on the wire and CPU per message for L2 book frames with
+// permessage-deflate on vs off. Compression uses one deflate/inflate
+// context for the whole stream (context takeover), as a negotiated
+// WebSocket session would.
+//
+// Usage: deflate_benchmark [messages] [levels]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/beast/zlib.hpp>
+
+namespace {
+
+namespace zlib = boost::beast::zlib;
+using Clock = std::chrono::steady_clock;
+
+// gomarket-style full-depth snapshot with a slowly drifting mid
+std::string makeFrame(std::mt19937& rng, double& mid, int levels) {
+    std::uniform_real_distribution<double> drift(-0.5, 0.5);
+    std::uniform_real_distribution<double> qty(0.001, 5.0);
+    mid += drift(rng);
+
+    char buf[64];
+    std::string frame = "{\"timestamp\":\"2025-05-01T12:00:00Z\",\"exchange\":\"OKX\",\"symbol\":\"BTC-USDT-SWAP\",\"asks\":[";
+    for (int i = 0; i < levels; ++i) {
+        std::snprintf(buf, sizeof(buf), "%s[\"%.1f\",\"%.3f\"]", i ? "," : "", mid + 0.1 * (i + 1), qty(rng));
+        frame += buf;
+    }
+    frame += "],\"bids\":[";
+    for (int i = 0; i < levels; ++i) {
+        std::snprintf(buf, sizeof(buf), "%s[\"%.1f\",\"%.3f\"]", i ? "," : "", mid - 0.1 * (i + 1), qty(rng));
+        frame += buf;
+    }
+    frame += "]}";
+    return frame;
+}
+
+double elapsedUs(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    int levels = argc > 2 ? std::atoi(argv[2]) : 400;
+
+    std::mt19937 rng(42);
+    double mid = 95000.0;
+    std::vector<std::string> frames;
+    frames.reserve(messages);
+    for (size_t i = 0; i < messages; ++i) {
+        frames.push_back(makeFrame(rng, mid, levels));
+    }
+
+    // Compression off: the receive path is a single copy into the pooled buffer
+    std::string received;
+    received.reserve(256 * 1024);
+    size_t rawBytes = 0;
+    auto start = Clock::now();
+    for (const auto& frame : frames) {
+        received.assign(frame.data(), frame.size());
+        rawBytes += received.size();
+    }
+    double copyUs = elapsedUs(start);
+
+    // Compression on: deflate as the server would, then inflate as the client does
+    zlib::deflate_stream deflater;
+    deflater.reset(6, 15, 8, zlib::Strategy::normal);
+    std::vector<std::vector<char>> compressed;
+    compressed.reserve(messages);
+    size_t wireBytes = 0;
+
+    start = Clock::now();
+    for (const auto& frame : frames) {
+        std::vector<char> out(frame.size() + 1024);
+        zlib::z_params zs;
+        zs.next_in = frame.data();
+        zs.avail_in = frame.size();
+        zs.next_out = out.data();
+        zs.avail_out = out.size();
+        boost::system::error_code ec;
+        deflater.write(zs, zlib::Flush::sync, ec);
+        out.resize(zs.total_out);
+        wireBytes += out.size();
+        compressed.push_back(std::move(out));
+    }
+    double deflateUs = elapsedUs(start);
+
+    zlib::inflate_stream inflater;
+    inflater.reset(15);
+    std::vector<char> inflated(256 * 1024);
+    size_t inflatedBytes = 0;
+
+    start = Clock::now();
+    for (const auto& frame : compressed) {
+        zlib::z_params zs;
+        zs.next_in = frame.data();
+        zs.avail_in = frame.size();
+        zs.next_out = inflated.data();
+        zs.avail_out = inflated.size();
+        boost::system::error_code ec;
+        inflater.write(zs, zlib::Flush::sync, ec);
+        if (ec && ec != zlib::error::need_buffers) {
+            std::fprintf(stderr, "inflate failed: %s\n", ec.message().c_str());
+            return 1;
+        }
+        received.assign(inflated.data(), zs.total_out);
+        inflatedBytes += received.size();
+    }
+    double inflateUs = elapsedUs(start);
+
+    if (inflatedBytes != rawBytes) {
+        std::fprintf(stderr, "round trip mismatch: %zu != %zu bytes\n", inflatedBytes, rawBytes);
+        return 1;
+    }
+
+    std::printf("messages=%zu levels=%d\n", messages, levels);
+    std::printf("%-12s %14s %14s\n", "mode", "bytes/msg", "client us/msg");
+    std::printf("%-12s %14.0f %14.3f\n", "off", double(rawBytes) / messages, copyUs / messages);
+    std::printf("%-12s %14.0f %14.3f\n", "deflate", double(wireBytes) / messages, inflateUs / messages);
+    std::printf("ratio %.2fx, server deflate %.3f us/msg\n", double(rawBytes) / wireBytes, deflateUs / messages);
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Per-message handoff latency between the feed thread and the processing
+// thread: moodycamel::ConcurrentQueue (MPMC) vs processing::SpscRing.
+//
+// Usage: queue_handoff_benchmark [messages] [payload_bytes] [interval_ns]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <concurrentqueue.h>
+
+#include "websocket/spsc_ring.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct StampedMessage {
+    int64_t sentNs = 0;
+    std::string data;
+};
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+struct Result {
+    double throughput;
+    double p50;
+    double p99;
+    double p999;
+    double max;
+};
+
+template <typename Queue>
+Result run(Queue& queue, size_t messages, size_t payloadBytes, int64_t intervalNs) {
+    std::vector<int64_t> latencies;
+    latencies.reserve(messages);
+    std::atomic<bool> ready{false};
+
+    std::thread consumer([&]() {
+        StampedMessage msg;
+        ready = true;
+        while (latencies.size() < messages) {
+            if (queue.try_dequeue(msg)) {
+                latencies.push_back(nowNs() - msg.sentNs);
+            }
+        }
+    });
+
+    while (!ready) {
+        std::this_thread::yield();
+    }
+
+    std::string payload(payloadBytes, 'x');
+    auto start = Clock::now();
+    int64_t next = nowNs();
+    for (size_t i = 0; i < messages; ++i) {
+        if (intervalNs > 0) {
+            while (nowNs() < next) {
+            }
+            next += intervalNs;
+        }
+
+        StampedMessage msg{nowNs(), payload};
+        while (!queue.try_enqueue(std::move(msg))) {
+            msg.sentNs = nowNs();
+        }
+    }
+    consumer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto at = [&](double q) { return latencies[static_cast<size_t>(q * (latencies.size() - 1))] / 1000.0; };
+    return {messages / seconds, at(0.50), at(0.99), at(0.999), latencies.back() / 1000.0};
+}
+
+void print(const char* name, const Result& r) {
+    std::printf("%-8s %14.0f %10.2f %10.2f %10.2f %10.2f\n", name, r.throughput, r.p50, r.p99, r.p999, r.max);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t payloadBytes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 512;
+    int64_t intervalNs = argc > 3 ? std::strtoll(argv[3], nullptr, 10) : 1000;
+    const size_t capacity = 100000;
+
+    std::printf("messages=%zu payload=%zuB interval=%lldns\n", messages, payloadBytes,
+                static_cast<long long>(intervalNs));
+    std::printf("%-8s %14s %10s %10s %10s %10s\n", "queue", "msgs/s", "p50 us", "p99 us", "p99.9 us", "max us");
+
+    {
+        moodycamel::ConcurrentQueue<StampedMessage> queue(capacity);
+        print("mpmc", run(queue, messages, payloadBytes, intervalNs));
+    }
+    {
+        processing::SpscRing<StampedMessage> ring(capacity);
+        print("spsc", run(ring, messages, payloadBytes, intervalNs));
+    }
+
+    return 0;
+}
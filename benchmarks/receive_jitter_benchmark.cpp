@@ -0,0 +1,134 @@
+// Receive jitter against the local mock exchange, with kernel-default socket
+// settings vs the performance.socket / io_thread_* settings from config.json.
+//
+// Start the server first, without bursts or disconnects:
+//   mock_exchange_server --port 9443 --rate 1000
+// then:
+//   receive_jitter_benchmark [host] [port] [rate] [messages] [config]
+//
+// Jitter is the deviation of each inter-arrival gap from the server's send
+// interval, so anything above a few microseconds is added by the receive path.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include "core/config.h"
+#include "core/utils.h"
+#include "websocket/latency_histogram.h"
+#include "websocket/socket_tuning.h"
+
+namespace {
+
+namespace beast = boost::beast;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+struct RunSettings {
+    const char* name;
+    core::SocketTuning socket;
+    bool tuneThread = false;
+    int cpu = -1;
+    std::string policy = "other";
+    int priority = 0;
+};
+
+void run(const RunSettings& settings, const std::string& host, const std::string& port,
+         double rate, size_t messages) {
+    processing::LatencyHistogram jitter;
+    std::string applied;
+    std::string threadApplied = "default";
+    int64_t expectedNs = static_cast<int64_t>(1e9 / rate);
+    std::string error;
+
+    // Own thread so thread tuning does not leak into the next run
+    std::thread reader([&]() {
+        try {
+            if (settings.tuneThread) {
+                threadApplied = websocket::applyIoThreadTuning(settings.cpu, settings.policy, settings.priority);
+            }
+
+            net::io_context ioc;
+            tcp::resolver resolver(ioc);
+            beast::websocket::stream<tcp::socket> ws(ioc);
+            net::connect(ws.next_layer(), resolver.resolve(host, port));
+            applied = websocket::applySocketTuning(ws.next_layer(), settings.socket);
+            ws.handshake(host, "/ws");
+
+            beast::flat_buffer buffer;
+            int64_t last = 0;
+            for (size_t i = 0; i < messages; ++i) {
+                ws.read(buffer);
+                int64_t now = core::utils::steadyClockNanos();
+                if (settings.socket.quickAck) {
+                    websocket::rearmQuickAck(ws.next_layer());
+                }
+                buffer.consume(buffer.size());
+
+                // Skip the first gaps while the connection settles
+                if (last != 0 && i > 10) {
+                    jitter.record(std::llabs((now - last) - expectedNs));
+                }
+                last = now;
+            }
+
+            beast::error_code ec;
+            ws.next_layer().close(ec);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+    });
+    reader.join();
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+
+    processing::LatencySummary s = jitter.summary();
+    std::printf("%-8s %10.2f %10.2f %10.2f %10.2f  %s; %s\n", settings.name,
+                s.mean, s.p50, s.p99, s.max, applied.c_str(), threadApplied.c_str());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    std::string port = argc > 2 ? argv[2] : "9443";
+    double rate = argc > 3 ? std::atof(argv[3]) : 1000.0;
+    size_t messages = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 20000;
+    std::string configPath = argc > 5 ? argv[5] : "config.json";
+
+    core::Config config;
+    if (!config.load(configPath)) {
+        std::fprintf(stderr, "Could not load %s\n", configPath.c_str());
+        return 1;
+    }
+
+    RunSettings baseline{"default", core::SocketTuning{0, false, 0, false}};
+
+    RunSettings tuned{"tuned", config.getSocketTuning()};
+    std::vector<int> cpus = config.getIoThreadCpus();
+    tuned.tuneThread = true;
+    tuned.cpu = cpus.empty() ? -1 : cpus.front();
+    tuned.policy = config.getIoThreadPolicy();
+    tuned.priority = config.getIoThreadPriority();
+
+    std::printf("%s:%s rate=%.0f msg/s messages=%zu\n", host.c_str(), port.c_str(), rate, messages);
+    std::printf("%-8s %10s %10s %10s %10s  %s\n", "sockets", "mean us", "p50 us", "p99 us", "max us", "applied");
+
+    try {
+        run(baseline, host, port, rate, messages);
+        run(tuned, host, port, rate, messages);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Benchmark failed (is mock_exchange_server running?): %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Cost of evaluating a grid of order configurations (sizes x sides x fee
+// tiers x volatilities) on one book: Simulator::simulateBatch against the
+// per-scenario path of Simulator::simulate, which locks and copies the book
+// for every model of every scenario. Also reports the largest difference
+// between the two, which should be rounding only.
+//
+// Usage: scenario_batch_benchmark [levels] [sizes] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/config.h"
+#include "core/orderbook.h"
+#include "models/simulator.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::shared_ptr<core::OrderBook> makeBook(int levels) {
+    std::vector<std::pair<std::string, std::string>> bids;
+    std::vector<std::pair<std::string, std::string>> asks;
+    for (int i = 0; i < levels; ++i) {
+        bids.emplace_back(std::to_string(95000.0 - 0.1 * i), std::to_string(0.05 + 0.01 * (i % 13)));
+        asks.emplace_back(std::to_string(95000.1 + 0.1 * i), std::to_string(0.05 + 0.01 * (i % 11)));
+    }
+    auto orderBook = std::make_shared<core::OrderBook>();
+    orderBook->update("OKX", "BTC-USDT", bids, asks, "2024-01-01T00:00:00.000Z");
+    return orderBook;
+}
+
+// What simulate() does for one scenario, with the models it creates in init()
+struct PerScenario {
+    models::AlmgrenChrissModel marketImpactModel;
+    models::SlippageModel slippageModel;
+    models::FeeModel feeModel;
+    models::MakerTakerModel makerTakerModel;
+
+    explicit PerScenario(std::shared_ptr<core::Config> config) : feeModel(config) {}
+
+    void run(const std::shared_ptr<core::OrderBook>& orderBook, const std::vector<models::Scenario>& scenarios,
+             std::vector<double>& netCost) {
+        for (size_t i = 0; i < scenarios.size(); ++i) {
+            const models::Scenario& scenario = scenarios[i];
+            double price = orderBook->getMidPrice();
+            double assetQuantity = scenario.quantity / price;
+            double makerRatio = makerTakerModel.predictMakerRatio(orderBook, assetQuantity, scenario.volatility);
+            double slippagePct = slippageModel.calculateSlippage(orderBook, assetQuantity, scenario.isBuy);
+            double marketImpactPct =
+                marketImpactModel.calculateMarketImpact(orderBook, assetQuantity, scenario.isBuy) / price;
+            double fees = feeModel.calculateFees("OKX", scenario.feeTier, assetQuantity, price, makerRatio);
+            netCost[i] = price * assetQuantity * slippagePct + price * assetQuantity * marketImpactPct + fees;
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int levels = argc > 1 ? std::atoi(argv[1]) : 400;
+    int sizes = argc > 2 ? std::atoi(argv[2]) : 50;
+    int iterations = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    auto config = std::make_shared<core::Config>();
+    config->load("config.json"); // fee tiers; defaults apply without it
+    std::vector<std::string> tiers;
+    for (const auto& tier : config->getFeeTiers("OKX")) {
+        tiers.push_back(tier.name);
+    }
+    if (tiers.empty()) {
+        tiers.push_back("VIP 0");
+    }
+
+    std::vector<models::Scenario> scenarios;
+    for (int size = 1; size <= sizes; ++size) {
+        for (bool isBuy : {true, false}) {
+            for (const std::string& tier : tiers) {
+                for (double volatility : {0.1, 0.2, 0.4, 0.8}) {
+                    scenarios.push_back({10000.0 * size, isBuy, tier, volatility});
+                }
+            }
+        }
+    }
+
+    auto orderBook = makeBook(levels);
+    models::Simulator simulator(config);
+    simulator.init();
+    simulator.setExchange("OKX");
+    simulator.setOrderType("USD");
+
+    PerScenario perScenario(config);
+    std::vector<double> netCost(scenarios.size());
+    models::BatchResult batch;
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        perScenario.run(orderBook, scenarios, netCost);
+    }
+    double perScenarioUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        simulator.simulateBatch(orderBook, scenarios, batch);
+    }
+    double batchUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+    double maxRelative = 0.0;
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        double scale = std::max(std::abs(netCost[i]), 1e-9);
+        maxRelative = std::max(maxRelative, std::abs(batch.netCost[i] - netCost[i]) / scale);
+    }
+
+    std::printf("%zu scenarios on a %d-level book\n", scenarios.size(), levels);
+    std::printf("%-14s %12s %12s\n", "", "us/batch", "ns/scenario");
+    std::printf("%-14s %12.1f %12.1f\n", "per scenario", perScenarioUs, perScenarioUs * 1000.0 / scenarios.size());
+    std::printf("%-14s %12.1f %12.1f\n", "batch", batchUs, batchUs * 1000.0 / scenarios.size());
+    std::printf("speedup %.1fx, max relative difference in net cost %.2e\n", perScenarioUs / batchUs, maxRelative);
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Throughput of models::SimulationEngine as the instrument count and the
+// worker count grow. One producer per instrument keeps its book changing as
+// fast as it can; every worker is therefore always busy and the run rate
+// is bounded by the simulation work and the available cores.
+//
+// Usage: simulation_engine_benchmark [instruments] [seconds] [levels]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/config.h"
+#include "core/orderbook.h"
+#include "models/simulation_engine.h"
+
+namespace {
+
+std::shared_ptr<core::OrderBook> makeBook(const std::string& symbol, int levels) {
+    std::vector<std::pair<std::string, std::string>> bids;
+    std::vector<std::pair<std::string, std::string>> asks;
+    for (int i = 0; i < levels; ++i) {
+        bids.emplace_back(std::to_string(100.0 - 0.01 * i), "5");
+        asks.emplace_back(std::to_string(100.01 + 0.01 * i), "5");
+    }
+    auto orderBook = std::make_shared<core::OrderBook>();
+    orderBook->update("OKX", symbol, bids, asks, "2024-01-01T00:00:00.000Z");
+    return orderBook;
+}
+
+// Simulations per second with workers threads over instruments books
+double runsPerSecond(const std::shared_ptr<core::Config>& config, int workers, int instruments, int seconds,
+                     int levels) {
+    models::SimulationEngine engine(config, workers);
+    std::vector<std::shared_ptr<core::OrderBook>> books;
+    for (int i = 0; i < instruments; ++i) {
+        std::string asset = "ASSET" + std::to_string(i) + "-USDT";
+        books.push_back(makeBook(asset, levels));
+        engine.addInstrument("OKX", asset, books.back());
+    }
+    engine.start();
+
+    std::atomic<bool> running{true};
+    std::vector<std::thread> producers;
+    for (auto& orderBook : books) {
+        producers.emplace_back([&, orderBook] {
+            std::vector<std::pair<std::string, std::string>> bids(1);
+            std::vector<std::pair<std::string, std::string>> none;
+            for (uint64_t n = 0; running; ++n) {
+                bids[0] = {std::to_string(100.0 - 0.01 * (n % 50)), std::to_string(1 + n % 7)};
+                orderBook->applyDelta(bids, none, "2024-01-01T00:00:00.000Z");
+                engine.notifyBookUpdate(orderBook);
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // warm up
+    uint64_t startRuns = engine.getRunCount();
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    uint64_t runs = engine.getRunCount() - startRuns;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    running = false;
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    engine.stop();
+    return runs / elapsed;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int instruments = argc > 1 ? std::atoi(argv[1]) : 16;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 2;
+    int levels = argc > 3 ? std::atoi(argv[3]) : 400;
+
+    auto config = std::make_shared<core::Config>();
+    config->load("config.json"); // fee tiers; defaults apply without it
+
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::printf("%d instruments, %d-level books, %d hardware threads\n", instruments, levels, cores);
+    std::printf("%8s %14s %10s\n", "workers", "runs/s", "scaling");
+    double single = 0.0;
+    for (int workers = 1; workers <= std::max(cores, 1); workers *= 2) {
+        double rate = runsPerSecond(config, workers, instruments, seconds, levels);
+        if (workers == 1) {
+            single = rate;
+        }
+        std::printf("%8d %14.0f %9.2fx\n", workers, rate, single > 0.0 ? rate / single : 0.0);
+    }
+    return 0;
+}
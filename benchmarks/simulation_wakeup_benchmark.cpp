@@ -0,0 +1,159 @@
+// Staleness of continuous simulation results: the time from a book update to
+// the result computed from it, for the event-driven simulator (woken by each
+// update) against the former loop that re-simulated every interval.
+//
+// A producer applies deltas to one book at a fixed rate; each result is
+// timed against the book's update time it was computed from.
+//
+// Usage: simulation_wakeup_benchmark [updates-per-second] [seconds] [poll-interval-ms]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/config.h"
+#include "core/orderbook.h"
+#include "core/utils.h"
+#include "models/simulator.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Update times of the book, and the results with the update time they were computed from
+struct Recorder {
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    std::mutex mutex;
+    std::vector<TimePoint> updates;                     // producer only
+    std::vector<std::pair<TimePoint, TimePoint>> results; // (book update time, published)
+
+    void record(const models::SimulationResult& result) {
+        auto now = std::chrono::system_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        results.emplace_back(result.timestamp, now);
+    }
+
+    // For each update: time until the first result computed from it or a later version
+    std::vector<double> staleness() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<double> micros;
+        size_t r = 0;
+        for (const TimePoint& update : updates) {
+            while (r < results.size() && results[r].first < update) {
+                ++r;
+            }
+            if (r == results.size()) {
+                break;
+            }
+            micros.push_back(std::chrono::duration<double, std::micro>(results[r].second - update).count());
+        }
+        std::sort(micros.begin(), micros.end());
+        return micros;
+    }
+};
+
+double percentile(const std::vector<double>& sorted, double p) {
+    return sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+std::shared_ptr<core::OrderBook> makeBook() {
+    std::vector<std::pair<std::string, std::string>> bids;
+    std::vector<std::pair<std::string, std::string>> asks;
+    for (int i = 0; i < 200; ++i) {
+        bids.emplace_back(std::to_string(95000.0 - 0.1 * i), "0.5");
+        asks.emplace_back(std::to_string(95000.1 + 0.1 * i), "0.5");
+    }
+    auto orderBook = std::make_shared<core::OrderBook>();
+    orderBook->update("OKX", "BTC-USDT", bids, asks, "2024-01-01T00:00:00.000Z");
+    return orderBook;
+}
+
+// Applies one delta every period for the duration, calling notify after each
+void produce(const std::shared_ptr<core::OrderBook>& orderBook, std::chrono::nanoseconds period,
+             std::chrono::seconds duration, Recorder& recorder, const std::function<void()>& notify) {
+    std::vector<std::pair<std::string, std::string>> bids(1);
+    std::vector<std::pair<std::string, std::string>> none;
+    uint64_t updates = 0;
+    auto start = Clock::now();
+    for (auto next = start; Clock::now() - start < duration; next += period) {
+        std::this_thread::sleep_until(next);
+        bids[0] = {std::to_string(95000.0 - 0.1 * (updates % 50)), std::to_string(0.1 + updates % 7)};
+        orderBook->applyDelta(bids, none, "2024-01-01T00:00:00.000Z");
+        recorder.updates.push_back(orderBook->getLastUpdateTime());
+        notify();
+        ++updates;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double rate = argc > 1 ? std::atof(argv[1]) : 1000.0;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 3;
+    int pollMs = argc > 3 ? std::atoi(argv[3]) : 100;
+    auto period = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / rate));
+
+    auto config = std::make_shared<core::Config>();
+    config->load("config.json"); // fee tiers; defaults apply without it
+
+    // Event-driven: every applied version wakes the simulator
+    Recorder eventDriven;
+    uint64_t eventRuns = 0;
+    {
+        models::Simulator simulator(config);
+        simulator.init();
+        simulator.registerResultCallback([&](const models::SimulationResult& result) { eventDriven.record(result); });
+        auto orderBook = makeBook();
+        simulator.startContinuousSimulation(orderBook);
+        produce(orderBook, period, std::chrono::seconds(seconds), eventDriven, [&] { simulator.notifyBookUpdate(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        simulator.stopContinuousSimulation();
+        eventRuns = simulator.getContinuousRunCount();
+    }
+
+    // The former loop: simulate, then sleep for the update interval
+    Recorder polled;
+    uint64_t pollRuns = 0;
+    {
+        models::Simulator simulator(config);
+        simulator.init();
+        simulator.registerResultCallback([&](const models::SimulationResult& result) { polled.record(result); });
+        auto orderBook = makeBook();
+        std::atomic<bool> running{true};
+        std::thread poller([&] {
+            while (running) {
+                simulator.simulate(orderBook);
+                ++pollRuns;
+                std::this_thread::sleep_for(std::chrono::milliseconds(pollMs));
+            }
+        });
+        produce(orderBook, period, std::chrono::seconds(seconds), polled, [] {});
+        std::this_thread::sleep_for(std::chrono::milliseconds(pollMs + 10));
+        running = false;
+        poller.join();
+    }
+
+    std::printf("%.0f updates/s for %d s\n", rate, seconds);
+    std::printf("%-22s %10s %10s %12s %12s %12s\n", "", "updates", "runs", "p50 us", "p99 us", "max us");
+    char label[32];
+    std::snprintf(label, sizeof(label), "polling every %d ms", pollMs);
+    for (auto* recorder : {&eventDriven, &polled}) {
+        std::vector<double> staleness = recorder->staleness();
+        std::printf("%-22s %10zu %10llu %12.1f %12.1f %12.1f\n", recorder == &eventDriven ? "event-driven" : label,
+                    recorder->updates.size(),
+                    static_cast<unsigned long long>(recorder == &eventDriven ? eventRuns : pollRuns),
+                    percentile(staleness, 0.5), percentile(staleness, 0.99),
+                    staleness.empty() ? 0.0 : staleness.back());
+    }
+    return 0;
+}
@@ -20,6 +20,14 @@ struct Exchange {
     std::vector<std::string> spotAssets;
 };
 
+// Per-connection socket options for the feed (performance.socket)
+struct SocketTuning {
+    int receiveBufferBytes = 0; // SO_RCVBUF, 0 keeps the kernel default
+    bool tcpNoDelay = true;     // TCP_NODELAY
+    int busyPollUs = 0;         // SO_BUSY_POLL, 0 disables
+    bool quickAck = false;      // TCP_QUICKACK, re-armed after every read
+};
+
 class Config {
 public:
     Config() = default;
@@ -30,9 +38,15 @@ public:
 
     // WebSocket settings
     std::string getWebSocketEndpoint() const;
+    std::vector<std::string> getWebSocketEndpoints() const;
     void setWebSocketEndpoint(const std::string& endpoint);
     int getReconnectIntervalMs() const;
     int getPingIntervalMs() const;
+    int getConnectTimeoutMs() const;
+    bool isCompressionEnabled() const;
+    bool isArbitrationEnabled() const;
+    // websocket.subscriptions: (channel, instId) pairs for the OKX public feed
+    std::vector<std::pair<std::string, std::string>> getSubscriptions() const;
 
     // Exchange settings
     std::vector<Exchange> getExchanges() const;
@@ -48,7 +62,15 @@ public:
     std::string getDefaultExchange() const;
     std::string getDefaultAsset() const;
     std::string getDefaultOrderType() const;
-    int getUpdateIntervalMs() const;
+    // Shortest time between continuous simulation runs; 0 runs on every book update
+    int getMinSimulationIntervalMs() const;
+    // Levels per side each simulation captures from the book; 0 takes them all
+    int getSnapshotDepth() const;
+    // Simulate every configured (exchange, asset) pair that has a book
+    // (models::SimulationEngine) on this many workers; 0 matches
+    // performance.processing_threads so the shards line up with the decode stage
+    bool isSimulationEngineEnabled() const;
+    int getSimulationEngineThreads() const;
 
     // Logging settings
     std::string getLogLevel() const;
@@ -62,6 +84,19 @@ public:
     bool isMeasureLatencyEnabled() const;
     int getBufferSize() const;
     int getProcessingThreads() const;
+    std::string getQueueType() const;
+    std::string getWaitStrategy() const;
+    int getSpinIterations() const;
+    int getIoThreads() const;
+    std::vector<int> getIoThreadCpus() const;
+    std::string getIoThreadPolicy() const;
+    int getIoThreadPriority() const;
+    SocketTuning getSocketTuning() const;
+
+    // Capture settings
+    bool isCaptureEnabled() const;
+    std::string getCaptureDirectory() const;
+    size_t getCaptureSegmentBytes() const;
 
 private:
     nlohmann::json configData_;
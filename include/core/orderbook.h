@@ -4,8 +4,10 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <atomic>
 #include <chrono>
 #include <utility>
+#include <cstdint>
 
 namespace core {
 
@@ -16,6 +18,17 @@ struct OrderBookLevel {
 
 using PriceLevels = std::vector<OrderBookLevel>;
 
+// Levels and whole-book aggregates of one version, copied under one lock
+struct OrderBookSnapshot {
+    PriceLevels bids;             // best first, at most the requested depth
+    PriceLevels asks;
+    double totalBidVolume = 0.0;  // whole book, including levels beyond the depth
+    double totalAskVolume = 0.0;
+    std::chrono::system_clock::time_point lastUpdateTime;
+    int64_t seqId = -1;
+    uint64_t version = 0;
+};
+
 class OrderBook {
 public:
     OrderBook();
@@ -26,11 +39,39 @@ public:
                 const std::string& symbol, 
                 const std::vector<std::pair<std::string, std::string>>& bids,
                 const std::vector<std::pair<std::string, std::string>>& asks,
-                const std::string& timestamp);
+                const std::string& timestamp,
+                int64_t seqId = -1);
+
+    // Incremental update: a zero quantity removes the level. Returns false and
+    // leaves the book untouched if prevSeqId does not follow the last applied
+    // sequence number (a gap; the book needs a fresh snapshot).
+    bool applyDelta(const std::vector<std::pair<std::string, std::string>>& bids,
+                    const std::vector<std::pair<std::string, std::string>>& asks,
+                    const std::string& timestamp,
+                    int64_t prevSeqId = -1,
+                    int64_t seqId = -1);
+
+    // Same for levels already in numeric form, e.g. decoded from a compacted
+    // journal (storage::BookDecoder)
+    void update(const std::string& exchange,
+                const std::string& symbol,
+                const PriceLevels& bids,
+                const PriceLevels& asks,
+                std::chrono::system_clock::time_point timestamp,
+                int64_t seqId = -1);
+    bool applyDelta(const PriceLevels& bids,
+                    const PriceLevels& asks,
+                    std::chrono::system_clock::time_point timestamp,
+                    int64_t prevSeqId = -1,
+                    int64_t seqId = -1);
 
     // Snapshot retrieval
     PriceLevels getBids() const;
     PriceLevels getAsks() const;
+    // Best `depth` levels per side under one lock, into reused vectors
+    void getTopLevels(size_t depth, PriceLevels& bids, PriceLevels& asks) const;
+    // Same plus the aggregates and metadata of that version, into a reused snapshot
+    void getSnapshot(size_t depth, OrderBookSnapshot& snapshot) const;
     
     // Market data access
     double getBestBid() const;
@@ -52,6 +93,8 @@ public:
     std::string getSymbol() const;
     std::chrono::system_clock::time_point getTimestamp() const;
     std::chrono::system_clock::time_point getLastUpdateTime() const;
+    int64_t getSequenceId() const; // -1 if the feed carries no sequence numbers
+    uint64_t getVersion() const;   // bumped by every applied update; readable without the lock
     
     // Performance metrics
     int getLevelsCount(bool isBid) const;
@@ -62,6 +105,8 @@ private:
     std::string symbol_;
     std::chrono::system_clock::time_point timestamp_; // from exchange
     std::chrono::system_clock::time_point lastUpdateTime_; // local time
+    int64_t seqId_ = -1;
+    std::atomic<uint64_t> version_{0};
     std::vector<std::chrono::system_clock::time_point> updateTimes_; // for calculating frequency
     
     std::map<double, double, std::greater<double>> bids_; // price -> quantity, sorted by price desc
@@ -71,6 +116,8 @@ private:
     
     // Convert string price/quantity to double
     static double toDouble(const std::string& str);
+
+    void recordUpdateTime();
 };
 
 } // namespace core 
\ No newline at end of file
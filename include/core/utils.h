@@ -1,9 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <chrono>
 #include <ctime>
+#include <cstdint>
 #include <map>
 
 namespace core {
@@ -18,13 +20,34 @@ bool caseInsensitiveCompare(const std::string& a, const std::string& b);
 double round(double value, int decimals);
 double parseDouble(const std::string& str, double defaultValue = 0.0);
 int parseInt(const std::string& str, int defaultValue = 0);
+// Exact fixed-point parse of a plain decimal such as an exchange price or size
+// ("41006.8" gives mantissa 410068, decimals 1). No exponents or whitespace;
+// returns false for anything else or more than 18 significant digits.
+bool parseDecimal(std::string_view text, int64_t& mantissa, int& decimals);
+// std::stod replacement for the feed hot path, same result for plain
+// decimals; other forms fall back to parseDouble
+double parseDecimalDouble(std::string_view text, double defaultValue = 0.0);
 
 // Time utilities
 std::chrono::system_clock::time_point parseISOTimestamp(const std::string& timestamp);
 std::string formatTimestamp(const std::chrono::system_clock::time_point& timestamp);
 std::chrono::system_clock::time_point currentTime();
+// Replay pins currentTime() to the capture time of the frame being applied,
+// so time-based logic sees recorded time rather than wall time
+void setVirtualTime(const std::chrono::system_clock::time_point& timestamp);
+// Moves a set virtual clock forward to wallNs; never back, never starts it
+void advanceVirtualTime(int64_t wallNs);
+void clearVirtualTime();
+bool isVirtualTime();
 double getElapsedMilliseconds(const std::chrono::system_clock::time_point& start);
 double getElapsedMicroseconds(const std::chrono::high_resolution_clock::time_point& start);
+int64_t steadyClockNanos();
+int64_t systemClockNanos(const std::chrono::system_clock::time_point& timestamp);
+
+// Thread utilities
+bool setCurrentThreadAffinity(int cpu);
+// policy: "other", "fifo" or "rr"; priority is only used by the real-time policies
+bool setCurrentThreadScheduling(const std::string& policy, int priority);
 
 // Market data utilities
 double calculateVWAP(const std::map<double, double>& levels);
@@ -32,12 +55,19 @@ double calculateMarketImpact(const std::map<double, double>& levels, double quan
 std::vector<std::pair<double, double>> calculateCumulativeVolume(const std::map<double, double>& levels);
 
 // Statistical utilities
+// Pointer + count overloads work on columns in place (see storage::SnapshotReader)
 double mean(const std::vector<double>& values);
+double mean(const double* values, size_t count);
 double median(const std::vector<double>& values);
+double median(const double* values, size_t count);
 double standardDeviation(const std::vector<double>& values);
+double standardDeviation(const double* values, size_t count);
 double percentile(const std::vector<double>& values, double percentileRank);
+double percentile(const double* values, size_t count, double percentileRank);
 double skewness(const std::vector<double>& values);
+double skewness(const double* values, size_t count);
 double kurtosis(const std::vector<double>& values);
+double kurtosis(const double* values, size_t count);
 
 // Linear regression
 struct RegressionResult {
@@ -47,6 +77,7 @@ struct RegressionResult {
 };
 
 RegressionResult linearRegression(const std::vector<double>& x, const std::vector<double>& y);
+RegressionResult linearRegression(const double* x, const double* y, size_t count);
 double predict(const RegressionResult& regression, double x);
 
 } // namespace utils
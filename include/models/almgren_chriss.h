@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 #include "core/orderbook.h"
+#include "models/market_snapshot.h"
 
 namespace models {
 
@@ -20,6 +21,10 @@ public:
     double calculateMarketImpact(const std::shared_ptr<core::OrderBook>& orderBook, 
                                 double quantity, 
                                 bool isBuy) const;
+    // Same against a captured snapshot, without touching the book
+    double calculateMarketImpact(const MarketSnapshot& market,
+                                double quantity,
+                                bool isBuy) const;
     
     // Calculate optimal execution schedule for a large order
     struct ExecutionSchedule {
@@ -47,8 +52,8 @@ private:
     double riskAversion_;      // Risk aversion parameter (λ)
     
     // Helper calculation methods
-    double calculateTemporaryImpact(double rate, const std::shared_ptr<core::OrderBook>& orderBook) const;
-    double calculatePermanentImpact(double quantity, const std::shared_ptr<core::OrderBook>& orderBook) const;
+    double calculateTemporaryImpact(double rate, const MarketSnapshot& market) const;
+    double calculatePermanentImpact(double quantity, const MarketSnapshot& market) const;
 };
 
 } // namespace models 
\ No newline at end of file
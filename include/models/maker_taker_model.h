@@ -4,6 +4,7 @@
 #include <vector>
 #include "core/orderbook.h"
 #include "core/utils.h"
+#include "models/market_snapshot.h"
 
 namespace models {
 
@@ -17,19 +18,36 @@ public:
                          const std::vector<double>& spreads,
                          const std::vector<double>& volatilities,
                          const std::vector<double>& makerRatios);
+    // Contiguous columns, e.g. from storage::SnapshotReader::readColumn
+    void setTrainingData(const double* quantities,
+                         const double* spreads,
+                         const double* volatilities,
+                         const double* makerRatios,
+                         size_t count);
     bool train();
     
     // Predict maker-taker ratio for a given order
     double predictMakerRatio(const std::shared_ptr<core::OrderBook>& orderBook,
                            double quantity,
                            double volatility) const;
+    // Same against a captured snapshot, without touching the book
+    double predictMakerRatio(const MarketSnapshot& market,
+                           double quantity,
+                           double volatility) const;
     
     // Probability of maker vs taker execution
     double predictMakerProbability(const std::shared_ptr<core::OrderBook>& orderBook,
                                  double quantity,
                                  double volatility) const;
     
-    // Calculate probability curve over a range of quantities
+    // predictMakerRatio for count quantities at once, into ratios
+    void predictMakerRatioCurve(const MarketSnapshot& market,
+                                const double* quantities,
+                                size_t count,
+                                double volatility,
+                                double* ratios) const;
+    
+    // Calculate probability curve over a range of quantities; the book is captured once
     std::vector<std::pair<double, double>> calculateProbabilityCurve(
         const std::shared_ptr<core::OrderBook>& orderBook,
         double maxQuantity,
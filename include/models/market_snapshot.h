@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "core/orderbook.h"
+
+namespace models {
+
+// One version of a book and the features the models derive from it,
+// captured once per simulation (or batch) under a single lock and passed to
+// every model by reference, so that all of a result's parts describe the
+// same book and evaluating them takes no further locks
+struct MarketSnapshot {
+    core::OrderBookSnapshot book;
+    double bestBid = 0.0;
+    double bestAsk = 0.0;
+    double midPrice = 0.0;        // 0 unless both sides have levels
+    double spread = 0.0;
+    double relativeSpread = 0.0;  // spread / mid
+
+    // Running totals through each level, best first: quantity and price * quantity
+    std::vector<double> bidDepth;
+    std::vector<double> bidNotional;
+    std::vector<double> askDepth;
+    std::vector<double> askNotional;
+
+    // Copies the best depth levels per side under one lock; the side totals
+    // still cover the whole book. Returns false unless both sides have levels.
+    bool capture(const core::OrderBook& orderBook, size_t depth = std::numeric_limits<size_t>::max());
+
+    // Average price of a market order walking the side it takes from, best
+    // level first; any part beyond the captured levels fills at the last
+    // one's price. O(log levels). 0 if that side is empty.
+    double averageFillPrice(double quantity, bool isBuy) const;
+    // The same for count ascending quantities in one pass over the levels:
+    // O(levels + count)
+    void averageFillPrices(const double* quantities, size_t count, bool isBuy, double* prices) const;
+};
+
+} // namespace models
@@ -28,6 +28,8 @@ public:
     // Training methods
     void addTrainingPoint(double x, double y);
     void setTrainingData(const std::vector<double>& x, const std::vector<double>& y);
+    // Contiguous columns, e.g. from storage::SnapshotReader::readColumn
+    void setTrainingData(const double* x, const double* y, size_t count);
     bool train();
     void clearTrainingData();
     
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/config.h"
+#include "core/orderbook.h"
+#include "models/simulator.h"
+
+namespace models {
+
+// Latest simulation of one (exchange, asset) pair
+struct InstrumentResult {
+    std::string exchange;
+    std::string asset;
+    SimulationResult result{};
+    uint64_t bookVersion = 0; // book version the result was computed from; 0 before the first run
+    uint64_t runs = 0;
+};
+
+// A book of the feed and the instrument ID the decode stage routes it by
+struct FeedBook {
+    std::string instrument;
+    std::shared_ptr<core::OrderBook> orderBook;
+};
+
+// Runs a Simulator for each (exchange, asset) pair on a pool of workers.
+//
+// Instruments are sharded by feed instrument ID with the decode stage's hash
+// (processing::DecodeStage::workerFor). With simulator.engine_threads at 0
+// there are as many workers as decode workers, so each engine worker
+// simulates exactly the books one decode worker applies; with any other
+// count, one book's simulations still always run on the same thread. A
+// worker sleeps until notifyBookUpdate() reports a new version of one of its
+// books, then simulates every instrument of its shard whose book changed.
+// Notifications arriving during a pass coalesce into the next one.
+class SimulationEngine {
+public:
+    using BookResolver = std::function<FeedBook(const std::string& exchange, const std::string& asset)>;
+
+    // numWorkers <= 0 uses simulator.engine_threads, and when that is 0
+    // performance.processing_threads
+    explicit SimulationEngine(std::shared_ptr<core::Config> config, int numWorkers = 0);
+    ~SimulationEngine();
+
+    // Before start(). The simulator starts from the config defaults and may be
+    // adjusted until then; returns nullptr for a null book. feedInstrument is
+    // the shard key, the book's feed instrument ID; empty uses the asset.
+    std::shared_ptr<Simulator> addInstrument(const std::string& exchange, const std::string& asset,
+                                             std::shared_ptr<core::OrderBook> orderBook,
+                                             const std::string& feedInstrument = std::string());
+    // Every exchange's spot assets from the config; pairs bookFor returns no
+    // book for are skipped. Returns the number added.
+    size_t addConfiguredInstruments(const BookResolver& bookFor);
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    // Wakes the worker owning the book; cheap enough for the feed's book
+    // update handler. Books no instrument uses are ignored.
+    void notifyBookUpdate(const std::shared_ptr<core::OrderBook>& orderBook);
+
+    // Latest result of every instrument, in the order added. Publishing is
+    // held off on every worker while copying, so the view is one instant of
+    // all results rather than a mix taken across passes.
+    void getView(std::vector<InstrumentResult>& view) const;
+
+    size_t getInstrumentCount() const;
+    int getWorkerCount() const;
+    uint64_t getRunCount() const;
+    size_t workerFor(std::string_view instrument) const;
+
+private:
+    struct Instrument {
+        std::shared_ptr<core::OrderBook> orderBook;
+        std::shared_ptr<Simulator> simulator;
+        size_t worker = 0;
+        size_t slot = 0;                // into the worker's results
+        uint64_t simulatedVersion = 0;  // owned by the worker thread
+        bool simulated = false;
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::vector<size_t> instruments;
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        uint64_t wakeRequests = 0;      // guarded by wakeMutex
+        mutable std::mutex resultsMutex;
+        std::vector<InstrumentResult> results; // one slot per instrument of the shard
+        std::atomic<uint64_t> runs{0};
+    };
+
+    void runWorker(Worker& worker);
+    void wake(Worker& worker);
+
+    std::shared_ptr<core::Config> config_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<Instrument> instruments_;
+    std::unordered_map<const core::OrderBook*, size_t> bookWorkers_; // fixed once started
+    std::chrono::milliseconds minInterval_{0};
+    std::atomic<bool> running_{false};
+};
+
+} // namespace models
@@ -3,10 +3,13 @@
 #include <memory>
 #include <functional>
 #include <string>
+#include <vector>
 #include <map>
 #include <chrono>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <thread>
 
 #include "core/orderbook.h"
 #include "core/config.h"
@@ -14,6 +17,7 @@
 #include "models/slippage_model.h"
 #include "models/fee_model.h"
 #include "models/maker_taker_model.h"
+#include "models/market_snapshot.h"
 
 namespace models {
 
@@ -25,6 +29,28 @@ struct SimulationResult {
     double makerRatio;
     double internalLatency;  // measured processing time in microseconds
     std::chrono::system_clock::time_point timestamp;
+    uint64_t bookVersion;    // core::OrderBook::getVersion() of the book simulated
+};
+
+// One order configuration of a batch; exchange and order type are the simulator's
+struct Scenario {
+    double quantity = 0.0;    // in the order type's unit (USD or asset)
+    bool isBuy = true;
+    std::string feeTier;
+    double volatility = 0.0;
+};
+
+// Results of a batch or a cost curve as columns indexed like its scenarios
+// or sizes
+struct BatchResult {
+    std::vector<double> assetQuantity;         // order size in the asset
+    std::vector<double> expectedSlippage;      // percent
+    std::vector<double> expectedFees;
+    std::vector<double> expectedMarketImpact;  // percent
+    std::vector<double> netCost;
+    std::vector<double> makerRatio;
+    MarketSnapshot market;                     // the book version every scenario saw
+    double internalLatency = 0.0;              // whole batch, microseconds
 };
 
 class Simulator {
@@ -47,15 +73,42 @@ public:
     
     // Run simulation
     SimulationResult simulate(const std::shared_ptr<core::OrderBook>& orderBook);
+
+    // Evaluates every scenario against one snapshot of the book: the book is
+    // locked and walked once, and fee rates are looked up once per tier.
+    // Columns are reused between calls. Neither the latest result nor the
+    // callback is touched. Returns false, with zero columns, without a
+    // two-sided book.
+    bool simulateBatch(const std::shared_ptr<core::OrderBook>& orderBook,
+                       const std::vector<Scenario>& scenarios,
+                       BatchResult& results) const;
+
+    // Costs of the current order configuration at each of sizes (in the
+    // order type's unit) on one side. Ascending sizes are priced in a single
+    // pass over the book, so a 1000-point curve costs about one walk.
+    // Returns false, with zero columns, without a two-sided book.
+    bool simulateCurve(const std::shared_ptr<core::OrderBook>& orderBook,
+                       const std::vector<double>& sizes,
+                       bool isBuy,
+                       BatchResult& results) const;
     
     // Register callback for continuous simulation results
     void registerResultCallback(ResultCallback callback);
     void unregisterResultCallback();
     
-    // Start/stop continuous simulation
+    // Start/stop continuous simulation. The book is simulated on a thread of
+    // its own whenever notifyBookUpdate() reports a new version of it (or a
+    // parameter changes). Notifications arriving during a run, or within
+    // simulator.min_interval_ms of the last one, coalesce into a single run
+    // on the latest book. Stopping joins the thread.
     void startContinuousSimulation(const std::shared_ptr<core::OrderBook>& orderBook);
     void stopContinuousSimulation();
     bool isSimulationRunning() const;
+
+    // Wakes the continuous simulation; cheap enough for the feed's book
+    // update handler
+    void notifyBookUpdate();
+    uint64_t getContinuousRunCount() const;
     
     // Get current parameters
     std::string getExchange() const;
@@ -69,6 +122,11 @@ public:
     SimulationResult getLatestResult() const;
 
 private:
+    // Captures the book into market_ and evaluates every model against it
+    bool evaluate(const core::OrderBook& orderBook, SimulationResult& result);
+    void runContinuousSimulation(std::shared_ptr<core::OrderBook> orderBook);
+    void requestSimulation(bool parametersChanged);
+
     // Configuration
     std::shared_ptr<core::Config> config_;
     
@@ -92,8 +150,19 @@ private:
     mutable std::mutex resultMutex_;
     mutable std::mutex callbackMutex_;
     
+    // Per-simulation book capture, reused between runs
+    MarketSnapshot market_;
+    std::mutex marketMutex_;
+    size_t snapshotDepth_;
+    
     // Continuous simulation
     std::atomic<bool> continuousSimulationRunning_;
+    std::thread simulationThread_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCondition_;
+    uint64_t wakeRequests_ = 0;      // guarded by wakeMutex_
+    bool parametersChanged_ = false; // guarded by wakeMutex_
+    std::atomic<uint64_t> continuousRuns_{0};
 };
 
 } // namespace models 
\ No newline at end of file
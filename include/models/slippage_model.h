@@ -5,6 +5,7 @@
 #include <map>
 #include "core/orderbook.h"
 #include "core/utils.h"
+#include "models/market_snapshot.h"
 
 namespace models {
 
@@ -22,6 +23,8 @@ public:
     // Set model parameters
     void setModelType(ModelType type);
     void setDataPoints(const std::vector<double>& quantities, const std::vector<double>& slippages);
+    // Contiguous columns, e.g. from storage::SnapshotReader::readColumn
+    void setDataPoints(const double* quantities, const double* slippages, size_t count);
     
     // Train the model with historical data
     bool train();
@@ -35,8 +38,21 @@ public:
     double calculateSlippage(const std::shared_ptr<core::OrderBook>& orderBook,
                            double quantity,
                            bool isBuy) const;
+    // Same against a captured snapshot, without touching the book
+    double calculateSlippage(const MarketSnapshot& market,
+                           double quantity,
+                           bool isBuy) const;
+    
+    // calculateSlippage for count quantities at once, into slippage. Ascending
+    // quantities are priced in one pass over the levels, O(levels + count);
+    // others by a binary search each.
+    void calculateSlippageCurve(const MarketSnapshot& market,
+                                const double* quantities,
+                                size_t count,
+                                bool isBuy,
+                                double* slippage) const;
     
-    // Calculate slippage for a range of quantities
+    // Calculate slippage for a range of quantities; the book is captured once
     std::map<double, double> calculateSlippageProfile(const std::shared_ptr<core::OrderBook>& orderBook,
                                                    double maxQuantity,
                                                    bool isBuy,
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/orderbook.h"
+
+namespace storage {
+
+// Compact binary encoding of L2 book messages, used for compacted capture
+// journals (RecordType::BOOK_BLOCK and BOOK_KEYFRAMES).
+//
+// Prices are integers in ticks and sizes in lots, at a decimal scale per
+// stream that only ever grows (so every exchange string round-trips exactly).
+// The first level of each side is stored as a zigzag delta from the touch of
+// the previous frame, every further level as the gap from the level before,
+// so a typical level costs 1-2 bytes for the price and 2-4 for the size.
+// Level arrays are stream-VByte coded for SIMD decoding.
+//
+// One frame:
+//   varint   frame bytes after this field
+//   u8       flags (FrameFlag)
+//   varint   stream index
+//   keyframe only: varint route, then exchange, symbol and channel as
+//            varint length + bytes
+//   u8       price decimals << 4 | size decimals, only with SCALES
+//   varint   zigzag receive stamp delta (steady clock ns)
+//   varint   zigzag exchange time delta (ms)
+//   varint   zigzag seqId delta
+//   varint   zigzag prevSeqId - last seqId, only with EXPLICIT_PREV_SEQ
+//   varint   bid levels, ask levels; one byte (bids << 4 | asks) with
+//            SHORT_COUNTS
+//   stream   per level: zigzag price delta in ticks, size in lots
+//
+// All deltas are against the previous frame of the same stream. A keyframe
+// resets the stream's state and carries its definition, so decoding can
+// start at any keyframe.
+
+enum FrameFlag : uint8_t {
+    SNAPSHOT = 1,           // replaces the book; otherwise a delta (size 0 removes a level)
+    KEYFRAME = 2,           // stream state reset, definition included
+    EXPLICIT_PREV_SEQ = 4,  // prevSeqId does not follow the previous frame
+    SCALES = 8,             // decimals byte present: keyframes, and when a scale grows
+    SHORT_COUNTS = 16       // both level counts below 16, packed in one byte
+};
+
+constexpr int kMaxDecimals = 15;
+
+struct BookStreamInfo {
+    uint64_t route = 0;     // processing::routeKey(channel, symbol)
+    std::string exchange;
+    std::string symbol;
+    std::string channel;
+};
+
+struct BookFrame {
+    static constexpr uint32_t kUnknownStream = UINT32_MAX;
+
+    uint32_t stream = kUnknownStream;  // kUnknownStream if skipped (no keyframe seen yet)
+    uint8_t flags = 0;
+    int64_t receivedNs = 0;
+    int64_t exchangeMs = 0;
+    int64_t seqId = -1;
+    int64_t prevSeqId = -1;
+    core::PriceLevels bids;
+    core::PriceLevels asks;
+
+    bool isSnapshot() const { return flags & SNAPSHOT; }
+    bool isKeyframe() const { return flags & KEYFRAME; }
+};
+
+// Smallest number of decimals that represents value exactly, or -1 if it
+// needs more than kMaxDecimals
+int exactDecimals(double value);
+
+// Applies a decoded frame to its book: a snapshot replaces it, a delta goes
+// through OrderBook::applyDelta (false on a sequence gap)
+bool applyFrame(const BookFrame& frame, const BookStreamInfo& info, core::OrderBook& orderBook);
+
+class BookEncoder {
+public:
+    using StringLevels = std::vector<std::pair<std::string, std::string>>;
+
+    // Appends one frame for a decoded feed message. The first frame of a
+    // stream (or the first after reset()) is written as a keyframe. Returns
+    // false and appends nothing if a price or size is not a plain decimal.
+    bool encode(const BookStreamInfo& info, bool snapshot, int64_t receivedNs, int64_t exchangeMs,
+                int64_t seqId, int64_t prevSeqId, const StringLevels& bids, const StringLevels& asks,
+                std::vector<uint8_t>& out);
+
+    // Appends a keyframe snapshot of a whole book, e.g. one rebuilt from
+    // deltas, so that decoding can start here
+    bool encodeKeyframe(const BookStreamInfo& info, int64_t receivedNs, int64_t exchangeMs, int64_t seqId,
+                        const core::PriceLevels& bids, const core::PriceLevels& asks,
+                        std::vector<uint8_t>& out);
+
+    // Forget all stream state; every stream's next frame becomes a keyframe
+    void reset();
+
+    size_t getStreamCount() const;
+
+private:
+    struct Stream {
+        uint64_t route = 0;
+        bool keyed = false;    // state valid since the last reset()
+        int priceDecimals = 0;
+        int sizeDecimals = 0;
+        int64_t bidTicks = 0;  // touch of the previous frame
+        int64_t askTicks = 0;
+        int64_t receivedNs = 0;
+        int64_t exchangeMs = 0;
+        int64_t seqId = 0;
+    };
+
+    Stream& lookupStream(const BookStreamInfo& info, uint32_t& index);
+    void writeFrame(const BookStreamInfo& info, uint32_t index, Stream& stream, uint8_t flags,
+                    int priceDecimals, int sizeDecimals, int64_t receivedNs, int64_t exchangeMs,
+                    int64_t seqId, int64_t prevSeqId, std::vector<uint8_t>& out);
+
+    std::vector<Stream> streams_;
+    std::unordered_map<uint64_t, uint32_t> routes_; // route -> stream index
+
+    // Scratch reused between frames
+    std::vector<int64_t> bidTicks_, bidLots_, askTicks_, askLots_;
+    std::vector<int> bidDecimals_, askDecimals_;
+    std::vector<uint64_t> values_;
+    std::vector<uint8_t> body_;
+};
+
+class BookDecoder {
+public:
+    // Decodes the frame at in. Returns the start of the next frame, or
+    // nullptr if the frame is malformed or runs past end. Frames of streams
+    // whose keyframe has not been seen since reset() come back with
+    // frame.stream == kUnknownStream.
+    const uint8_t* decode(const uint8_t* in, const uint8_t* end, BookFrame& frame);
+
+    // Definition of a stream from its last keyframe, nullptr if unknown
+    const BookStreamInfo* getStream(uint32_t stream) const;
+
+    // Forget all streams, e.g. before seeking to a keyframe block
+    void reset();
+
+private:
+    struct Stream {
+        BookStreamInfo info;
+        bool keyed = false;
+        int priceDecimals = 0;
+        int sizeDecimals = 0;
+        int64_t bidTicks = 0;
+        int64_t askTicks = 0;
+        int64_t receivedNs = 0;
+        int64_t exchangeMs = 0;
+        int64_t seqId = 0;
+    };
+
+    std::vector<Stream> streams_;
+    std::vector<uint64_t> values_;
+};
+
+} // namespace storage
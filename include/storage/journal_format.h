@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+// On-disk layout of one capture journal segment:
+//
+//   SegmentHeader                      64 bytes
+//   RecordHeader + payload             padded to 8 bytes, repeated
+//   zeroes                             rest of the pre-allocated segment
+//
+// A record length of 0 marks the end of data, so a segment left behind by a
+// crash reads back up to its last complete record. Integers are stored in
+// host byte order.
+
+constexpr char kJournalMagic[8] = {'O', 'K', 'X', 'J', 'R', 'N', 'L', '1'};
+constexpr uint32_t kJournalVersion = 1;
+constexpr size_t kRecordAlignment = 8;
+constexpr const char* kJournalExtension = ".jrnl";
+
+enum class RecordType : uint16_t {
+    FRAME = 1,          // raw feed frame, exactly as received
+    BOOK_BLOCK = 2,     // encoded book frames (storage::BookEncoder), back to back
+    BOOK_KEYFRAMES = 3  // one keyframe per known book; decoding can start here
+};
+
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint64_t segmentIndex;     // position within one capture run
+    int64_t createdNs;         // wall clock
+    int64_t steadyToWallNs;    // add to a receive stamp to get wall-clock time
+    uint64_t dataBytes;        // record bytes after the header; 0 until closed
+    uint64_t recordCount;      // 0 until closed
+    uint64_t reserved;
+};
+static_assert(sizeof(SegmentHeader) == 64, "segment header layout changed");
+
+struct RecordHeader {
+    uint32_t length;           // payload bytes; written last
+    uint16_t type;             // RecordType
+    uint16_t line;             // feed line (see FeedArbitrator)
+    uint32_t session;          // feed connection generation
+    uint32_t reserved;
+    int64_t receivedNs;        // steady clock, taken off the socket
+};
+static_assert(sizeof(RecordHeader) == 24, "record header layout changed");
+
+inline size_t recordSize(size_t payloadBytes) {
+    return (sizeof(RecordHeader) + payloadBytes + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+} // namespace storage
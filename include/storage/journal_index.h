@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "storage/journal_format.h"
+
+namespace storage {
+
+// Sparse seek index of one journal segment, stored next to it as
+// <segment>.idx:
+//
+//   IndexHeader                        64 bytes
+//   IndexPoint[pointCount]             in journal order
+//   SequencePoint[sequenceCount]       sorted by route, then seqId
+//   keyframe bytes                     storage::BookEncoder keyframes
+//
+// A point marks a record boundary, with the books as they stood just before
+// it encoded as keyframes, so reading can start there without replaying the
+// segment from the top. In compacted journals the point is a BOOK_KEYFRAMES
+// record itself and carries no keyframes of its own. Sequence points map
+// (route, seqId) back to the point that precedes it.
+//
+// An index belongs to one closed segment; it is stale (and ignored) once the
+// segment's creation stamp or size no longer match.
+
+constexpr char kIndexMagic[8] = {'O', 'K', 'X', 'J', 'I', 'D', 'X', '1'};
+constexpr uint32_t kIndexVersion = 1;
+constexpr const char* kIndexExtension = ".idx";
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    int64_t segmentCreatedNs;  // SegmentHeader::createdNs of the indexed segment
+    uint64_t segmentDataBytes;
+    int64_t intervalNs;        // receive time between points
+    uint64_t pointCount;
+    uint64_t sequenceCount;
+    uint64_t keyframeBytes;
+};
+static_assert(sizeof(IndexHeader) == 64, "index header layout changed");
+
+struct IndexPoint {
+    int64_t receivedNs;        // receive stamp of the record at offset
+    uint64_t offset;           // record boundary in the segment
+    uint64_t record;           // ordinal of that record
+    uint64_t keyframeOffset;   // into the keyframe bytes
+    uint64_t keyframeBytes;    // 0 if the record itself is a keyframe block
+};
+static_assert(sizeof(IndexPoint) == 40, "index point layout changed");
+
+struct SequencePoint {
+    uint64_t route;
+    int64_t seqId;             // the book's sequence number at the point
+    uint64_t point;
+};
+static_assert(sizeof(SequencePoint) == 24, "sequence point layout changed");
+
+class JournalIndex {
+public:
+    static std::string pathFor(const std::string& segmentPath);
+
+    // Replaces the contents with the saved index of a segment. Returns false
+    // if it is missing, damaged or stale.
+    bool load(const std::string& segmentPath, const SegmentHeader& segment, uint64_t dataBytes);
+    bool save(const std::string& segmentPath) const;
+
+    // Starts a new index for a segment
+    void reset(const SegmentHeader& segment, uint64_t dataBytes, int64_t intervalNs);
+    // Points are added in journal order; keyframes may be empty
+    void addPoint(int64_t receivedNs, uint64_t offset, uint64_t record,
+                  const uint8_t* keyframes, size_t keyframeBytes);
+    // Sequence number of one book at the last added point
+    void addSequence(uint64_t route, int64_t seqId);
+    // Sorts the sequence points; call once all points are in
+    void finish();
+
+    // Last point at or before receivedNs; the first point if receivedNs is
+    // earlier, nullptr if there are none. O(log n).
+    const IndexPoint* findTime(int64_t receivedNs) const;
+    // Last point at which the book of route had a sequence number at or
+    // before seqId, nullptr if none. O(log n).
+    const IndexPoint* findSequence(uint64_t route, int64_t seqId) const;
+
+    const uint8_t* getKeyframes(const IndexPoint& point) const;
+    const std::vector<IndexPoint>& getPoints() const;
+    size_t getSequenceCount() const;
+    size_t getKeyframeBytes() const;
+    int64_t getIntervalNs() const;
+
+private:
+    // segmentBytes: header and data; point offsets are from the start of the segment
+    bool isConsistent(uint64_t segmentBytes) const;
+
+    IndexHeader header_{};
+    std::vector<IndexPoint> points_;
+    std::vector<SequencePoint> sequences_;
+    std::vector<uint8_t> keyframes_;
+};
+
+} // namespace storage
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "storage/journal_format.h"
+
+namespace storage {
+
+struct JournalRecord {
+    RecordType type;
+    uint16_t line;
+    uint32_t session;
+    int64_t receivedNs;
+    std::string_view payload; // points into the mapping; valid until close()
+};
+
+// Sequential reader over one memory-mapped journal segment. Works on closed
+// segments and on ones cut short by a crash.
+class JournalReader {
+public:
+    JournalReader() = default;
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    // Returns false at the end of the segment
+    bool next(JournalRecord& record);
+    void rewind();
+    // Continues reading at a record boundary, e.g. one from a JournalIndex.
+    // Returns false if offset is not inside the data.
+    bool seek(size_t offset);
+
+    const SegmentHeader& getHeader() const;
+    size_t getOffset() const;
+    size_t getDataBytes() const;
+
+    // Segment files of one or more capture runs, in capture order
+    static std::vector<std::string> listSegments(const std::string& directory,
+                                                 const std::string& prefix = "feed");
+
+private:
+    int fd_ = -1;
+    const uint8_t* base_ = nullptr;
+    size_t mappedBytes_ = 0;
+    size_t end_ = 0;
+    size_t offset_ = 0;
+    SegmentHeader header_{};
+};
+
+} // namespace storage
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "storage/journal_format.h"
+
+namespace storage {
+
+// Append-only capture journal backed by pre-allocated, memory-mapped segments.
+//
+// Each segment is reserved on disk and mapped up front, so append() is a
+// memcpy into the mapping: no syscalls, no allocation. When a record does not
+// fit, the segment is closed (trimmed to its used size) and the next one is
+// mapped. Segment files are named <prefix>-<UTC start time>-<index>.jrnl and
+// sort in capture order.
+//
+// Single writer; not thread-safe.
+class JournalWriter {
+public:
+    static constexpr size_t kDefaultSegmentBytes = 256 * 1024 * 1024;
+
+    JournalWriter(std::string directory, std::string prefix = "feed",
+                  size_t segmentBytes = kDefaultSegmentBytes);
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    // Receive stamps given to append() are wall-clock nanoseconds rather than
+    // steady-clock ones, as for imported history. Call before open().
+    void setWallClockStamps(bool enabled);
+
+    // Creates the directory and maps the first segment
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    // Returns false if the record can never fit a segment or rollover failed
+    bool append(RecordType type, std::string_view payload, int64_t receivedNs,
+                uint32_t session = 0, uint16_t line = 0);
+
+    uint64_t getRecordCount() const;
+    uint64_t getBytesWritten() const;
+    uint64_t getSegmentCount() const;
+    const std::string& getCurrentPath() const;
+
+private:
+    bool openSegment();
+    void closeSegment();
+
+    std::string directory_;
+    std::string prefix_;
+    std::string runStamp_;
+    std::string currentPath_;
+    size_t segmentBytes_;
+    bool wallClockStamps_ = false;
+
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t offset_ = 0;
+    uint64_t segmentIndex_ = 0;
+    uint64_t segmentRecords_ = 0;
+
+    uint64_t records_ = 0;
+    uint64_t bytes_ = 0;
+    uint64_t segments_ = 0;
+};
+
+} // namespace storage
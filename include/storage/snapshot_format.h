@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+// On-disk layout of a columnar top-N book snapshot file:
+//
+//   SnapshotFileHeader                                    64 bytes
+//   chunk: ChunkHeader, ColumnHeader[columns], columns    repeated
+//   ChunkIndexEntry[chunkCount]                           written on close
+//
+// A chunk holds up to rowsPerChunk snapshots. Column 0 is the timestamp
+// (int64 ns since the epoch); then, per level from the touch, bid price,
+// bid quantity, ask price and ask quantity (doubles, 0 where the book had
+// fewer levels). Every column starts on an 8-byte boundary relative to the
+// file, so RAW columns can be used in place from a mapping. Integers are
+// stored in host byte order.
+
+constexpr char kSnapshotMagic[8] = {'O', 'K', 'X', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr const char* kSnapshotExtension = ".bsnap";
+
+enum class ColumnCodec : uint8_t {
+    RAW = 0,            // fixed 8-byte values
+    DELTA_VARINT = 1,   // int64: zigzag varint of the difference from the previous row
+    XOR_VARINT = 2,     // double: varint of the bits XORed with the previous row
+    TICK_VARINT = 3     // double as an integer count of 10^-decimals, stream-VByte coded:
+                        // best price as zigzag delta from the previous row, deeper
+                        // prices as 1 + zigzag distance from the best (0 = no level),
+                        // quantities as zigzag delta from the previous row
+};
+
+enum class BookField : uint8_t {
+    BID_PRICE = 0,
+    BID_QUANTITY = 1,
+    ASK_PRICE = 2,
+    ASK_QUANTITY = 3
+};
+
+constexpr size_t kFieldsPerLevel = 4;
+
+inline size_t columnCount(size_t depth) {
+    return 1 + depth * kFieldsPerLevel;
+}
+
+// Column holding `field` at `level` (0 = best)
+inline size_t columnIndex(BookField field, size_t level) {
+    return 1 + level * kFieldsPerLevel + static_cast<size_t>(field);
+}
+
+struct SnapshotFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint32_t depth;            // levels per side
+    uint32_t rowsPerChunk;
+    uint64_t chunkCount;       // 0 until closed
+    uint64_t indexOffset;      // 0 until closed
+    uint64_t rowCount;         // 0 until closed
+    uint8_t reserved[16];
+};
+static_assert(sizeof(SnapshotFileHeader) == 64, "snapshot header layout changed");
+
+struct ChunkHeader {
+    uint32_t rows;
+    uint32_t columns;
+    uint64_t bytes;            // whole chunk including this header
+    int64_t firstTimestamp;
+    int64_t lastTimestamp;
+};
+static_assert(sizeof(ChunkHeader) == 32, "chunk header layout changed");
+
+struct ColumnHeader {
+    uint8_t codec;             // ColumnCodec
+    uint8_t decimals;          // TICK_VARINT scale
+    uint8_t reserved[2];
+    uint32_t bytes;            // encoded size, before padding
+    uint64_t offset;           // from the start of the chunk
+};
+static_assert(sizeof(ColumnHeader) == 16, "column header layout changed");
+
+struct ChunkIndexEntry {
+    uint64_t offset;           // from the start of the file
+    uint32_t rows;
+    uint32_t reserved;
+    int64_t firstTimestamp;
+    int64_t lastTimestamp;
+};
+static_assert(sizeof(ChunkIndexEntry) == 32, "chunk index layout changed");
+
+inline size_t alignTo8(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+} // namespace storage
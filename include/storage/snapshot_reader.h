@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "storage/snapshot_format.h"
+
+namespace storage {
+
+// Memory-mapped reader for columnar snapshot files (see SnapshotWriter).
+//
+// Two access patterns, neither building per-row objects:
+//  - loadChunk() + timestamps()/column(): one chunk at a time. RAW columns
+//    point straight into the mapping; encoded ones are decoded into buffers
+//    the reader reuses, valid until the next loadChunk() or close().
+//  - readColumn()/readTimestamps(): one column across the whole file into a
+//    caller-owned contiguous buffer, ready for models::*::setTrainingData
+//    and the core::utils statistics overloads that take pointer + size.
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    size_t getDepth() const;
+    uint64_t getRowCount() const;
+    const std::vector<ChunkIndexEntry>& getChunks() const;
+
+    bool loadChunk(size_t chunk);
+    size_t getChunkRows() const;
+    const int64_t* timestamps() const;
+    const double* column(BookField field, size_t level) const;
+
+    // Replace the contents of out
+    bool readTimestamps(std::vector<int64_t>& out) const;
+    bool readColumn(BookField field, size_t level, std::vector<double>& out) const;
+
+private:
+    // Reused across the chunks of one read
+    struct DecodeScratch {
+        std::vector<uint64_t> units;
+        std::vector<double> best;
+    };
+
+    const ColumnHeader* columnHeader(const ChunkIndexEntry& chunk, size_t column) const;
+    bool decodeTimestamps(const ChunkIndexEntry& chunk, int64_t* out) const;
+    // best: the chunk's level-0 column of the same side, if already decoded;
+    // deeper price levels are stored relative to it
+    bool decodeColumn(const ChunkIndexEntry& chunk, size_t column, double* out, DecodeScratch& scratch,
+                      const double* best = nullptr) const;
+    bool decodeTicks(const ChunkIndexEntry& chunk, size_t column, int decimals, const uint8_t* in,
+                     const uint8_t* end, double* out, DecodeScratch& scratch, const double* best) const;
+    // Every extent of the chunk lies inside the mapping and its own bytes
+    bool isValidChunk(const ChunkIndexEntry& entry) const;
+    void scanChunks();
+
+    int fd_ = -1;
+    const uint8_t* base_ = nullptr;
+    size_t mappedBytes_ = 0;
+    SnapshotFileHeader header_{};
+    std::vector<ChunkIndexEntry> chunks_;
+    uint64_t rowCount_ = 0;
+
+    // Loaded chunk
+    size_t chunkRows_ = 0;
+    const int64_t* timestamps_ = nullptr;
+    std::vector<const double*> columns_;
+    std::vector<int64_t> timestampBuffer_;
+    std::vector<std::vector<double>> columnBuffers_;
+    DecodeScratch scratch_;
+};
+
+} // namespace storage
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "core/orderbook.h"
+#include "storage/snapshot_format.h"
+
+namespace storage {
+
+// Writes top-N order book snapshots to a columnar file (see snapshot_format.h).
+//
+// Rows are buffered column-major for one chunk and encoded per column when
+// the chunk fills: timestamps as delta varints; prices and quantities in
+// ticks/lots (TICK_VARINT) when they are exact decimals, otherwise as XOR
+// varints, whichever is smaller. A column that would not shrink is stored
+// RAW. Meant for sampled snapshots (analytics, model training), not
+// for every feed message; single writer.
+class SnapshotWriter {
+public:
+    static constexpr uint32_t kDefaultRowsPerChunk = 4096;
+
+    SnapshotWriter(std::string path, size_t depth, bool compress = true,
+                   uint32_t rowsPerChunk = kDefaultRowsPerChunk);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    bool open();
+    // Flushes the last chunk and writes the chunk index
+    void close();
+    bool isOpen() const;
+
+    // Levels the book does not have are stored as 0
+    bool append(int64_t timestampNs, const core::PriceLevels& bids, const core::PriceLevels& asks);
+
+    size_t getDepth() const;
+    uint64_t getRowCount() const;
+    uint64_t getBytesWritten() const;
+
+private:
+    bool flushChunk();
+    ColumnCodec encodeTimestamps(std::vector<uint8_t>& out) const;
+    ColumnCodec encodeColumn(size_t column, std::vector<uint8_t>& out, uint8_t& decimals);
+    void encodeTicks(size_t column, int decimals, std::vector<uint8_t>& out);
+
+    std::string path_;
+    size_t depth_;
+    bool compress_;
+    uint32_t rowsPerChunk_;
+
+    std::ofstream file_;
+    uint64_t offset_ = 0;
+    uint64_t rows_ = 0;
+
+    // Open chunk, column-major
+    std::vector<int64_t> timestamps_;
+    std::vector<std::vector<double>> columns_; // columnIndex() - 1
+    std::vector<ChunkIndexEntry> index_;
+    std::vector<uint8_t> chunkBuffer_;
+    std::vector<uint8_t> encoded_;
+    std::vector<uint8_t> alternative_;
+    std::vector<uint64_t> units_;
+    int priceDecimals_[2] = {-1, -1}; // per side for the open chunk, -1 if not exact
+};
+
+} // namespace storage
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace storage {
+
+// Byte-aligned variable-length integers with the lengths kept apart from the
+// data ("stream VByte", Lemire et al.), widened to 64 bits:
+//
+//   control bytes   ceil(count / 4), 2 bits per value: 1, 2, 4 or 8 bytes
+//   data bytes      each value little-endian in its length
+//
+// Because lengths are known up front, decoding needs no per-byte branches:
+// two values at a time are moved into place with one SSSE3 byte shuffle.
+// Used for the level arrays of encoded book frames and for tick columns.
+
+// Worst case for count values
+inline size_t streamVbyteMaxBytes(size_t count) {
+    return (count + 3) / 4 + count * 8;
+}
+
+// Appends the encoding of count values to out
+void streamVbyteEncode(const uint64_t* values, size_t count, std::vector<uint8_t>& out);
+
+// Decodes count values; returns the byte after the data, or nullptr if the
+// input ends early. Picks the SSSE3 path when the CPU supports it.
+const uint8_t* streamVbyteDecode(const uint8_t* in, const uint8_t* end, size_t count, uint64_t* out);
+
+// Portable decoder, also used for the tail of the SIMD path
+const uint8_t* streamVbyteDecodeScalar(const uint8_t* in, const uint8_t* end, size_t count, uint64_t* out);
+
+// Whether streamVbyteDecode uses the SIMD path on this machine
+bool streamVbyteSimdAvailable();
+
+} // namespace storage
@@ -21,7 +21,10 @@
 #include "core/config.h"
 #include "core/orderbook.h"
 #include "models/simulator.h"
+#include "models/simulation_engine.h"
 #include "websocket/websocket_client.h"
+#include "websocket/feed_manager.h"
+#include "websocket/subscription_manager.h"
 
 // Declare SimulationResult as a meta type
 Q_DECLARE_METATYPE(models::SimulationResult)
@@ -57,6 +60,7 @@ private:
     void initializeSimulator();
     void updateAssetList(const QString& exchange);
     void updateFeeTiers(const QString& exchange);
+    void updateEngineView();
 
     // UI Components
     QWidget* centralWidget_;
@@ -81,6 +85,7 @@ private:
     QLabel* netCostLabel_;
     QLabel* makerTakerLabel_;
     QLabel* latencyLabel_;
+    QTableWidget* engineTable_; // simulation engine results, one row per instrument
 
     // Bottom Panel - Diagnostics
     QGroupBox* diagnosticGroup_;
@@ -103,7 +108,12 @@ private:
     std::shared_ptr<core::Config> config_;
     std::shared_ptr<core::OrderBook> orderBook_;
     std::shared_ptr<models::Simulator> simulator_;
-    std::shared_ptr<websocket::WebSocketClient> wsClient_;
+    std::unique_ptr<models::SimulationEngine> engine_; // every configured instrument, if enabled
+    std::vector<models::InstrumentResult> engineView_;
+    std::shared_ptr<processing::MessageProcessor> msgProcessor_;
+    std::unique_ptr<websocket::FeedManager> feedManager_;
+    std::shared_ptr<websocket::WebSocketClient> wsClient_; // primary session
+    std::unique_ptr<websocket::SubscriptionManager> subscriptionManager_; // OKX public feed only
 };
 
 } // namespace ui 
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <concurrentqueue.h>
+
+namespace processing {
+
+// Recycles message strings between the feed threads and the processing
+// stage. Feed threads acquire() a buffer and fill it with the frame; the
+// stage releases it once the frame is applied, so steady-state receive
+// does not allocate.
+class BufferPool {
+public:
+    static constexpr size_t kDefaultBufferCapacity = 64 * 1024;
+    static constexpr size_t kDefaultMaxPooled = 4096;
+
+    explicit BufferPool(size_t bufferCapacity = kDefaultBufferCapacity, size_t maxPooled = kDefaultMaxPooled)
+        : pool_(maxPooled), bufferCapacity_(bufferCapacity), maxPooled_(maxPooled) {}
+
+    std::string acquire() {
+        std::string buffer;
+        if (!pool_.try_dequeue(buffer)) {
+            buffer.reserve(bufferCapacity_);
+        }
+        buffer.clear();
+        return buffer;
+    }
+
+    void release(std::string&& buffer) {
+        // Drop oversized or surplus buffers instead of growing the pool without bound
+        if (buffer.capacity() == 0 || buffer.capacity() > 4 * bufferCapacity_ || pool_.size_approx() >= maxPooled_) {
+            return;
+        }
+        pool_.try_enqueue(std::move(buffer));
+    }
+
+private:
+    moodycamel::ConcurrentQueue<std::string> pool_;
+    size_t bufferCapacity_;
+    size_t maxPooled_;
+};
+
+} // namespace processing
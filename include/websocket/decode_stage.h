@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <concurrentqueue.h>
+
+#include "core/orderbook.h"
+#include "websocket/market_data_decoder.h"
+#include "websocket/websocket_message.h"
+#include "websocket/wait_strategy.h"
+#include "websocket/buffer_pool.h"
+#include "websocket/latency_histogram.h"
+#include "websocket/feed_arbitrator.h"
+
+namespace processing {
+
+// Fans decoded order book updates out across N workers by hashing the
+// instrument ID. All updates for one symbol land on the same worker and are
+// applied in arrival order; different symbols are processed in parallel.
+class DecodeStage {
+public:
+    using BookUpdateHandler = std::function<void(const std::shared_ptr<core::OrderBook>&)>;
+    using ControlHandler = std::function<void(const std::string&)>;
+    using GapHandler = std::function<void(const std::string& channel, const std::string& instrument)>;
+
+    explicit DecodeStage(int numWorkers,
+                         WaitStrategy::Type waitStrategy = WaitStrategy::Type::SPIN_YIELD,
+                         int spinIterations = WaitStrategy::kDefaultSpinIterations);
+    ~DecodeStage();
+
+    void start();
+    void stop();
+
+    // Must be called from a single dispatching thread to keep per-symbol ordering
+    bool dispatch(WebSocketMessage&& message);
+    size_t dispatchBatch(MessageBatch& batch);
+
+    // Decode and apply on the calling thread (used when running with one worker)
+    void processInline(MessageBatch& batch);
+
+    // Books are created on first update unless registered up front. They are
+    // keyed by routeKey(channel, instrument); the gomarket feed has no channel.
+    void registerOrderBook(const std::string& symbol, std::shared_ptr<core::OrderBook> orderBook);
+    void registerOrderBook(const std::string& channel, const std::string& instrument,
+                           std::shared_ptr<core::OrderBook> orderBook);
+    std::shared_ptr<core::OrderBook> getOrderBook(const std::string& symbol) const;
+    std::shared_ptr<core::OrderBook> getOrderBook(const std::string& channel, const std::string& instrument) const;
+
+    // Must be set before start(); invoked on the worker thread once per batch
+    // for every book the batch touched, after all its updates are applied
+    void setBookUpdateHandler(BookUpdateHandler handler);
+
+    // Frame buffers are handed back here once decoded. Must be set before start().
+    void setBufferPool(BufferPool* pool);
+
+    // OKX event messages (subscription acks, errors), raw, on the worker thread.
+    // Must be set before start().
+    void setControlHandler(ControlHandler handler);
+
+    // Called on the worker thread when an incremental update does not follow
+    // the book's sequence; the book keeps its last state until resubscribed.
+    // Must be set before start().
+    void setGapHandler(GapHandler handler);
+    uint64_t getSequenceGapCount() const;
+
+    // Feed resynchronisation, per feed line: measures the time from a line's
+    // disconnect until the first book is rebuilt from a snapshot of its new
+    // session. Each book's own rebuild time is logged at debug level.
+    void beginResync(uint32_t line, uint32_t session, double budgetMs);
+    bool isResyncPending(uint32_t line) const;
+    double getLastResyncMs() const;
+
+    // Exchange->receive and receive->applied distributions. Tracking costs two
+    // clock reads per update and can be turned off before start().
+    void setLatencyTracking(bool enabled);
+    FeedLatency getFeedLatency() const;
+    void resetFeedLatency();
+
+    // A/B arbitration for redundant sessions on the same channel: the first
+    // copy of each update is applied, later copies are dropped before decode.
+    // Must be set before start().
+    void setArbitration(bool enabled);
+    ArbitrationSummary getArbitrationSummary() const;
+
+    int getWorkerCount() const;
+    size_t workerFor(std::string_view symbol) const;
+    uint64_t getProcessedCount() const;
+    // Frames fully handled, book updates or not, including the update handler
+    uint64_t getFrameCount() const;
+    // Frames dispatchBatch dropped because a worker queue was full
+    uint64_t getDroppedCount() const;
+
+private:
+    struct Worker {
+        Worker(WaitStrategy::Type waitType, int spinIterations, ArbitrationStats& stats)
+            : waitStrategy(waitType, spinIterations), arbitrator(stats) {}
+
+        moodycamel::ConcurrentQueue<WebSocketMessage> queue;
+        WaitStrategy waitStrategy;
+        std::thread thread;
+        MessageBatch batch;
+        std::vector<BookUpdate> updates; // reused decode targets, one per batch slot
+        std::vector<std::shared_ptr<core::OrderBook>> touched;
+        std::unordered_map<uint64_t, std::shared_ptr<core::OrderBook>> books; // worker-local cache
+        // Per book, the session of each line whose resync it last completed
+        std::unordered_map<uint64_t, std::array<uint32_t, ArbitrationStats::kMaxLines>> resynced;
+        FeedArbitrator arbitrator;
+        std::atomic<uint64_t> processed{0};
+        std::atomic<uint64_t> frames{0};
+    };
+
+    void runWorker(Worker& worker);
+    void processBatch(Worker& worker, MessageBatch& batch);
+    std::shared_ptr<core::OrderBook> lookupOrderBook(Worker& worker, uint64_t route);
+    void noteResyncSnapshot(Worker& worker, const BookUpdate& update);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<Worker> inlineWorker_;
+    BookUpdateHandler bookUpdateHandler_;
+    ControlHandler controlHandler_;
+    GapHandler gapHandler_;
+    std::atomic<uint64_t> sequenceGaps_{0};
+    std::atomic<uint64_t> dropped_{0};
+    BufferPool* bufferPool_ = nullptr;
+    std::atomic<bool> running_{false};
+
+    bool trackLatency_ = true;
+    LatencyHistogram exchangeToReceive_;
+    LatencyHistogram receiveToApplied_;
+
+    bool arbitrate_ = false;
+    ArbitrationStats arbitrationStats_;
+
+    struct LineResync {
+        std::atomic<bool> pending{false};   // no book rebuilt yet
+        std::atomic<uint32_t> session{0};   // first session after the disconnect; 0 before any
+        std::atomic<int64_t> startNs{0};
+        std::atomic<double> budgetMs{0.0};
+    };
+    std::array<LineResync, ArbitrationStats::kMaxLines> resync_;
+    std::atomic<double> lastResyncMs_{0.0};
+
+    std::unordered_map<uint64_t, std::shared_ptr<core::OrderBook>> books_;
+    mutable std::mutex booksMutex_;
+};
+
+} // namespace processing
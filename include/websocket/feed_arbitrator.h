@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "websocket/latency_histogram.h"
+
+namespace processing {
+
+// Who won the A/B race, and by how much
+struct ArbitrationSummary {
+    std::vector<uint64_t> wins;  // first arrivals per line
+    uint64_t duplicates = 0;     // late copies dropped
+    uint64_t stale = 0;          // updates older than the book, dropped
+    uint64_t unmatched = 0;      // updates only one line delivered
+    LatencySummary lead;         // winner's lead over the other line
+};
+
+// Shared by every decode worker
+class ArbitrationStats {
+public:
+    static constexpr uint32_t kMaxLines = 8;
+
+    void recordWin(uint32_t line, int64_t leadNs) {
+        wins_[line % kMaxLines].fetch_add(1, std::memory_order_relaxed);
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        lead_.record(leadNs);
+    }
+
+    void recordDuplicate() { duplicates_.fetch_add(1, std::memory_order_relaxed); }
+    void recordStale() { stale_.fetch_add(1, std::memory_order_relaxed); }
+    void recordUnmatched() { unmatched_.fetch_add(1, std::memory_order_relaxed); }
+
+    ArbitrationSummary summary() const;
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, kMaxLines> wins_{};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> stale_{0};
+    std::atomic<uint64_t> unmatched_{0};
+    LatencyHistogram lead_;
+};
+
+// First-arrival-wins dedup for redundant feeds carrying the same channel.
+//
+// Frames are keyed by a checksum of the raw payload, so a copy from the other
+// line is dropped before it is decoded. A bounded window of recent keys is
+// kept; anything that falls out of it is caught by the per-symbol exchange
+// timestamp check instead, so a lagging line can never roll a book back.
+// One instance per decode worker: every symbol is owned by a single worker,
+// so no locking is needed.
+class FeedArbitrator {
+public:
+    static constexpr size_t kDefaultWindow = 4096;
+
+    explicit FeedArbitrator(ArbitrationStats& stats, size_t window = kDefaultWindow);
+
+    static uint64_t checksum(std::string_view payload);
+
+    // Returns false if the frame is a copy of one already seen
+    bool accept(uint64_t key, uint32_t line, int64_t receivedNs);
+
+    // Returns false if the book already holds a newer exchange timestamp
+    bool isCurrent(const std::string& symbol, const std::string& timestamp);
+
+private:
+    struct Arrival {
+        uint32_t line;
+        int64_t receivedNs;
+        bool matched;
+    };
+
+    void evictOldest();
+
+    ArbitrationStats& stats_;
+    size_t window_;
+    std::vector<uint64_t> order_; // ring of keys in arrival order
+    size_t next_ = 0;
+    std::unordered_map<uint64_t, Arrival> seen_;
+    std::unordered_map<std::string, std::string> lastTimestamp_;
+};
+
+} // namespace processing
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+
+#include "core/config.h"
+#include "websocket/websocket_client.h"
+#include "websocket/message_processor.h"
+
+namespace websocket {
+
+// Runs many WebSocket sessions over a small pool of I/O threads.
+//
+// Each pool thread drives its own io_context and is pinned to one core
+// (performance.io_threads / performance.io_thread_cpus). Sessions are spread
+// round-robin across the pool, and each one serialises its state on a private
+// strand, so fifty streams cost fifty sockets but only io_threads threads.
+class FeedManager {
+public:
+    FeedManager(std::shared_ptr<core::Config> config, std::shared_ptr<processing::MessageProcessor> processor);
+    ~FeedManager();
+
+    void start();
+    void stop();
+
+    // Creates a session bound to the next pool thread; call connect() on it
+    // (or connectAll()) once its signals are wired up
+    std::shared_ptr<WebSocketClient> addSession(const std::string& endpoint);
+
+    // Starts every session without waiting for handshakes; false if any
+    // session could not be started
+    bool connectAll();
+
+    std::vector<std::shared_ptr<WebSocketClient>> getSessions() const;
+    size_t getSessionCount() const;
+    int getThreadCount() const;
+
+private:
+    struct IoThread {
+        IoThread() : ioc(1), workGuard(ioc.get_executor()) {}
+
+        net::io_context ioc; // one thread per context, so the single-threaded hint applies
+        net::executor_work_guard<net::io_context::executor_type> workGuard;
+        std::thread thread;
+        int cpu = -1;
+    };
+
+    std::shared_ptr<core::Config> config_;
+    std::shared_ptr<processing::MessageProcessor> processor_;
+    std::vector<std::unique_ptr<IoThread>> threads_;
+    std::vector<std::shared_ptr<WebSocketClient>> sessions_;
+    mutable std::mutex sessionsMutex_;
+    size_t nextThread_ = 0;
+    bool running_ = false;
+};
+
+} // namespace websocket
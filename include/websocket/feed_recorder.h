@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "storage/journal_writer.h"
+#include "websocket/websocket_message.h"
+
+namespace processing {
+
+struct CaptureStats {
+    uint64_t recorded = 0;  // frames written to the journal
+    uint64_t dropped = 0;   // frames lost because the capture ring was full
+    uint64_t bytes = 0;
+    uint64_t segments = 0;
+};
+
+// Recorder stage: tees every frame the MessageProcessor dequeues into an
+// append-only journal (see storage::JournalWriter).
+//
+// The dispatcher copies each frame, already in journal record layout, into a
+// pre-faulted single-producer/single-consumer byte ring and publishes the
+// batch with one store. The recorder thread drains the ring into the mapped
+// journal. The live path never blocks, allocates or makes a syscall for
+// capture: the recorder polls instead of being woken, and a full ring drops
+// the frame and counts it.
+class FeedRecorder {
+public:
+    static constexpr size_t kRingBytes = 32 * 1024 * 1024;
+    static constexpr int kIdleSleepUs = 500;
+
+    FeedRecorder(const std::string& directory, size_t segmentBytes = storage::JournalWriter::kDefaultSegmentBytes);
+    ~FeedRecorder();
+
+    bool start();
+    // Drains what is already queued, then closes the journal
+    void stop();
+
+    // Dispatcher thread only
+    void capture(const MessageBatch& batch);
+
+    CaptureStats getStats() const;
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+    static constexpr uint32_t kWrapMarker = 0xFFFFFFFF; // rest of the ring is padding
+
+    void run();
+    size_t drain();
+
+    storage::JournalWriter writer_;
+    std::unique_ptr<uint8_t[]> ring_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    // Consumer-owned
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+
+    // Producer-owned
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+    size_t cachedHead_ = 0;
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> segments_{0};
+};
+
+} // namespace processing
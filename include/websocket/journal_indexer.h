@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/orderbook.h"
+#include "storage/book_codec.h"
+#include "storage/journal_index.h"
+#include "storage/journal_reader.h"
+#include "websocket/market_data_decoder.h"
+
+namespace processing {
+
+// Where to start reading to see the books as they stood at some moment
+struct SeekPoint {
+    size_t segment = 0;                  // into the segment list given to open()
+    uint64_t offset = 0;                 // record boundary in that segment
+    int64_t receivedNs = 0;              // receive stamp of the record at offset
+    const uint8_t* keyframes = nullptr;  // books just before offset; owned by the indexer
+    size_t keyframeBytes = 0;            // 0 when the record at offset is itself a keyframe block
+};
+
+// Builds and loads the storage::JournalIndex of each segment of a capture.
+//
+// For raw captures the books are rebuilt from the JSON frames while indexing
+// and written out as keyframes every intervalNs of receive time, and at the
+// first record of every segment. Book state carries across segments, so a
+// segment is indexed after the ones before it. Compacted journals are
+// indexed at their BOOK_KEYFRAMES records.
+//
+// Indexes of closed segments are saved next to them and reused until the
+// segment changes; the segment still being written is indexed in memory.
+class JournalIndexer {
+public:
+    explicit JournalIndexer(int64_t intervalNs = 1000000000);
+
+    // Segments in capture order. Returns false if none could be read.
+    bool open(const std::vector<std::string>& segments, bool rebuild = false);
+
+    // Last index point at or before wall-clock time wallNs (the first point
+    // if wallNs is earlier): O(log segments + log points)
+    bool seekTime(int64_t wallNs, SeekPoint& point) const;
+    // Last index point at which the book of route was at or before seqId
+    bool seekSequence(uint64_t route, int64_t seqId, SeekPoint& point) const;
+
+    const std::vector<storage::JournalIndex>& getIndexes() const;
+    // Segments indexed by the last open() rather than loaded
+    size_t getBuiltCount() const;
+
+private:
+    struct Book {
+        std::shared_ptr<core::OrderBook> orderBook = std::make_shared<core::OrderBook>();
+        storage::BookStreamInfo info;
+        bool synced = false;
+    };
+
+    void indexSegment(size_t segment, bool save);
+    // Brings books_ to the end of a loaded segment: its last keyframes plus the records after them
+    void catchUp(size_t segment);
+    void applyRecord(const storage::JournalRecord& record);
+    void addPoint(storage::JournalIndex& index, int64_t receivedNs, uint64_t offset, uint64_t record);
+    void toSeekPoint(size_t segment, const storage::IndexPoint& indexPoint, SeekPoint& point) const;
+
+    int64_t intervalNs_;
+    std::vector<std::string> segments_;
+    std::vector<storage::JournalIndex> indexes_;
+    std::vector<int64_t> steadyToWallNs_;   // per segment
+    std::vector<int64_t> firstWallNs_;      // wall time of each segment's first point
+    size_t built_ = 0;
+
+    std::unordered_map<uint64_t, Book> books_;
+    storage::BookEncoder encoder_;
+
+    // Scratch reused between records and points
+    std::string payload_;
+    BookUpdate update_;
+    core::PriceLevels bids_;
+    core::PriceLevels asks_;
+    std::vector<uint8_t> keyframes_;
+    std::vector<std::pair<uint64_t, int64_t>> sequences_;
+};
+
+} // namespace processing
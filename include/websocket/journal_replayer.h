@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "websocket/journal_indexer.h"
+#include "websocket/message_processor.h"
+
+namespace processing {
+
+struct ReplayStats {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;            // as stored: JSON frames, or encoded book frames of compacted journals
+    uint64_t dropped = 0;          // lost to a full decode queue
+    double wallSeconds = 0.0;      // first frame fed until the last one was applied
+    double capturedSeconds = 0.0;  // wall-clock span of the replayed frames
+    double messagesPerSecond = 0.0;
+    double megabytesPerSecond = 0.0;
+    uint64_t keyframes = 0;        // books seeded from index or journal keyframes when starting mid-capture
+    uint64_t caughtUp = 0;         // frames fed unpaced between the index point and the start time
+    double seekSeconds = 0.0;      // loading (or building) the index and seeding the books
+};
+
+// Feeds captured journals (see FeedRecorder) through a MessageProcessor, so
+// recorded data takes the same decode -> OrderBook -> handler path as the
+// live feed.
+//
+// Segments are read straight from their mappings. Frames keep their session
+// and feed line; receive stamps are retaken on enqueue so pipeline latency
+// is measured for the replay itself. core::utils::currentTime() follows the
+// capture time of the latest frame applied (not fed) for the duration of the
+// replay, so queued frames do not run the clock ahead of the books.
+//
+// A replay can start at any wall-clock time of the capture: the books are
+// seeded from the keyframes of the nearest JournalIndexer point before it,
+// and the frames between that point and the start time are fed unpaced and
+// left out of the statistics.
+//
+// Compacted journals (tools/compact_journal) are replayed too: each encoded
+// book frame is rendered back into a feed message. Their BOOK_KEYFRAMES
+// records seed books the replay has not seen yet, which is what a seek lands
+// on. Session and feed line are not kept by compaction and replay as 0.
+//
+// At most kMaxInFlight frames are queued ahead of the decode stage, so
+// replaying faster than the pipeline can go applies backpressure instead of
+// dropping frames.
+class JournalReplayer {
+public:
+    static constexpr uint64_t kMaxInFlight = 512;
+
+    explicit JournalReplayer(std::shared_ptr<MessageProcessor> processor);
+
+    // Blocks until every frame is applied or stop() is called.
+    // speed: 0 replays as fast as possible, 1 in real time, N at N times real time.
+    // fromWallNs: capture time (ns since the epoch) to start at; 0 for the beginning.
+    ReplayStats replay(const std::vector<std::string>& segments, double speed = 0.0, int64_t fromWallNs = 0);
+
+    // From another thread
+    void stop();
+
+    // "max", "realtime" or "<N>x"; returns -1 if not recognised
+    static double parseSpeed(const std::string& name);
+
+private:
+    // Feeds the keyframes at a seek point as snapshot messages; returns the book count
+    uint64_t seedBooks(const SeekPoint& point, uint64_t baseline);
+    // Renders a decoded book frame as the feed message it came from; false if
+    // the feed has no form for it (a delta of a whole-book feed)
+    static bool renderFrame(const storage::BookFrame& frame, const storage::BookStreamInfo& info,
+                            std::string& message);
+    void feed(std::string_view payload, uint32_t session, uint32_t line, int64_t wallNs = 0);
+    void waitUntil(int64_t steadyNs) const;
+    // Frames the pipeline is done with: applied, or dropped by the decode stage
+    uint64_t settledCount() const;
+    void waitForPipeline(uint64_t target, uint64_t maxBehind) const;
+
+    std::shared_ptr<MessageProcessor> processor_;
+    std::atomic<bool> stopRequested_{false};
+    uint64_t fed_ = 0; // frames enqueued by the current replay
+};
+
+} // namespace processing
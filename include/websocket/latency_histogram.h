@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace processing {
+
+// Percentiles of a latency distribution, in microseconds
+struct LatencySummary {
+    uint64_t count = 0;
+    uint64_t negative = 0; // samples below zero (clock skew), counted as 0
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+};
+
+// Feed latency as seen by the decode stage
+struct FeedLatency {
+    LatencySummary exchangeToReceive; // exchange timestamp -> frame read off the socket
+    LatencySummary receiveToApplied;  // frame read off the socket -> applied to the order book
+};
+
+// Lock-free log-linear histogram of nanosecond latencies.
+//
+// Each power of two is split into 8 linear sub-buckets, so any reported
+// percentile is within 12.5% of the true value. record() is a few relaxed
+// atomic increments and may be called from any number of threads.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kBucketCount = 62 * kSubBuckets;
+
+    void record(int64_t latencyNs) {
+        if (latencyNs < 0) {
+            negative_.fetch_add(1, std::memory_order_relaxed);
+            latencyNs = 0;
+        }
+
+        uint64_t value = static_cast<uint64_t>(latencyNs);
+        buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sumNs_.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t max = maxNs_.load(std::memory_order_relaxed);
+        while (value > max && !maxNs_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Approximate while writers are active; exact once they are quiet
+    LatencySummary summary() const {
+        LatencySummary result;
+        result.count = count_.load(std::memory_order_relaxed);
+        result.negative = negative_.load(std::memory_order_relaxed);
+        if (result.count == 0) {
+            return result;
+        }
+
+        result.mean = sumNs_.load(std::memory_order_relaxed) / 1000.0 / result.count;
+        result.max = maxNs_.load(std::memory_order_relaxed) / 1000.0;
+        result.p50 = percentile(0.50, result.count);
+        result.p99 = percentile(0.99, result.count);
+        result.p999 = percentile(0.999, result.count);
+        return result;
+    }
+
+    void reset() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count_ = 0;
+        negative_ = 0;
+        sumNs_ = 0;
+        maxNs_ = 0;
+    }
+
+private:
+    static int bucketFor(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int sub = static_cast<int>((value >> (msb - 3)) & (kSubBuckets - 1));
+        int index = (msb - 2) * kSubBuckets + sub;
+        return index < kBucketCount ? index : kBucketCount - 1;
+    }
+
+    // Upper edge of a bucket, in nanoseconds
+    static uint64_t bucketLimit(int index) {
+        if (index < kSubBuckets) {
+            return static_cast<uint64_t>(index);
+        }
+        int msb = index / kSubBuckets + 2;
+        uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+        return ((kSubBuckets + sub + 1) << (msb - 3)) - 1;
+    }
+
+    double percentile(double quantile, uint64_t count) const {
+        uint64_t rank = static_cast<uint64_t>(quantile * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                double limit = bucketLimit(i) / 1000.0;
+                double max = maxNs_.load(std::memory_order_relaxed) / 1000.0;
+                return limit < max ? limit : max;
+            }
+        }
+        return maxNs_.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> negative_{0};
+    std::atomic<uint64_t> sumNs_{0};
+    std::atomic<uint64_t> maxNs_{0};
+};
+
+} // namespace processing
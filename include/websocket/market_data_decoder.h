@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace processing {
+
+// Decoded L2 order book message, ready to be applied to core::OrderBook
+struct BookUpdate {
+    std::string exchange;
+    std::string symbol;
+    std::string channel;    // OKX channel (books, books5, bbo-tbt); empty for gomarket
+    std::string timestamp;
+    uint64_t route = 0;     // routeKey(channel, symbol)
+    bool snapshot = true;   // false for an incremental OKX "update"
+    int64_t seqId = -1;
+    int64_t prevSeqId = -1;
+    int64_t receivedNs = 0; // carried over from the raw frame
+    uint32_t session = 0;   // likewise
+    uint32_t line = 0;
+    int64_t wallNs = 0;
+    std::vector<std::pair<std::string, std::string>> bids;
+    std::vector<std::pair<std::string, std::string>> asks;
+};
+
+enum class MessageKind {
+    BOOK,    // `update` was filled
+    TRADES,  // trades channel data, not applied to a book
+    EVENT,   // OKX control message (subscribe/unsubscribe acks, errors)
+    UNKNOWN
+};
+
+// Precomputed routing key for a channel + instrument, so books are found by
+// one integer hash lookup instead of string comparisons
+uint64_t routeKey(std::string_view channel, std::string_view instrument);
+
+// Cheap scan for the instrument ID of a raw message without a full JSON parse
+// ("symbol" for gomarket, "instId" for OKX). Returns an empty view if the
+// message carries no instrument.
+std::string_view extractInstrumentId(std::string_view payload);
+
+// Full decode of a gomarket snapshot or an OKX native books/books5/bbo-tbt
+// push. Reuses the storage in `update`.
+MessageKind decodeMarketData(const std::string& payload, BookUpdate& update);
+bool decodeBookUpdate(const std::string& payload, BookUpdate& update);
+
+} // namespace processing
@@ -2,31 +2,114 @@
 #include <string>
 #include <thread>
 #include <atomic>
+#include <memory>
 #include <concurrentqueue.h>
 
-namespace processing {
+#include "core/config.h"
+#include "core/orderbook.h"
+#include "websocket/websocket_message.h"
+#include "websocket/decode_stage.h"
+#include "websocket/spsc_ring.h"
+#include "websocket/wait_strategy.h"
+#include "websocket/buffer_pool.h"
+#include "websocket/feed_recorder.h"
 
-struct WebSocketMessage {
-    std::string data;
-    // Add other fields as needed (timestamp, type, etc.)
-};
+namespace processing {
 
 class MessageProcessor {
 public:
-    MessageProcessor();
+    using BookUpdateHandler = DecodeStage::BookUpdateHandler;
+    using ControlHandler = DecodeStage::ControlHandler;
+    using GapHandler = DecodeStage::GapHandler;
+
+    enum class QueueType {
+        MPMC,   // moodycamel::ConcurrentQueue, safe for any number of producers
+        SPSC    // SpscRing, one producer thread: enqueue from any other fails
+    };
+
+    static constexpr size_t kQueueCapacity = 100000;
+
+    explicit MessageProcessor(int processingThreads = 1,
+                              QueueType queueType = QueueType::MPMC,
+                              WaitStrategy::Type waitStrategy = WaitStrategy::Type::SPIN_YIELD,
+                              int spinIterations = WaitStrategy::kDefaultSpinIterations);
+    explicit MessageProcessor(std::shared_ptr<core::Config> config);
     ~MessageProcessor();
 
     void start();
     void stop();
-    bool enqueue(const std::string& message);
+    // receivedNs is the steady-clock receive time; 0 stamps the frame on enqueue.
+    // With the SPSC queue the first thread to enqueue after start() owns the
+    // producer side, and enqueue from any other thread is refused.
+    bool enqueue(const std::string& message, uint32_t session = 0, int64_t receivedNs = 0);
+    bool enqueue(std::string&& message, uint32_t session = 0, int64_t receivedNs = 0);
+    bool enqueue(WebSocketMessage&& message);
+
+    // Pooled frame buffer for the zero-allocation enqueue(std::string&&) path
+    std::string acquireBuffer();
     WebSocketMessage dequeue();
 
+    // Drains up to batch.capacity() messages into the reusable batch.
+    // Returns the number dequeued, also stored in batch.count.
+    size_t try_dequeue_bulk(MessageBatch& batch);
+
+    // Order book routing for the decode stage
+    void registerOrderBook(const std::string& symbol, std::shared_ptr<core::OrderBook> orderBook);
+    void registerOrderBook(const std::string& channel, const std::string& instrument,
+                           std::shared_ptr<core::OrderBook> orderBook);
+    std::shared_ptr<core::OrderBook> getOrderBook(const std::string& symbol) const;
+    std::shared_ptr<core::OrderBook> getOrderBook(const std::string& channel, const std::string& instrument) const;
+    void setBookUpdateHandler(BookUpdateHandler handler);
+
+    // See DecodeStage::setControlHandler / setGapHandler
+    void setControlHandler(ControlHandler handler);
+    void setGapHandler(GapHandler handler);
+    uint64_t getSequenceGapCount() const;
+
+    // Called by the feed on disconnect; see DecodeStage::beginResync
+    void beginResync(uint32_t line, uint32_t session, double budgetMs);
+    double getLastResyncMs() const;
+
+    // See DecodeStage::getFeedLatency
+    FeedLatency getFeedLatency() const;
+    void resetFeedLatency();
+
+    // See DecodeStage::setArbitration
+    void setArbitration(bool enabled);
+    ArbitrationSummary getArbitrationSummary() const;
+
+    // Journal every dequeued frame to directory (see FeedRecorder). Must be
+    // called before start().
+    void enableCapture(const std::string& directory, size_t segmentBytes);
+    CaptureStats getCaptureStats() const;
+
+    uint64_t getProcessedCount() const;
+    uint64_t getFrameCount() const;
+    uint64_t getDroppedCount() const;
+    QueueType getQueueType() const;
+    WaitStrategy::Type getWaitStrategy() const;
+
+    static QueueType parseQueueType(const std::string& name);
+
 private:
     void processMessages();
+    size_t pendingCount() const;
+    // SPSC: true if the calling thread is (or now becomes) the producer
+    bool ownsProducerSide();
     
-    moodycamel::ConcurrentQueue<WebSocketMessage> queue_;
-    // std::thread processor_thread_;
+    QueueType queueType_;
+    std::unique_ptr<moodycamel::ConcurrentQueue<WebSocketMessage>> queue_;
+    std::unique_ptr<SpscRing<WebSocketMessage>> ring_;
+    BufferPool bufferPool_;
+    std::unique_ptr<DecodeStage> decodeStage_;
+    std::unique_ptr<FeedRecorder> recorder_;
+    WaitStrategy waitStrategy_;
+    std::thread processor_thread_;
     std::atomic<bool> running_{false};
+    std::atomic<std::thread::id> producer_{}; // SPSC only; cleared by stop()
+    std::atomic<bool> producerViolation_{false};
+    int processingThreads_;
+    MessageBatch batch_;
 };
 
-} // namespace processing
\ No newline at end of file
+} // namespace processing
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <boost/asio/ip/tcp.hpp>
+
+#include "core/config.h"
+
+namespace websocket {
+
+// Applies performance.socket options to a connected feed socket and returns
+// the values the kernel actually accepted (SO_RCVBUF is read back, since it
+// is doubled and capped by net.core.rmem_max). Options that fail are logged
+// and skipped; the connection is still usable.
+std::string applySocketTuning(boost::asio::ip::tcp::socket& socket, const core::SocketTuning& tuning);
+
+// TCP_QUICKACK is cleared by the kernel after it fires; call after each read
+void rearmQuickAck(boost::asio::ip::tcp::socket& socket);
+
+// Pins the calling I/O thread and sets its scheduling policy. Returns a
+// description of what was applied. cpu < 0 leaves affinity alone.
+std::string applyIoThreadTuning(int cpu, const std::string& policy, int priority);
+
+} // namespace websocket
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace processing {
+
+// Bounded single-producer/single-consumer ring buffer.
+//
+// Capacity is rounded up to a power of two so indices wrap with a mask.
+// Producer and consumer indices live on separate cache lines, and each side
+// keeps a private cached copy of the other's index so the shared one is only
+// re-read when the ring looks full (producer) or empty (consumer). Bulk
+// dequeue publishes the consumer index once per batch.
+template <typename T>
+class SpscRing {
+public:
+    static constexpr size_t kCacheLineSize = 64;
+
+    explicit SpscRing(size_t capacity)
+        : capacity_(roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity)),
+          mask_(capacity_ - 1),
+          buffer_(std::make_unique<T[]>(capacity_)) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side
+    bool try_enqueue(T&& item) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ >= capacity_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ >= capacity_) {
+                return false;
+            }
+        }
+
+        buffer_[tail & mask_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_enqueue(const T& item) {
+        T copy(item);
+        return try_enqueue(std::move(copy));
+    }
+
+    // Consumer side
+    bool try_dequeue(T& item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) {
+                return false;
+            }
+        }
+
+        item = std::move(buffer_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename OutputIt>
+    size_t try_dequeue_bulk(OutputIt out, size_t maxItems) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (cachedTail_ - head < maxItems) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+        }
+
+        size_t available = cachedTail_ - head;
+        size_t count = available < maxItems ? available : maxItems;
+        for (size_t i = 0; i < count; ++i, ++out) {
+            *out = std::move(buffer_[(head + i) & mask_]);
+        }
+
+        if (count > 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    size_t size_approx() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> buffer_;
+
+    // Consumer-owned
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+    alignas(kCacheLineSize) size_t cachedTail_ = 0;
+
+    // Producer-owned
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+    alignas(kCacheLineSize) size_t cachedHead_ = 0;
+
+    // Keep the next object off the producer's line
+    char padding_[kCacheLineSize - sizeof(size_t)];
+};
+
+} // namespace processing
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+#include "core/orderbook.h"
+#include "websocket/websocket_client.h"
+#include "websocket/message_processor.h"
+
+namespace websocket {
+
+// Runtime subscriptions to OKX public channels over one shared connection.
+//
+// Each (channel, instrument) pair gets its own order book, registered with
+// the decode stage under a precomputed route key, so incoming pushes are
+// routed by one integer lookup. Subscription state follows the exchange's
+// acknowledgements; everything still wanted is replayed on every reconnect,
+// and a book whose incremental sequence breaks is resubscribed for a fresh
+// snapshot.
+//
+// Installs the processor's control and gap handlers, so use one manager per
+// MessageProcessor. Must outlive the client's sessions.
+class SubscriptionManager {
+public:
+    enum class Channel {
+        BOOKS,    // 400-level snapshot + incremental updates
+        BOOKS5,   // 5-level snapshots
+        BBO_TBT,  // tick-by-tick best bid/offer
+        TRADES
+    };
+
+    enum class State {
+        PENDING,        // request sent, waiting for the ack
+        ACTIVE,
+        UNSUBSCRIBING,
+        FAILED
+    };
+
+    struct Subscription {
+        Channel channel;
+        std::string instrument;
+        State state;
+    };
+
+    SubscriptionManager(std::shared_ptr<WebSocketClient> client,
+                        std::shared_ptr<processing::MessageProcessor> processor);
+
+    // Queued on the connection; returns false if already subscribed/removed
+    bool add(Channel channel, const std::string& instrument);
+    bool remove(Channel channel, const std::string& instrument);
+
+    std::vector<Subscription> getSubscriptions() const;
+    bool getState(Channel channel, const std::string& instrument, State& state) const;
+
+    // Book fed by a books/books5/bbo-tbt subscription; nullptr for trades
+    std::shared_ptr<core::OrderBook> getOrderBook(Channel channel, const std::string& instrument) const;
+
+    static const char* channelName(Channel channel);
+    static bool parseChannel(const std::string& name, Channel& channel);
+
+private:
+    using Key = std::pair<Channel, std::string>;
+
+    struct Entry {
+        State state = State::PENDING;
+        std::shared_ptr<core::OrderBook> orderBook;
+    };
+
+    static std::string request(const char* op, Channel channel, const std::string& instrument);
+
+    std::vector<std::string> replayRequests();
+    void onEvent(const std::string& payload);
+    void onSequenceGap(const std::string& channel, const std::string& instrument);
+
+    std::shared_ptr<WebSocketClient> client_;
+    std::shared_ptr<processing::MessageProcessor> processor_;
+    std::map<Key, Entry> subscriptions_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace websocket
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace processing {
+
+// Idle policy for a queue consumer, trading CPU for wakeup latency.
+//
+//   BUSY_SPIN  - poll continuously; lowest latency, burns a full core
+//   SPIN_YIELD - spin for a bounded number of polls, then yield the CPU
+//   PARK       - spin briefly, then sleep on a futex until the producer
+//                calls notify() (condition variable on non-Linux platforms)
+//
+// One instance is shared by exactly one consumer and its producers.
+class WaitStrategy {
+public:
+    enum class Type {
+        BUSY_SPIN,
+        SPIN_YIELD,
+        PARK
+    };
+
+    static constexpr int kDefaultSpinIterations = 1000;
+
+    explicit WaitStrategy(Type type = Type::SPIN_YIELD, int spinIterations = kDefaultSpinIterations);
+
+    WaitStrategy(const WaitStrategy&) = delete;
+    WaitStrategy& operator=(const WaitStrategy&) = delete;
+
+    // Consumer: called after a poll came back empty. `hasWork` is re-checked
+    // before parking so a concurrent notify() is never lost.
+    template <typename Predicate>
+    void idle(Predicate hasWork) {
+        switch (type_) {
+            case Type::BUSY_SPIN:
+                cpuRelax();
+                return;
+
+            case Type::SPIN_YIELD:
+                if (++idleCount_ < spinIterations_) {
+                    cpuRelax();
+                } else {
+                    std::this_thread::yield();
+                }
+                return;
+
+            case Type::PARK:
+            default:
+                if (++idleCount_ < spinIterations_) {
+                    cpuRelax();
+                    return;
+                }
+
+                uint32_t epoch = epoch_.load(std::memory_order_acquire);
+                waiters_.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!hasWork()) {
+                    park(epoch);
+                }
+                waiters_.fetch_sub(1, std::memory_order_relaxed);
+                return;
+        }
+    }
+
+    // Consumer: called after a poll returned work
+    void reset() {
+        idleCount_ = 0;
+    }
+
+    // Producer: called after enqueueing. Free unless the consumer may be parked.
+    void notify() {
+        if (type_ != Type::PARK) {
+            return;
+        }
+
+        epoch_.fetch_add(1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            wake();
+        }
+    }
+
+    Type getType() const;
+
+    static Type parseType(const std::string& name);
+    static const char* typeName(Type type);
+
+private:
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    void park(uint32_t epoch);
+    void wake();
+
+    Type type_;
+    int spinIterations_;
+    int idleCount_ = 0;
+
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> waiters_{0};
+
+#ifndef __linux__
+    std::mutex parkMutex_;
+    std::condition_variable parkCondition_;
+#endif
+};
+
+} // namespace processing
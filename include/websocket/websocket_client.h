@@ -1,19 +1,29 @@
-#pragma once 
+#pragma once
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <deque>
 #include <QObject>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/connect.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/beast/ssl.hpp>
 #include <boost/asio/ssl/error.hpp>
 #include <boost/asio/ssl/stream.hpp>
 
 #include "core/config.h"
 #include "websocket/message_processor.h"
+#include "websocket/socket_tuning.h"
 
 namespace websocket {
 
@@ -23,37 +33,142 @@ namespace net = boost::asio;
 namespace ssl = net::ssl;
 using tcp = net::ip::tcp;
 
-class WebSocketClient : public QObject {
+// Must be owned by a std::shared_ptr: pending I/O handlers keep the session alive.
+class WebSocketClient : public QObject, public std::enable_shared_from_this<WebSocketClient> {
     Q_OBJECT
 
 public:
+    // Owns its io_context and I/O thread, connects to the configured endpoint
     explicit WebSocketClient(std::shared_ptr<core::Config> config, std::shared_ptr<processing::MessageProcessor> msgProcessor);
+
+    // Runs on a shared io_context driven by someone else (see FeedManager).
+    // All session state is serialised on a private strand.
+    WebSocketClient(std::shared_ptr<core::Config> config,
+                    std::shared_ptr<processing::MessageProcessor> msgProcessor,
+                    net::io_context& ioc,
+                    const std::string& endpoint);
     ~WebSocketClient();
 
+    // Starts connecting in the background and returns immediately; resolve,
+    // TCP connect, TLS and WebSocket handshakes all run on the io_context,
+    // bounded by connect_timeout_ms. connectionStatusChanged(true) fires once
+    // the session is up. Keeps the session alive: pings every
+    // ping_interval_ms, treats a silent peer as dead, and reconnects with
+    // jittered backoff capped at reconnect_interval_ms until disconnect().
+    // Returns false only if the client could not be set up.
     bool connect();
     void disconnect();
     bool isConnected() const;
+    // Queues the message on the session strand and returns immediately.
+    // Consecutive subscribe/unsubscribe requests are merged into one frame.
+    // Messages sent while reconnecting go out once the new session is up.
     bool send(const std::string& message);
     void setMessageHandler(std::function<void(const std::string&)> handler);
 
+    // Sends now (if connected) and replays after every reconnect
+    bool subscribe(const std::string& message);
+
+    // Asked for the requests to replay at the start of every session, after
+    // the fixed subscribe() messages (see SubscriptionManager). Set before connect().
+    void setReplayProvider(std::function<std::vector<std::string>()> provider);
+
+    const std::string& getEndpoint() const;
+
+    // Tags every frame so redundant sessions can be arbitrated
+    void setLine(uint32_t line);
+    uint32_t getLine() const;
+
+    // Socket options the kernel accepted for the current session
+    std::string getAppliedTuning() const;
+
+    // Failover statistics
+    int getReconnectCount() const;
+    double getLastRecoveryTimeMs() const;
+
 signals:
     void connectionStatusChanged(bool connected);
 
 private:
     void do_read();
+    void openSession();
+    void onResolve(uint32_t attempt, beast::error_code ec, tcp::resolver::results_type results);
+    void onConnect(uint32_t attempt, beast::error_code ec);
+    void startWebSocketHandshake(uint32_t attempt);
+    void onWebSocketHandshake(uint32_t attempt, beast::error_code ec);
+    void failConnect(uint32_t attempt, const std::string& reason);
+
+    // Outgoing frames, owned by the strand. At most one write or ping is in flight.
+    struct PendingWrite {
+        enum class Kind { FRAME, BATCHABLE, PING };
+        Kind kind;
+        std::string payload;
+        std::string op;        // BATCHABLE only
+        nlohmann::json args;   // BATCHABLE only
+    };
+
+    static PendingWrite makePendingWrite(const std::string& message);
+    void flushWrites();
+    void onWriteComplete(uint32_t session, beast::error_code ec, const char* operation);
+    void handleDisconnect(const std::string& reason);
+    void scheduleReconnect();
+    void schedulePing();
+    void closeSocket();
+    void parseEndpoint(const std::string& url);
+
+    // Runs f on the stream of the current session, TLS (wss://) or plain (ws://)
+    template <typename F>
+    void withStream(F&& f) {
+        if (secure_) {
+            if (ws_) f(*ws_);
+        } else if (plainWs_) {
+            f(*plainWs_);
+        }
+    }
 
     std::shared_ptr<core::Config> config_;
-    std::unique_ptr<net::io_context> ioc_;
+    std::string endpoint_;
+    net::io_context* ioc_ = nullptr;
+    std::unique_ptr<net::io_context> ownedIoc_; // only when not sharing a pool
+    std::unique_ptr<net::strand<net::io_context::executor_type>> strand_;
+    std::unique_ptr<net::executor_work_guard<net::io_context::executor_type>> workGuard_;
+    std::thread ioThread_;
     std::unique_ptr<websocket::stream<beast::ssl_stream<tcp::socket>>> ws_;
+    std::unique_ptr<websocket::stream<tcp::socket>> plainWs_;
     std::unique_ptr<ssl::context> ctx_;
     std::shared_ptr<processing::MessageProcessor> processor_;
     std::function<void(const std::string&)> messageHandler_;
-    bool connected_;
+    std::atomic<bool> connected_;
     std::string host_;
     std::string port_;
     std::string path_;
+    bool secure_ = true;
+    core::SocketTuning socketTuning_;
+    std::string appliedTuning_;
+    mutable std::mutex tuningMutex_;
     beast::flat_buffer buffer_;
+
+    // Keepalive and reconnect state, only touched on the strand
+    std::unique_ptr<net::steady_timer> pingTimer_;
+    std::unique_ptr<net::steady_timer> reconnectTimer_;
+    std::unique_ptr<net::steady_timer> connectTimer_;
+    std::unique_ptr<tcp::resolver> resolver_;
+    websocket::response_type handshakeResponse_;
+    uint32_t connectAttempt_ = 0;
+    std::deque<PendingWrite> writeQueue_;
+    std::string currentWrite_;
+    bool writing_ = false;
+    std::chrono::steady_clock::time_point lastActivity_;
+    std::mt19937 jitter_;
+    int reconnectAttempt_ = 0;
+    uint32_t session_ = 0;
+    uint32_t line_ = 0;
+    std::atomic<bool> started_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> reconnectCount_{0};
+
+    std::vector<std::string> subscriptions_;
+    std::mutex subscriptionsMutex_;
+    std::function<std::vector<std::string>()> replayProvider_;
 };
 
 }
-
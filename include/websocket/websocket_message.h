@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <vector>
+
+namespace processing {
+
+struct WebSocketMessage {
+    std::string data;
+    uint32_t session = 0; // feed connection generation, bumped on every reconnect
+    int64_t receivedNs = 0; // steady clock, taken when the frame came off the socket
+    uint32_t line = 0; // which redundant feed delivered it (see FeedArbitrator)
+    int64_t wallNs = 0; // capture time of a replayed frame; advances the virtual clock when applied
+};
+
+// Reusable batch for bulk dequeue. Message strings keep their capacity
+// between batches, so steady-state draining does not allocate.
+struct MessageBatch {
+    static constexpr size_t kDefaultCapacity = 256;
+
+    explicit MessageBatch(size_t capacity = kDefaultCapacity) : messages(capacity) {}
+
+    WebSocketMessage* begin() { return messages.data(); }
+    WebSocketMessage* end() { return messages.data() + count; }
+    size_t capacity() const { return messages.size(); }
+    bool empty() const { return count == 0; }
+
+    std::vector<WebSocketMessage> messages;
+    size_t count = 0;
+};
+
+} // namespace processing
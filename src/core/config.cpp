@@ -43,6 +43,14 @@ std::string Config::getWebSocketEndpoint() const {
     return configData_["websocket"]["endpoint"].get<std::string>();
 }
 
+std::vector<std::string> Config::getWebSocketEndpoints() const {
+    const auto& ws = configData_["websocket"];
+    if (ws.contains("endpoints") && ws["endpoints"].is_array() && !ws["endpoints"].empty()) {
+        return ws["endpoints"].get<std::vector<std::string>>();
+    }
+    return {getWebSocketEndpoint()};
+}
+
 void Config::setWebSocketEndpoint(const std::string& endpoint) {
     configData_["websocket"]["endpoint"] = endpoint;
 }
@@ -55,6 +63,31 @@ int Config::getPingIntervalMs() const {
     return configData_["websocket"]["ping_interval_ms"];
 }
 
+int Config::getConnectTimeoutMs() const {
+    return configData_["websocket"].value("connect_timeout_ms", 10000);
+}
+
+bool Config::isCompressionEnabled() const {
+    return configData_["websocket"].value("compression", false);
+}
+
+bool Config::isArbitrationEnabled() const {
+    return configData_["websocket"].value("arbitration", false);
+}
+
+std::vector<std::pair<std::string, std::string>> Config::getSubscriptions() const {
+    std::vector<std::pair<std::string, std::string>> result;
+    const auto& ws = configData_["websocket"];
+    if (!ws.contains("subscriptions") || !ws["subscriptions"].is_array()) {
+        return result;
+    }
+
+    for (const auto& subscription : ws["subscriptions"]) {
+        result.emplace_back(subscription.value("channel", "books"), subscription.value("instId", ""));
+    }
+    return result;
+}
+
 std::vector<Exchange> Config::getExchanges() const {
     std::vector<Exchange> result;
     for (const auto& [name, exchange] : exchanges_) {
@@ -129,8 +162,20 @@ std::string Config::getDefaultOrderType() const {
     return configData_["simulator"]["default_order_type"];
 }
 
-int Config::getUpdateIntervalMs() const {
-    return configData_["simulator"]["update_interval_ms"];
+int Config::getMinSimulationIntervalMs() const {
+    return configData_["simulator"].value("min_interval_ms", 0);
+}
+
+int Config::getSnapshotDepth() const {
+    return configData_["simulator"].value("snapshot_depth", 400);
+}
+
+bool Config::isSimulationEngineEnabled() const {
+    return configData_["simulator"].value("engine_enabled", false);
+}
+
+int Config::getSimulationEngineThreads() const {
+    return configData_["simulator"].value("engine_threads", 0);
 }
 
 std::string Config::getLogLevel() const {
@@ -169,6 +214,65 @@ int Config::getProcessingThreads() const {
     return configData_["performance"]["processing_threads"];
 }
 
+std::string Config::getQueueType() const {
+    return configData_["performance"].value("queue_type", "mpmc");
+}
+
+std::string Config::getWaitStrategy() const {
+    return configData_["performance"].value("wait_strategy", "spin_yield");
+}
+
+int Config::getSpinIterations() const {
+    return configData_["performance"].value("spin_iterations", 1000);
+}
+
+int Config::getIoThreads() const {
+    return configData_["performance"].value("io_threads", 1);
+}
+
+std::vector<int> Config::getIoThreadCpus() const {
+    return configData_["performance"].value("io_thread_cpus", std::vector<int>{});
+}
+
+std::string Config::getIoThreadPolicy() const {
+    return configData_["performance"].value("io_thread_policy", "other");
+}
+
+int Config::getIoThreadPriority() const {
+    return configData_["performance"].value("io_thread_priority", 0);
+}
+
+SocketTuning Config::getSocketTuning() const {
+    SocketTuning tuning;
+    const auto& performance = configData_["performance"];
+    if (!performance.contains("socket")) {
+        return tuning;
+    }
+
+    const auto& socket = performance["socket"];
+    tuning.receiveBufferBytes = socket.value("rcvbuf_bytes", tuning.receiveBufferBytes);
+    tuning.tcpNoDelay = socket.value("tcp_nodelay", tuning.tcpNoDelay);
+    tuning.busyPollUs = socket.value("busy_poll_us", tuning.busyPollUs);
+    tuning.quickAck = socket.value("quick_ack", tuning.quickAck);
+    return tuning;
+}
+
+bool Config::isCaptureEnabled() const {
+    return configData_.contains("capture") && configData_["capture"].value("enabled", false);
+}
+
+std::string Config::getCaptureDirectory() const {
+    if (!configData_.contains("capture")) {
+        return "capture";
+    }
+    return configData_["capture"].value("directory", "capture");
+}
+
+size_t Config::getCaptureSegmentBytes() const {
+    size_t segmentMb = configData_.contains("capture") ? configData_["capture"].value("segment_mb", 256) : 256;
+    return segmentMb * 1024 * 1024;
+}
+
 void Config::parseExchanges() {
     exchanges_.clear();
     
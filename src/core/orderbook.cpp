@@ -19,23 +19,19 @@ void OrderBook::update(const std::string& exchange,
                      const std::string& symbol, 
                      const std::vector<std::pair<std::string, std::string>>& bids,
                      const std::vector<std::pair<std::string, std::string>>& asks,
-                     const std::string& timestamp) {
+                     const std::string& timestamp,
+                     int64_t seqId) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     exchange_ = exchange;
     symbol_ = symbol;
+    seqId_ = seqId;
     
     // Parse timestamp
     timestamp_ = utils::parseISOTimestamp(timestamp);
     
     // Record update time
-    lastUpdateTime_ = utils::currentTime();
-    updateTimes_.push_back(lastUpdateTime_);
-    
-    // Keep only the last 100 update times for frequency calculation
-    if (updateTimes_.size() > 100) {
-        updateTimes_.erase(updateTimes_.begin());
-    }
+    recordUpdateTime();
     
     // Clear and update bids
     bids_.clear();
@@ -60,6 +56,105 @@ void OrderBook::update(const std::string& exchange,
     }
 }
 
+bool OrderBook::applyDelta(const std::vector<std::pair<std::string, std::string>>& bids,
+                           const std::vector<std::pair<std::string, std::string>>& asks,
+                           const std::string& timestamp,
+                           int64_t prevSeqId,
+                           int64_t seqId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (prevSeqId >= 0 && seqId_ >= 0 && prevSeqId != seqId_) {
+        return false;
+    }
+    seqId_ = seqId;
+
+    timestamp_ = utils::parseISOTimestamp(timestamp);
+    recordUpdateTime();
+
+    for (const auto& [priceStr, quantityStr] : bids) {
+        double price = toDouble(priceStr);
+        double quantity = toDouble(quantityStr);
+        if (quantity > 0) {
+            bids_[price] = quantity;
+        } else {
+            bids_.erase(price);
+        }
+    }
+
+    for (const auto& [priceStr, quantityStr] : asks) {
+        double price = toDouble(priceStr);
+        double quantity = toDouble(quantityStr);
+        if (quantity > 0) {
+            asks_[price] = quantity;
+        } else {
+            asks_.erase(price);
+        }
+    }
+    return true;
+}
+
+void OrderBook::update(const std::string& exchange,
+                       const std::string& symbol,
+                       const PriceLevels& bids,
+                       const PriceLevels& asks,
+                       std::chrono::system_clock::time_point timestamp,
+                       int64_t seqId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    exchange_ = exchange;
+    symbol_ = symbol;
+    seqId_ = seqId;
+    timestamp_ = timestamp;
+    recordUpdateTime();
+
+    bids_.clear();
+    for (const auto& level : bids) {
+        if (level.price > 0 && level.quantity > 0) {
+            bids_[level.price] = level.quantity;
+        }
+    }
+
+    asks_.clear();
+    for (const auto& level : asks) {
+        if (level.price > 0 && level.quantity > 0) {
+            asks_[level.price] = level.quantity;
+        }
+    }
+}
+
+bool OrderBook::applyDelta(const PriceLevels& bids,
+                           const PriceLevels& asks,
+                           std::chrono::system_clock::time_point timestamp,
+                           int64_t prevSeqId,
+                           int64_t seqId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (prevSeqId >= 0 && seqId_ >= 0 && prevSeqId != seqId_) {
+        return false;
+    }
+    seqId_ = seqId;
+
+    timestamp_ = timestamp;
+    recordUpdateTime();
+
+    for (const auto& level : bids) {
+        if (level.quantity > 0) {
+            bids_[level.price] = level.quantity;
+        } else {
+            bids_.erase(level.price);
+        }
+    }
+
+    for (const auto& level : asks) {
+        if (level.quantity > 0) {
+            asks_[level.price] = level.quantity;
+        } else {
+            asks_.erase(level.price);
+        }
+    }
+    return true;
+}
+
 PriceLevels OrderBook::getBids() const {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -80,6 +175,43 @@ PriceLevels OrderBook::getAsks() const {
     return result;
 }
 
+void OrderBook::getTopLevels(size_t depth, PriceLevels& bids, PriceLevels& asks) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    bids.clear();
+    for (auto it = bids_.begin(); it != bids_.end() && bids.size() < depth; ++it) {
+        bids.push_back({it->first, it->second});
+    }
+    asks.clear();
+    for (auto it = asks_.begin(); it != asks_.end() && asks.size() < depth; ++it) {
+        asks.push_back({it->first, it->second});
+    }
+}
+
+void OrderBook::getSnapshot(size_t depth, OrderBookSnapshot& snapshot) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    snapshot.bids.clear();
+    snapshot.totalBidVolume = 0.0;
+    for (const auto& [price, quantity] : bids_) {
+        if (snapshot.bids.size() < depth) {
+            snapshot.bids.push_back({price, quantity});
+        }
+        snapshot.totalBidVolume += quantity;
+    }
+    snapshot.asks.clear();
+    snapshot.totalAskVolume = 0.0;
+    for (const auto& [price, quantity] : asks_) {
+        if (snapshot.asks.size() < depth) {
+            snapshot.asks.push_back({price, quantity});
+        }
+        snapshot.totalAskVolume += quantity;
+    }
+    snapshot.lastUpdateTime = lastUpdateTime_;
+    snapshot.seqId = seqId_;
+    snapshot.version = version_.load(std::memory_order_relaxed);
+}
+
 double OrderBook::getBestBid() const {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -165,7 +297,13 @@ double OrderBook::estimateMarketImpact(double quantity, bool isBuy) const {
     double remainingQuantity = quantity;
     double totalPrice = 0.0;
     
-    double referencePrice = isBuy ? getBestAsk() : getBestBid();
+    // Read directly: the getters take mutex_, which is already held
+    double referencePrice = 0.0;
+    if (isBuy && !asks_.empty()) {
+        referencePrice = asks_.begin()->first;
+    } else if (!isBuy && !bids_.empty()) {
+        referencePrice = bids_.begin()->first;
+    }
     
     if (referencePrice <= 0.0) {
         return 0.0;
@@ -210,7 +348,7 @@ double OrderBook::estimateMarketImpact(double quantity, bool isBuy) const {
         if (remainingQuantity > 0.0) {
             // Use the last available price for the remaining quantity
             if (!bids_.empty()) {
-                double lastPrice = bids_.begin()->first;
+                double lastPrice = bids_.rbegin()->first;
                 totalPrice += lastPrice * remainingQuantity;
             } else {
                 return 0.0; // No liquidity at all
@@ -242,6 +380,15 @@ std::chrono::system_clock::time_point OrderBook::getLastUpdateTime() const {
     return lastUpdateTime_;
 }
 
+uint64_t OrderBook::getVersion() const {
+    return version_.load(std::memory_order_acquire);
+}
+
+int64_t OrderBook::getSequenceId() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return seqId_;
+}
+
 int OrderBook::getLevelsCount(bool isBid) const {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -266,12 +413,19 @@ double OrderBook::getUpdateFrequency() const {
     return (updateTimes_.size() - 1) * 1000.0 / duration;
 }
 
-double OrderBook::toDouble(const std::string& str) {
-    try {
-        return std::stod(str);
-    } catch (const std::exception& e) {
-        return 0.0;
+void OrderBook::recordUpdateTime() {
+    version_.fetch_add(1, std::memory_order_release);
+    lastUpdateTime_ = utils::currentTime();
+    updateTimes_.push_back(lastUpdateTime_);
+
+    // Keep only the last 100 update times for frequency calculation
+    if (updateTimes_.size() > 100) {
+        updateTimes_.erase(updateTimes_.begin());
     }
 }
 
+double OrderBook::toDouble(const std::string& str) {
+    return utils::parseDecimalDouble(str);
+}
+
 } // namespace core 
\ No newline at end of file
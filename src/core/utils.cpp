@@ -1,13 +1,19 @@
 
 #include "core/utils.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cmath>
-#include <iomanip>
+#include <cstdio>
 #include <sstream>
 #include <stdexcept>
-#include <regex>
 #include <numeric>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace core {
 namespace utils {
@@ -70,40 +76,118 @@ int parseInt(const std::string& str, int defaultValue) {
     }
 }
 
+bool parseDecimal(std::string_view text, int64_t& mantissa, int& decimals) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    bool negative = p < end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+
+    uint64_t value = 0;
+    int digits = 0;
+    int fraction = -1;
+    for (; p < end; ++p) {
+        unsigned digit = static_cast<unsigned char>(*p) - '0';
+        if (digit < 10) {
+            // 18 significant digits always fit in an int64
+            if (++digits > 18) {
+                return false;
+            }
+            value = value * 10 + digit;
+            if (fraction >= 0) {
+                ++fraction;
+            }
+        } else if (*p == '.' && fraction < 0) {
+            fraction = 0;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    mantissa = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    decimals = fraction > 0 ? fraction : 0;
+    return true;
+}
+
+double parseDecimalDouble(std::string_view text, double defaultValue) {
+    // Exact powers of ten: mantissa / 10^d is then correctly rounded, the
+    // same double std::stod returns
+    static constexpr double kPowers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                         1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+    int64_t mantissa;
+    int decimals;
+    if (parseDecimal(text, mantissa, decimals) && mantissa < (int64_t{1} << 53) && mantissa > -(int64_t{1} << 53)) {
+        return static_cast<double>(mantissa) / kPowers[decimals];
+    }
+    return parseDouble(std::string(text), defaultValue);
+}
+
 // Time utilities
-std::chrono::system_clock::time_point parseISOTimestamp(const std::string& timestamp) {
-    // Parse ISO 8601 format: YYYY-MM-DDThh:mm:ssZ
-    std::tm tm = {};
-    std::istringstream ss(timestamp);
-    
-    // Try to parse with millisecond precision
-    ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
-    
-    if (ss.fail()) {
-        // Try alternative format
-        std::istringstream ss2(timestamp);
-        ss2 >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-        
-        if (ss2.fail()) {
-            return std::chrono::system_clock::now(); // Return current time if parsing fails
+namespace {
+
+// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil)
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+bool readDigits(const std::string& text, size_t pos, size_t count, int& value) {
+    if (pos + count > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = pos; i < pos + count; ++i) {
+        unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+        if (digit > 9) {
+            return false;
         }
+        value = value * 10 + static_cast<int>(digit);
     }
-    
-    // Convert tm to time_point
-    auto time = std::chrono::system_clock::from_time_t(std::mktime(&tm));
-    
-    // Check if we have milliseconds
-    std::regex regex("\\.[0-9]+");
-    std::smatch match;
-    if (std::regex_search(timestamp, match, regex)) {
-        std::string ms_str = match.str().substr(1); // Remove the leading dot
-        while (ms_str.length() < 3) ms_str += "0"; // Ensure we have 3 digits
-        if (ms_str.length() > 3) ms_str = ms_str.substr(0, 3); // Truncate to milliseconds
-        
-        auto ms = std::chrono::milliseconds(std::stoi(ms_str));
-        time += ms;
+    return true;
+}
+
+} // namespace
+
+std::chrono::system_clock::time_point parseISOTimestamp(const std::string& timestamp) {
+    // Parse ISO 8601 in UTC: YYYY-MM-DDThh:mm:ss[.fff][Z] (or a space instead of T).
+    // Called for every book update, so the fixed layout is read digit by digit.
+    int year, month, day, hour, minute, second;
+    if (!readDigits(timestamp, 0, 4, year) || timestamp[4] != '-' ||
+        !readDigits(timestamp, 5, 2, month) || timestamp[7] != '-' ||
+        !readDigits(timestamp, 8, 2, day) || (timestamp[10] != 'T' && timestamp[10] != ' ') ||
+        !readDigits(timestamp, 11, 2, hour) || timestamp[13] != ':' ||
+        !readDigits(timestamp, 14, 2, minute) || timestamp[16] != ':' ||
+        !readDigits(timestamp, 17, 2, second) || month < 1 || month > 12 || day < 1 || day > 31) {
+        return std::chrono::system_clock::now(); // Return current time if parsing fails
     }
-    
+
+    int64_t seconds = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400 +
+                      hour * 3600 + minute * 60 + second;
+    auto time = std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+
+    // Fractional seconds, truncated to milliseconds
+    if (timestamp.size() > 20 && timestamp[19] == '.') {
+        int ms = 0;
+        size_t digits = 0;
+        for (size_t i = 20; i < timestamp.size() && std::isdigit(static_cast<unsigned char>(timestamp[i])); ++i) {
+            if (digits++ < 3) {
+                ms = ms * 10 + (timestamp[i] - '0');
+            }
+        }
+        for (; digits < 3; ++digits) {
+            ms *= 10;
+        }
+        time += std::chrono::milliseconds(ms);
+    }
+
     return time;
 }
 
@@ -111,21 +195,52 @@ std::string formatTimestamp(const std::chrono::system_clock::time_point& timesta
     auto time_t = std::chrono::system_clock::to_time_t(timestamp);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         timestamp.time_since_epoch()).count() % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%dT%H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms;
-    ss << 'Z';
-    
-    return ss.str();
+
+    // UTC to match the trailing Z (and parseISOTimestamp)
+    std::tm tm{};
+    gmtime_r(&time_t, &tm);
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                  static_cast<int>(ms));
+    return buffer;
 }
 
+// Nanoseconds since the epoch; 0 means the wall clock
+static std::atomic<int64_t> virtualTimeNs{0};
+
 std::chrono::system_clock::time_point currentTime() {
-    return std::chrono::system_clock::now();
+    int64_t virtualNs = virtualTimeNs.load(std::memory_order_relaxed);
+    if (virtualNs == 0) {
+        return std::chrono::system_clock::now();
+    }
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(virtualNs)));
+}
+
+void setVirtualTime(const std::chrono::system_clock::time_point& timestamp) {
+    int64_t ns = systemClockNanos(timestamp);
+    virtualTimeNs.store(ns != 0 ? ns : 1, std::memory_order_relaxed);
+}
+
+void advanceVirtualTime(int64_t wallNs) {
+    // Several decode workers apply frames concurrently; keep the latest
+    int64_t current = virtualTimeNs.load(std::memory_order_relaxed);
+    while (current != 0 && current < wallNs &&
+           !virtualTimeNs.compare_exchange_weak(current, wallNs, std::memory_order_relaxed)) {
+    }
+}
+
+void clearVirtualTime() {
+    virtualTimeNs.store(0, std::memory_order_relaxed);
+}
+
+bool isVirtualTime() {
+    return virtualTimeNs.load(std::memory_order_relaxed) != 0;
 }
 
 double getElapsedMilliseconds(const std::chrono::system_clock::time_point& start) {
-    auto now = std::chrono::system_clock::now();
+    auto now = currentTime();
     return std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
 }
 
@@ -134,6 +249,53 @@ double getElapsedMicroseconds(const std::chrono::high_resolution_clock::time_poi
     return std::chrono::duration_cast<std::chrono::microseconds>(now - start).count();
 }
 
+int64_t steadyClockNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t systemClockNanos(const std::chrono::system_clock::time_point& timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+// Thread utilities
+bool setCurrentThreadAffinity(int cpu) {
+#ifdef __linux__
+    int cpuCount = static_cast<int>(std::thread::hardware_concurrency());
+    if (cpu < 0 || (cpuCount > 0 && cpu >= cpuCount)) {
+        return false;
+    }
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+    (void)cpu;
+    return false; // Hard affinity is not available on this platform
+#endif
+}
+
+bool setCurrentThreadScheduling(const std::string& policy, int priority) {
+#ifdef __linux__
+    int native = SCHED_OTHER;
+    if (policy == "fifo") {
+        native = SCHED_FIFO;
+    } else if (policy == "rr") {
+        native = SCHED_RR;
+    } else if (policy != "other") {
+        return false;
+    }
+
+    sched_param param{};
+    param.sched_priority = native == SCHED_OTHER ? 0 : priority;
+    return pthread_setschedparam(pthread_self(), native, &param) == 0;
+#else
+    (void)priority;
+    return policy == "other"; // Only the default policy is available here
+#endif
+}
+
 // Market data utilities
 double calculateVWAP(const std::map<double, double>& levels) {
     double totalVolume = 0.0;
@@ -194,20 +356,28 @@ std::vector<std::pair<double, double>> calculateCumulativeVolume(const std::map<
 
 // Statistical utilities
 double mean(const std::vector<double>& values) {
-    if (values.empty()) {
+    return mean(values.data(), values.size());
+}
+
+double mean(const double* values, size_t count) {
+    if (count == 0) {
         return 0.0;
     }
     
-    double sum = std::accumulate(values.begin(), values.end(), 0.0);
-    return sum / values.size();
+    double sum = std::accumulate(values, values + count, 0.0);
+    return sum / count;
 }
 
 double median(const std::vector<double>& values) {
-    if (values.empty()) {
+    return median(values.data(), values.size());
+}
+
+double median(const double* values, size_t count) {
+    if (count == 0) {
         return 0.0;
     }
     
-    std::vector<double> sortedValues = values;
+    std::vector<double> sortedValues(values, values + count);
     std::sort(sortedValues.begin(), sortedValues.end());
     
     size_t size = sortedValues.size();
@@ -219,26 +389,34 @@ double median(const std::vector<double>& values) {
 }
 
 double standardDeviation(const std::vector<double>& values) {
-    if (values.size() < 2) {
+    return standardDeviation(values.data(), values.size());
+}
+
+double standardDeviation(const double* values, size_t count) {
+    if (count < 2) {
         return 0.0;
     }
     
-    double avg = mean(values);
+    double avg = mean(values, count);
     double sum = 0.0;
     
-    for (double value : values) {
-        sum += (value - avg) * (value - avg);
+    for (size_t i = 0; i < count; ++i) {
+        sum += (values[i] - avg) * (values[i] - avg);
     }
     
-    return std::sqrt(sum / (values.size() - 1));
+    return std::sqrt(sum / (count - 1));
 }
 
 double percentile(const std::vector<double>& values, double percentileRank) {
-    if (values.empty()) {
+    return percentile(values.data(), values.size(), percentileRank);
+}
+
+double percentile(const double* values, size_t count, double percentileRank) {
+    if (count == 0) {
         return 0.0;
     }
     
-    std::vector<double> sortedValues = values;
+    std::vector<double> sortedValues(values, values + count);
     std::sort(sortedValues.begin(), sortedValues.end());
     
     double index = percentileRank * (sortedValues.size() - 1);
@@ -254,60 +432,73 @@ double percentile(const std::vector<double>& values, double percentileRank) {
 }
 
 double skewness(const std::vector<double>& values) {
-    if (values.size() < 3) {
+    return skewness(values.data(), values.size());
+}
+
+double skewness(const double* values, size_t count) {
+    if (count < 3) {
         return 0.0;
     }
     
-    double avg = mean(values);
-    double stdDev = standardDeviation(values);
+    double avg = mean(values, count);
+    double stdDev = standardDeviation(values, count);
     
     if (stdDev == 0.0) {
         return 0.0;
     }
     
     double sum = 0.0;
-    for (double value : values) {
-        double deviation = (value - avg) / stdDev;
+    for (size_t i = 0; i < count; ++i) {
+        double deviation = (values[i] - avg) / stdDev;
         sum += deviation * deviation * deviation;
     }
     
-    return sum / values.size();
+    return sum / count;
 }
 
 double kurtosis(const std::vector<double>& values) {
-    if (values.size() < 4) {
+    return kurtosis(values.data(), values.size());
+}
+
+double kurtosis(const double* values, size_t count) {
+    if (count < 4) {
         return 0.0;
     }
     
-    double avg = mean(values);
-    double stdDev = standardDeviation(values);
+    double avg = mean(values, count);
+    double stdDev = standardDeviation(values, count);
     
     if (stdDev == 0.0) {
         return 0.0;
     }
     
     double sum = 0.0;
-    for (double value : values) {
-        double deviation = (value - avg) / stdDev;
+    for (size_t i = 0; i < count; ++i) {
+        double deviation = (values[i] - avg) / stdDev;
         sum += deviation * deviation * deviation * deviation;
     }
     
-    return sum / values.size() - 3.0; // Excess kurtosis (normal distribution has kurtosis of 3)
+    return sum / count - 3.0; // Excess kurtosis (normal distribution has kurtosis of 3)
 }
 
 // Linear regression
 RegressionResult linearRegression(const std::vector<double>& x, const std::vector<double>& y) {
-    if (x.size() != y.size() || x.empty()) {
+    if (x.size() != y.size()) {
+        return {0.0, 0.0, 0.0}; // Invalid input
+    }
+    return linearRegression(x.data(), y.data(), x.size());
+}
+
+RegressionResult linearRegression(const double* x, const double* y, size_t n) {
+    if (n == 0) {
         return {0.0, 0.0, 0.0}; // Invalid input
     }
     
-    double sumX = std::accumulate(x.begin(), x.end(), 0.0);
-    double sumY = std::accumulate(y.begin(), y.end(), 0.0);
+    double sumX = std::accumulate(x, x + n, 0.0);
+    double sumY = std::accumulate(y, y + n, 0.0);
     double sumXY = 0.0;
     double sumX2 = 0.0;
     
-    size_t n = x.size();
-    
     for (size_t i = 0; i < n; ++i) {
         sumXY += x[i] * y[i];
         sumX2 += x[i] * x[i];
@@ -49,14 +49,21 @@ double AlmgrenChrissModel::calculateMarketImpact(const std::shared_ptr<core::Ord
         return 0.0;
     }
     
-    // Get reference price (mid price)
-    double referencePrice = orderBook->getMidPrice();
-    if (referencePrice <= 0.0) {
+    // Mid, spread and depth from one version of the book
+    MarketSnapshot market;
+    market.capture(*orderBook, 1);
+    return calculateMarketImpact(market, quantity, isBuy);
+}
+
+double AlmgrenChrissModel::calculateMarketImpact(const MarketSnapshot& market,
+                                              double quantity,
+                                              bool isBuy) const {
+    if (quantity <= 0.0 || market.midPrice <= 0.0) {
         return 0.0;
     }
     
-    // Calculate market depth and imbalance
-    double totalVolume = isBuy ? orderBook->getTotalAskVolume() : orderBook->getTotalBidVolume();
+    // Calculate market depth
+    double totalVolume = isBuy ? market.book.totalAskVolume : market.book.totalBidVolume;
     if (totalVolume <= 0.0) {
         return 0.0;
     }
@@ -65,10 +72,10 @@ double AlmgrenChrissModel::calculateMarketImpact(const std::shared_ptr<core::Ord
     double volumeRatio = quantity / totalVolume;
     
     // Calculate temporary impact using square root model
-    double temporaryImpact = calculateTemporaryImpact(volumeRatio, orderBook);
+    double temporaryImpact = calculateTemporaryImpact(volumeRatio, market);
     
     // Calculate permanent impact
-    double permanentImpact = calculatePermanentImpact(quantity, orderBook);
+    double permanentImpact = calculatePermanentImpact(quantity, market);
     
     // Total impact is the sum of temporary and permanent impacts
     return temporaryImpact + permanentImpact;
@@ -158,21 +165,13 @@ double AlmgrenChrissModel::getMarketRiskAversion() const {
     return riskAversion_;
 }
 
-double AlmgrenChrissModel::calculateTemporaryImpact(double rate, const std::shared_ptr<core::OrderBook>& orderBook) const {
+double AlmgrenChrissModel::calculateTemporaryImpact(double rate, const MarketSnapshot& market) const {
     // Temporary impact model: η * √(rate)
     // η is the market impact factor, rate is the trading rate
+    double referencePrice = market.midPrice;
     
-    if (!orderBook) {
-        return 0.0;
-    }
-    
-    double referencePrice = orderBook->getMidPrice();
-    double sigma = volatility_ * referencePrice; // Price volatility
-    
-    // Calculate average spread as a proxy for market liquidity
-    double spread = orderBook->getSpread();
-    double midPrice = orderBook->getMidPrice();
-    double relativeSpread = midPrice > 0.0 ? spread / midPrice : 0.001;
+    // Relative spread as a proxy for market liquidity
+    double relativeSpread = referencePrice > 0.0 ? market.relativeSpread : 0.001;
     
     // Adjust impact factor based on spread
     double adjustedFactor = marketImpactFactor_ * (1.0 + 10.0 * relativeSpread);
@@ -181,18 +180,13 @@ double AlmgrenChrissModel::calculateTemporaryImpact(double rate, const std::shar
     return adjustedFactor * referencePrice * std::sqrt(rate);
 }
 
-double AlmgrenChrissModel::calculatePermanentImpact(double quantity, const std::shared_ptr<core::OrderBook>& orderBook) const {
+double AlmgrenChrissModel::calculatePermanentImpact(double quantity, const MarketSnapshot& market) const {
     // Permanent impact model: γ * quantity
     // γ is the permanent impact factor
-    
-    if (!orderBook) {
-        return 0.0;
-    }
-    
-    double referencePrice = orderBook->getMidPrice();
+    double referencePrice = market.midPrice;
     
     // Calculate total volume as a measure of market depth
-    double totalVolume = orderBook->getTotalBidVolume() + orderBook->getTotalAskVolume();
+    double totalVolume = market.book.totalBidVolume + market.book.totalAskVolume;
     
     if (totalVolume <= 0.0) {
         return 0.0;
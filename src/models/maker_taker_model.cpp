@@ -37,6 +37,19 @@ void MakerTakerModel::setTrainingData(const std::vector<double>& quantities,
     core::Logger::getInstance().info("Training data set with {} samples", quantities.size());
 }
 
+void MakerTakerModel::setTrainingData(const double* quantities,
+                                      const double* spreads,
+                                      const double* volatilities,
+                                      const double* makerRatios,
+                                      size_t count) {
+    quantityData_.assign(quantities, quantities + count);
+    spreadData_.assign(spreads, spreads + count);
+    volatilityData_.assign(volatilities, volatilities + count);
+    makerRatioData_.assign(makerRatios, makerRatios + count);
+
+    core::Logger::getInstance().info("Training data set with {} samples", count);
+}
+
 bool MakerTakerModel::train() {
     if (quantityData_.empty() || spreadData_.empty() || 
         volatilityData_.empty() || makerRatioData_.empty()) {
@@ -124,16 +137,21 @@ double MakerTakerModel::predictMakerRatio(const std::shared_ptr<core::OrderBook>
         return 0.0; // Default to all taker orders
     }
     
-    // Get spread
-    double spread = orderBook->getSpread();
-    double midPrice = orderBook->getMidPrice();
-    
-    // Normalize
-    double normQuantity = quantity / 100.0;  // Assuming 100 BTC is a large order
-    double normSpread = midPrice > 0.0 ? spread / midPrice : 0.0;
-    double normVolatility = volatility;
-    
-    return predict(normQuantity, normSpread, normVolatility);
+    // Spread and mid from one version of the book
+    MarketSnapshot market;
+    market.capture(*orderBook, 1);
+    return predictMakerRatio(market, quantity, volatility);
+}
+
+double MakerTakerModel::predictMakerRatio(const MarketSnapshot& market,
+                                        double quantity,
+                                        double volatility) const {
+    if (quantity <= 0.0) {
+        return 0.0; // Default to all taker orders
+    }
+
+    // Normalize: 100 BTC is a large order, the spread is relative to mid
+    return predict(quantity / 100.0, market.relativeSpread, volatility);
 }
 
 double MakerTakerModel::predictMakerProbability(const std::shared_ptr<core::OrderBook>& orderBook,
@@ -143,6 +161,16 @@ double MakerTakerModel::predictMakerProbability(const std::shared_ptr<core::Orde
     return predictMakerRatio(orderBook, quantity, volatility);
 }
 
+void MakerTakerModel::predictMakerRatioCurve(const MarketSnapshot& market,
+                                             const double* quantities,
+                                             size_t count,
+                                             double volatility,
+                                             double* ratios) const {
+    for (size_t i = 0; i < count; ++i) {
+        ratios[i] = predictMakerRatio(market, quantities[i], volatility);
+    }
+}
+
 std::vector<std::pair<double, double>> MakerTakerModel::calculateProbabilityCurve(
     const std::shared_ptr<core::OrderBook>& orderBook,
     double maxQuantity,
@@ -155,11 +183,14 @@ std::vector<std::pair<double, double>> MakerTakerModel::calculateProbabilityCurv
         return curve;
     }
     
-    // Calculate probability for different quantities
+    // Spread and mid only, from one version of the book for every point
+    MarketSnapshot market;
+    market.capture(*orderBook, 1);
+    
+    curve.reserve(steps + 1);
     for (int i = 0; i <= steps; ++i) {
         double quantity = maxQuantity * i / steps;
-        double probability = predictMakerProbability(orderBook, quantity, volatility);
-        curve.emplace_back(quantity, probability);
+        curve.emplace_back(quantity, predictMakerRatio(market, quantity, volatility));
     }
     
     return curve;
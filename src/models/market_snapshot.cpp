@@ -0,0 +1,82 @@
+#include "models/market_snapshot.h"
+#include <algorithm>
+
+namespace models {
+
+namespace {
+
+void accumulate(const core::PriceLevels& levels, std::vector<double>& depth, std::vector<double>& notional) {
+    depth.resize(levels.size());
+    notional.resize(levels.size());
+    double quantity = 0.0;
+    double cost = 0.0;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        quantity += levels[i].quantity;
+        cost += levels[i].price * levels[i].quantity;
+        depth[i] = quantity;
+        notional[i] = cost;
+    }
+}
+
+} // namespace
+
+bool MarketSnapshot::capture(const core::OrderBook& orderBook, size_t depth) {
+    orderBook.getSnapshot(depth, book);
+
+    bestBid = book.bids.empty() ? 0.0 : book.bids.front().price;
+    bestAsk = book.asks.empty() ? 0.0 : book.asks.front().price;
+    bool twoSided = bestBid > 0.0 && bestAsk > 0.0;
+    midPrice = twoSided ? (bestBid + bestAsk) / 2.0 : 0.0;
+    spread = twoSided ? bestAsk - bestBid : 0.0;
+    relativeSpread = twoSided ? spread / midPrice : 0.0;
+
+    accumulate(book.bids, bidDepth, bidNotional);
+    accumulate(book.asks, askDepth, askNotional);
+    return twoSided;
+}
+
+double MarketSnapshot::averageFillPrice(double quantity, bool isBuy) const {
+    const core::PriceLevels& levels = isBuy ? book.asks : book.bids;
+    const std::vector<double>& depth = isBuy ? askDepth : bidDepth;
+    const std::vector<double>& notional = isBuy ? askNotional : bidNotional;
+    if (levels.empty() || quantity <= 0.0) {
+        return 0.0;
+    }
+
+    // First level that completes the order
+    size_t level = std::lower_bound(depth.begin(), depth.end(), quantity) - depth.begin();
+    if (level == levels.size()) {
+        return (notional.back() + levels.back().price * (quantity - depth.back())) / quantity;
+    }
+    double before = level > 0 ? depth[level - 1] : 0.0;
+    double cost = level > 0 ? notional[level - 1] : 0.0;
+    return (cost + levels[level].price * (quantity - before)) / quantity;
+}
+
+void MarketSnapshot::averageFillPrices(const double* quantities, size_t count, bool isBuy, double* prices) const {
+    const core::PriceLevels& levels = isBuy ? book.asks : book.bids;
+    const std::vector<double>& depth = isBuy ? askDepth : bidDepth;
+    const std::vector<double>& notional = isBuy ? askNotional : bidNotional;
+
+    // Each quantity resumes the walk where the previous one stopped
+    size_t level = 0;
+    for (size_t i = 0; i < count; ++i) {
+        double quantity = quantities[i];
+        if (levels.empty() || quantity <= 0.0) {
+            prices[i] = 0.0;
+            continue;
+        }
+        while (level < levels.size() && depth[level] < quantity) {
+            ++level;
+        }
+        if (level == levels.size()) {
+            prices[i] = (notional.back() + levels.back().price * (quantity - depth.back())) / quantity;
+        } else {
+            double before = level > 0 ? depth[level - 1] : 0.0;
+            double cost = level > 0 ? notional[level - 1] : 0.0;
+            prices[i] = (cost + levels[level].price * (quantity - before)) / quantity;
+        }
+    }
+}
+
+} // namespace models
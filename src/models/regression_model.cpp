@@ -58,6 +58,11 @@ void RegressionModel::setTrainingData(const std::vector<double>& x, const std::v
     yData_ = y;
 }
 
+void RegressionModel::setTrainingData(const double* x, const double* y, size_t count) {
+    xData_.assign(x, x + count);
+    yData_.assign(y, y + count);
+}
+
 bool RegressionModel::train() {
     if (xData_.empty() || yData_.empty()) {
         core::Logger::getInstance().warn("Cannot train model with empty data");
@@ -0,0 +1,207 @@
+#include "models/simulation_engine.h"
+#include "core/logger.h"
+#include <algorithm>
+
+namespace models {
+
+SimulationEngine::SimulationEngine(std::shared_ptr<core::Config> config, int numWorkers)
+    : config_(config) {
+    if (numWorkers <= 0 && config_) {
+        numWorkers = config_->getSimulationEngineThreads();
+        if (numWorkers <= 0) {
+            numWorkers = config_->getProcessingThreads();
+        }
+    }
+    numWorkers = std::max(numWorkers, 1);
+
+    for (int i = 0; i < numWorkers; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    if (config_) {
+        minInterval_ = std::chrono::milliseconds(config_->getMinSimulationIntervalMs());
+    }
+}
+
+SimulationEngine::~SimulationEngine() {
+    stop();
+}
+
+std::shared_ptr<Simulator> SimulationEngine::addInstrument(const std::string& exchange, const std::string& asset,
+                                                           std::shared_ptr<core::OrderBook> orderBook,
+                                                           const std::string& feedInstrument) {
+    if (!orderBook) {
+        core::Logger::getInstance().warn("No order book for {} on {}", asset, exchange);
+        return nullptr;
+    }
+    if (isRunning()) {
+        core::Logger::getInstance().error("Cannot add {} on {} while the simulation engine runs", asset, exchange);
+        return nullptr;
+    }
+
+    Instrument instrument;
+    instrument.orderBook = orderBook;
+    instrument.simulator = std::make_shared<Simulator>(config_);
+    instrument.simulator->init();
+    instrument.simulator->setExchange(exchange);
+    instrument.simulator->setAsset(asset);
+
+    // All instruments of one book share its worker
+    auto [it, added] = bookWorkers_.emplace(orderBook.get(), workerFor(feedInstrument.empty() ? asset : feedInstrument));
+    instrument.worker = it->second;
+
+    Worker& worker = *workers_[instrument.worker];
+    instrument.slot = worker.results.size();
+    worker.instruments.push_back(instruments_.size());
+    worker.results.push_back({exchange, asset, SimulationResult{}, 0, 0});
+
+    instruments_.push_back(std::move(instrument));
+    return instruments_.back().simulator;
+}
+
+size_t SimulationEngine::addConfiguredInstruments(const BookResolver& bookFor) {
+    if (!config_) {
+        return 0;
+    }
+
+    size_t added = 0;
+    for (const auto& exchange : config_->getExchanges()) {
+        for (const auto& asset : exchange.spotAssets) {
+            FeedBook book = bookFor(exchange.name, asset);
+            if (book.orderBook && addInstrument(exchange.name, asset, book.orderBook, book.instrument)) {
+                ++added;
+            }
+        }
+    }
+    return added;
+}
+
+void SimulationEngine::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+
+    for (auto& worker : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(worker->wakeMutex);
+            worker->wakeRequests = 0;
+        }
+        worker->thread = std::thread(&SimulationEngine::runWorker, this, std::ref(*worker));
+    }
+    core::Logger::getInstance().info("Simulation engine started: {} instruments on {} workers",
+                                     instruments_.size(), workers_.size());
+}
+
+void SimulationEngine::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    for (auto& worker : workers_) {
+        // Under the lock so a worker cannot miss the flag between its check and its wait
+        {
+            std::lock_guard<std::mutex> lock(worker->wakeMutex);
+        }
+        worker->wakeCondition.notify_all();
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    core::Logger::getInstance().info("Simulation engine stopped after {} runs", getRunCount());
+}
+
+bool SimulationEngine::isRunning() const {
+    return running_;
+}
+
+void SimulationEngine::notifyBookUpdate(const std::shared_ptr<core::OrderBook>& orderBook) {
+    auto it = bookWorkers_.find(orderBook.get());
+    if (it != bookWorkers_.end()) {
+        wake(*workers_[it->second]);
+    }
+}
+
+void SimulationEngine::getView(std::vector<InstrumentResult>& view) const {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(workers_.size());
+    for (const auto& worker : workers_) {
+        locks.emplace_back(worker->resultsMutex);
+    }
+
+    view.resize(instruments_.size());
+    for (size_t i = 0; i < instruments_.size(); ++i) {
+        const Instrument& instrument = instruments_[i];
+        view[i] = workers_[instrument.worker]->results[instrument.slot];
+    }
+}
+
+size_t SimulationEngine::getInstrumentCount() const {
+    return instruments_.size();
+}
+
+int SimulationEngine::getWorkerCount() const {
+    return static_cast<int>(workers_.size());
+}
+
+uint64_t SimulationEngine::getRunCount() const {
+    uint64_t total = 0;
+    for (const auto& worker : workers_) {
+        total += worker->runs.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t SimulationEngine::workerFor(std::string_view instrument) const {
+    // Same as processing::DecodeStage::workerFor, which hashes the frame's instId
+    return std::hash<std::string_view>{}(instrument) % workers_.size();
+}
+
+void SimulationEngine::wake(Worker& worker) {
+    {
+        std::lock_guard<std::mutex> lock(worker.wakeMutex);
+        ++worker.wakeRequests;
+    }
+    worker.wakeCondition.notify_one();
+}
+
+void SimulationEngine::runWorker(Worker& worker) {
+    uint64_t seenRequests = 0;
+    auto lastPass = std::chrono::steady_clock::time_point{};
+
+    std::unique_lock<std::mutex> lock(worker.wakeMutex);
+    while (running_) {
+        // Rate limit: updates arriving while this waits are picked up by the same pass
+        if (minInterval_.count() > 0) {
+            worker.wakeCondition.wait_until(lock, lastPass + minInterval_, [this] { return !running_; });
+            if (!running_) {
+                break;
+            }
+        }
+        seenRequests = worker.wakeRequests;
+        lock.unlock();
+        lastPass = std::chrono::steady_clock::now();
+
+        for (size_t index : worker.instruments) {
+            Instrument& instrument = instruments_[index];
+            uint64_t version = instrument.orderBook->getVersion();
+            if (instrument.simulated && version == instrument.simulatedVersion) {
+                continue;
+            }
+            instrument.simulated = true;
+            instrument.simulatedVersion = version;
+
+            SimulationResult result = instrument.simulator->simulate(instrument.orderBook);
+            worker.runs.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> resultsLock(worker.resultsMutex);
+            InstrumentResult& slot = worker.results[instrument.slot];
+            slot.result = result;
+            slot.bookVersion = result.bookVersion;
+            ++slot.runs;
+        }
+
+        lock.lock();
+        worker.wakeCondition.wait(lock, [&] { return !running_ || worker.wakeRequests != seenRequests; });
+    }
+}
+
+} // namespace models
@@ -1,10 +1,26 @@
 #include "models/simulator.h"
 #include "core/logger.h"
+#include "core/utils.h"
 #include <thread>
 #include <sstream>
+#include <limits>
 
 namespace models {
 
+namespace {
+
+void resetColumns(BatchResult& results, size_t count) {
+    results.assetQuantity.assign(count, 0.0);
+    results.expectedSlippage.assign(count, 0.0);
+    results.expectedFees.assign(count, 0.0);
+    results.expectedMarketImpact.assign(count, 0.0);
+    results.netCost.assign(count, 0.0);
+    results.makerRatio.assign(count, 0.0);
+    results.internalLatency = 0.0;
+}
+
+} // namespace
+
 Simulator::Simulator(std::shared_ptr<core::Config> config)
     : config_(config), 
       quantity_(0.0),
@@ -17,6 +33,8 @@ Simulator::Simulator(std::shared_ptr<core::Config> config)
     quantity_ = config_->getDefaultQuantityUsd();
     volatility_ = config_->getDefaultVolatility();
     feeTier_ = config_->getDefaultFeeTier();
+    int depth = config_->getSnapshotDepth();
+    snapshotDepth_ = depth > 0 ? static_cast<size_t>(depth) : std::numeric_limits<size_t>::max();
 }
 
 Simulator::~Simulator() {
@@ -38,14 +56,17 @@ void Simulator::init() {
 
 void Simulator::setExchange(const std::string& exchange) {
     exchange_ = exchange;
+    requestSimulation(true);
 }
 
 void Simulator::setAsset(const std::string& asset) {
     asset_ = asset;
+    requestSimulation(true);
 }
 
 void Simulator::setOrderType(const std::string& orderType) {
     orderType_ = orderType;
+    requestSimulation(true);
 }
 
 void Simulator::setQuantity(double quantity) {
@@ -55,6 +76,7 @@ void Simulator::setQuantity(double quantity) {
     }
     
     quantity_ = quantity;
+    requestSimulation(true);
 }
 
 void Simulator::setVolatility(double volatility) {
@@ -69,10 +91,12 @@ void Simulator::setVolatility(double volatility) {
     if (marketImpactModel_) {
         marketImpactModel_->setVolatility(volatility_);
     }
+    requestSimulation(true);
 }
 
 void Simulator::setFeeTier(const std::string& feeTier) {
     feeTier_ = feeTier;
+    requestSimulation(true);
 }
 
 SimulationResult Simulator::simulate(const std::shared_ptr<core::OrderBook>& orderBook) {
@@ -86,7 +110,8 @@ SimulationResult Simulator::simulate(const std::shared_ptr<core::OrderBook>& ord
     result.netCost = 0.0;
     result.makerRatio = 0.0;
     result.internalLatency = 0.0;
-    result.timestamp = std::chrono::system_clock::now();
+    result.timestamp = core::utils::currentTime();
+    result.bookVersion = 0;
     
     if (!orderBook) {
         core::Logger::getInstance().warn("Cannot simulate with null order book");
@@ -94,59 +119,10 @@ SimulationResult Simulator::simulate(const std::shared_ptr<core::OrderBook>& ord
     }
     
     try {
-        // Get current price
-        double price = orderBook->getMidPrice();
-        if (price <= 0.0) {
+        if (!evaluate(*orderBook, result)) {
             return result;
         }
         
-        // Determine if buy/sell based on quantity sign
-        bool isBuy = (quantity_ >= 0.0);
-        double absQuantity = std::abs(quantity_);
-        
-        // Convert USD quantity to asset quantity if needed
-        double assetQuantity = absQuantity;
-        if (orderType_ == "USD") {
-            assetQuantity = absQuantity / price;
-        }
-        
-        // Predict maker/taker ratio
-        double makerRatio = 0.0;
-        if (makerTakerModel_) {
-            makerRatio = makerTakerModel_->predictMakerRatio(orderBook, assetQuantity, volatility_);
-        }
-        
-        // Calculate slippage
-        double slippagePct = 0.0;
-        if (slippageModel_) {
-            slippagePct = slippageModel_->calculateSlippage(orderBook, assetQuantity, isBuy);
-        }
-        
-        // Calculate market impact
-        double marketImpactPct = 0.0;
-        if (marketImpactModel_) {
-            marketImpactPct = marketImpactModel_->calculateMarketImpact(orderBook, assetQuantity, isBuy) / price;
-        }
-        
-        // Calculate fees
-        double fees = 0.0;
-        if (feeModel_) {
-            fees = feeModel_->calculateFees(exchange_, feeTier_, assetQuantity, price, makerRatio);
-        }
-        
-        // Calculate net cost
-        double slippageAmount = price * assetQuantity * slippagePct;
-        double marketImpactAmount = price * assetQuantity * marketImpactPct;
-        double netCost = slippageAmount + marketImpactAmount + fees;
-        
-        // Fill the result
-        result.expectedSlippage = slippagePct * 100.0; // Convert to percentage
-        result.expectedMarketImpact = marketImpactPct * 100.0; // Convert to percentage
-        result.expectedFees = fees;
-        result.netCost = netCost;
-        result.makerRatio = makerRatio;
-        result.timestamp = orderBook->getLastUpdateTime();
-        
         // Calculate latency
         auto endTime = std::chrono::high_resolution_clock::now();
         result.internalLatency = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -173,6 +149,195 @@ SimulationResult Simulator::simulate(const std::shared_ptr<core::OrderBook>& ord
     return result;
 }
 
+bool Simulator::evaluate(const core::OrderBook& orderBook, SimulationResult& result) {
+    // Every model reads this one capture of the book, so the evaluation
+    // itself takes no book locks
+    std::lock_guard<std::mutex> lock(marketMutex_);
+    if (!market_.capture(orderBook, snapshotDepth_)) {
+        return false;
+    }
+    double price = market_.midPrice;
+    
+    // Determine if buy/sell based on quantity sign
+    bool isBuy = (quantity_ >= 0.0);
+    double absQuantity = std::abs(quantity_);
+    
+    // Convert USD quantity to asset quantity if needed
+    double assetQuantity = absQuantity;
+    if (orderType_ == "USD") {
+        assetQuantity = absQuantity / price;
+    }
+    
+    // Predict maker/taker ratio
+    double makerRatio = 0.0;
+    if (makerTakerModel_) {
+        makerRatio = makerTakerModel_->predictMakerRatio(market_, assetQuantity, volatility_);
+    }
+    
+    // Calculate slippage
+    double slippagePct = 0.0;
+    if (slippageModel_) {
+        slippagePct = slippageModel_->calculateSlippage(market_, assetQuantity, isBuy);
+    }
+    
+    // Calculate market impact
+    double marketImpactPct = 0.0;
+    if (marketImpactModel_) {
+        marketImpactPct = marketImpactModel_->calculateMarketImpact(market_, assetQuantity, isBuy) / price;
+    }
+    
+    // Calculate fees
+    double fees = 0.0;
+    if (feeModel_) {
+        fees = feeModel_->calculateFees(exchange_, feeTier_, assetQuantity, price, makerRatio);
+    }
+    
+    // Calculate net cost
+    double slippageAmount = price * assetQuantity * slippagePct;
+    double marketImpactAmount = price * assetQuantity * marketImpactPct;
+    double netCost = slippageAmount + marketImpactAmount + fees;
+    
+    // Fill the result
+    result.expectedSlippage = slippagePct * 100.0; // Convert to percentage
+    result.expectedMarketImpact = marketImpactPct * 100.0; // Convert to percentage
+    result.expectedFees = fees;
+    result.netCost = netCost;
+    result.makerRatio = makerRatio;
+    result.timestamp = market_.book.lastUpdateTime;
+    result.bookVersion = market_.book.version;
+    
+    return true;
+}
+
+bool Simulator::simulateBatch(const std::shared_ptr<core::OrderBook>& orderBook,
+                              const std::vector<Scenario>& scenarios,
+                              BatchResult& results) const {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    size_t count = scenarios.size();
+    resetColumns(results, count);
+
+    if (!orderBook) {
+        core::Logger::getInstance().warn("Cannot simulate with null order book");
+        return false;
+    }
+
+    // Everything below reads this one version of the book
+    MarketSnapshot& market = results.market;
+    if (!market.capture(*orderBook, snapshotDepth_)) {
+        return false;
+    }
+    double price = market.midPrice;
+    bool usdQuantity = orderType_ == "USD";
+
+    // Fee rates per distinct tier; batches hold a handful
+    std::vector<std::pair<const std::string*, std::pair<double, double>>> feeRates;
+    auto ratesFor = [&](const std::string& feeTier) {
+        for (const auto& [tier, rates] : feeRates) {
+            if (*tier == feeTier) {
+                return rates;
+            }
+        }
+        std::pair<double, double> rates(0.0, 0.0);
+        if (feeModel_) {
+            rates = {feeModel_->getMakerFeeRate(exchange_, feeTier), feeModel_->getTakerFeeRate(exchange_, feeTier)};
+        }
+        feeRates.emplace_back(&feeTier, rates);
+        return rates;
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        const Scenario& scenario = scenarios[i];
+        double assetQuantity = usdQuantity ? scenario.quantity / price : scenario.quantity;
+        if (assetQuantity <= 0.0) {
+            continue;
+        }
+        results.assetQuantity[i] = assetQuantity;
+
+        double makerRatio = makerTakerModel_ ?
+            makerTakerModel_->predictMakerRatio(market, assetQuantity, scenario.volatility) : 0.0;
+        double slippagePct = slippageModel_ ?
+            slippageModel_->calculateSlippage(market, assetQuantity, scenario.isBuy) : 0.0;
+        double marketImpactPct = marketImpactModel_ ?
+            marketImpactModel_->calculateMarketImpact(market, assetQuantity, scenario.isBuy) / price : 0.0;
+
+        auto [makerFeeRate, takerFeeRate] = ratesFor(scenario.feeTier);
+        double notional = price * assetQuantity;
+        double fees = notional * (makerFeeRate * makerRatio + takerFeeRate * (1.0 - makerRatio));
+
+        results.expectedSlippage[i] = slippagePct * 100.0;
+        results.expectedMarketImpact[i] = marketImpactPct * 100.0;
+        results.expectedFees[i] = fees;
+        results.netCost[i] = notional * (slippagePct + marketImpactPct) + fees;
+        results.makerRatio[i] = makerRatio;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    results.internalLatency = std::chrono::duration_cast<std::chrono::microseconds>(
+        endTime - startTime).count();
+    return true;
+}
+
+bool Simulator::simulateCurve(const std::shared_ptr<core::OrderBook>& orderBook,
+                              const std::vector<double>& sizes,
+                              bool isBuy,
+                              BatchResult& results) const {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    size_t count = sizes.size();
+    resetColumns(results, count);
+
+    if (!orderBook) {
+        core::Logger::getInstance().warn("Cannot simulate with null order book");
+        return false;
+    }
+
+    MarketSnapshot& market = results.market;
+    if (!market.capture(*orderBook, snapshotDepth_)) {
+        return false;
+    }
+    double price = market.midPrice;
+    bool usdQuantity = orderType_ == "USD";
+    for (size_t i = 0; i < count; ++i) {
+        results.assetQuantity[i] = usdQuantity ? sizes[i] / price : sizes[i];
+    }
+
+    // Whole columns at once; slippage in one pass over the levels
+    const double* quantities = results.assetQuantity.data();
+    if (slippageModel_) {
+        slippageModel_->calculateSlippageCurve(market, quantities, count, isBuy, results.expectedSlippage.data());
+    }
+    if (makerTakerModel_) {
+        makerTakerModel_->predictMakerRatioCurve(market, quantities, count, volatility_, results.makerRatio.data());
+    }
+
+    double makerFeeRate = feeModel_ ? feeModel_->getMakerFeeRate(exchange_, feeTier_) : 0.0;
+    double takerFeeRate = feeModel_ ? feeModel_->getTakerFeeRate(exchange_, feeTier_) : 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double assetQuantity = quantities[i];
+        if (assetQuantity <= 0.0) {
+            continue;
+        }
+
+        double slippagePct = results.expectedSlippage[i];
+        double marketImpactPct = marketImpactModel_ ?
+            marketImpactModel_->calculateMarketImpact(market, assetQuantity, isBuy) / price : 0.0;
+        double makerRatio = results.makerRatio[i];
+        double notional = price * assetQuantity;
+        double fees = notional * (makerFeeRate * makerRatio + takerFeeRate * (1.0 - makerRatio));
+
+        results.expectedSlippage[i] = slippagePct * 100.0;
+        results.expectedMarketImpact[i] = marketImpactPct * 100.0;
+        results.expectedFees[i] = fees;
+        results.netCost[i] = notional * (slippagePct + marketImpactPct) + fees;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    results.internalLatency = std::chrono::duration_cast<std::chrono::microseconds>(
+        endTime - startTime).count();
+    return true;
+}
+
 void Simulator::registerResultCallback(ResultCallback callback) {
     std::lock_guard<std::mutex> lock(callbackMutex_);
     resultCallback_ = callback;
@@ -193,41 +358,105 @@ void Simulator::startContinuousSimulation(const std::shared_ptr<core::OrderBook>
         core::Logger::getInstance().info("Continuous simulation already running");
         return;
     }
-    
-    // Set flag
-    continuousSimulationRunning_ = true;
-    
-    // Start simulation in a separate thread
-    std::thread([this, orderBook]() {
-        try {
-            core::Logger::getInstance().info("Starting continuous simulation");
-            
-            while (continuousSimulationRunning_) {
-                // Run one simulation
-                simulate(orderBook);
-                
-                // Sleep for update interval
-                int updateIntervalMs = config_ ? config_->getUpdateIntervalMs() : 1000;
-                std::this_thread::sleep_for(std::chrono::milliseconds(updateIntervalMs));
-            }
-            
-            core::Logger::getInstance().info("Continuous simulation stopped");
-        } catch (const std::exception& e) {
-            core::Logger::getInstance().error("Error in continuous simulation thread: {}", e.what());
-            continuousSimulationRunning_ = false;
-        }
-    }).detach(); // Detach to run independently
+
+    // A previous run stopped from inside a result callback is joined here
+    if (simulationThread_.joinable()) {
+        simulationThread_.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        continuousSimulationRunning_ = true;
+        wakeRequests_ = 0;
+        parametersChanged_ = false;
+    }
+    simulationThread_ = std::thread(&Simulator::runContinuousSimulation, this, orderBook);
 }
 
 void Simulator::stopContinuousSimulation() {
-    continuousSimulationRunning_ = false;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if (!continuousSimulationRunning_ && !simulationThread_.joinable()) {
+            return;
+        }
+        continuousSimulationRunning_ = false;
+    }
+    wakeCondition_.notify_all();
     core::Logger::getInstance().info("Stopping continuous simulation");
+
+    if (simulationThread_.joinable() && simulationThread_.get_id() != std::this_thread::get_id()) {
+        simulationThread_.join();
+    }
 }
 
 bool Simulator::isSimulationRunning() const {
     return continuousSimulationRunning_;
 }
 
+void Simulator::notifyBookUpdate() {
+    requestSimulation(false);
+}
+
+uint64_t Simulator::getContinuousRunCount() const {
+    return continuousRuns_.load(std::memory_order_relaxed);
+}
+
+void Simulator::requestSimulation(bool parametersChanged) {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        ++wakeRequests_;
+        parametersChanged_ = parametersChanged_ || parametersChanged;
+    }
+    wakeCondition_.notify_one();
+}
+
+void Simulator::runContinuousSimulation(std::shared_ptr<core::OrderBook> orderBook) {
+    core::Logger::getInstance().info("Starting continuous simulation");
+    const auto minInterval = std::chrono::milliseconds(config_ ? config_->getMinSimulationIntervalMs() : 0);
+
+    uint64_t seenRequests = 0;
+    uint64_t simulatedVersion = 0;
+    bool first = true;
+    auto lastRun = std::chrono::steady_clock::time_point{};
+
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (continuousSimulationRunning_) {
+        // Rate limit: updates arriving while this waits are picked up by the same run
+        if (minInterval.count() > 0) {
+            wakeCondition_.wait_until(lock, lastRun + minInterval, [this] { return !continuousSimulationRunning_; });
+            if (!continuousSimulationRunning_) {
+                break;
+            }
+        }
+        bool parametersChanged = parametersChanged_;
+        parametersChanged_ = false;
+        seenRequests = wakeRequests_;
+        lock.unlock();
+
+        // An unchanged book gives the same result; only new versions are simulated
+        uint64_t version = orderBook->getVersion();
+        if (first || version != simulatedVersion || parametersChanged) {
+            first = false;
+            simulatedVersion = version;
+            lastRun = std::chrono::steady_clock::now();
+            try {
+                simulate(orderBook);
+            } catch (const std::exception& e) {
+                core::Logger::getInstance().error("Error in continuous simulation thread: {}", e.what());
+            }
+            continuousRuns_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        lock.lock();
+        wakeCondition_.wait(lock, [&] {
+            return !continuousSimulationRunning_ || wakeRequests_ != seenRequests || parametersChanged_;
+        });
+    }
+    lock.unlock();
+
+    core::Logger::getInstance().info("Continuous simulation stopped");
+}
+
 std::string Simulator::getExchange() const {
     return exchange_;
 }
@@ -32,6 +32,11 @@ void SlippageModel::setDataPoints(const std::vector<double>& quantities, const s
     slippageData_ = slippages;
 }
 
+void SlippageModel::setDataPoints(const double* quantities, const double* slippages, size_t count) {
+    quantityData_.assign(quantities, quantities + count);
+    slippageData_.assign(slippages, slippages + count);
+}
+
 bool SlippageModel::train() {
     if (quantityData_.empty() || slippageData_.empty()) {
         core::Logger::getInstance().warn("Cannot train slippage model with empty data");
@@ -83,6 +88,47 @@ double SlippageModel::calculateSlippage(const std::shared_ptr<core::OrderBook>&
     return predictOrderBookSlippage(orderBook, quantity, isBuy);
 }
 
+double SlippageModel::calculateSlippage(const MarketSnapshot& market,
+                                     double quantity,
+                                     bool isBuy) const {
+    double referencePrice = isBuy ? market.bestAsk : market.bestBid;
+    if (quantity <= 0.0 || referencePrice <= 0.0) {
+        return 0.0;
+    }
+
+    // Positive slippage means paying more than the reference for buys and
+    // receiving less for sells
+    double avgPrice = market.averageFillPrice(quantity, isBuy);
+    double slippage = isBuy ? (avgPrice - referencePrice) : (referencePrice - avgPrice);
+    return slippage / referencePrice;
+}
+
+void SlippageModel::calculateSlippageCurve(const MarketSnapshot& market,
+                                          const double* quantities,
+                                          size_t count,
+                                          bool isBuy,
+                                          double* slippage) const {
+    double referencePrice = isBuy ? market.bestAsk : market.bestBid;
+    if (referencePrice <= 0.0) {
+        std::fill(slippage, slippage + count, 0.0);
+        return;
+    }
+
+    // Average fill prices first, turned into slippage in place
+    if (std::is_sorted(quantities, quantities + count)) {
+        market.averageFillPrices(quantities, count, isBuy, slippage);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            slippage[i] = market.averageFillPrice(quantities[i], isBuy);
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        double avgPrice = slippage[i];
+        double difference = isBuy ? (avgPrice - referencePrice) : (referencePrice - avgPrice);
+        slippage[i] = quantities[i] > 0.0 ? difference / referencePrice : 0.0;
+    }
+}
+
 std::map<double, double> SlippageModel::calculateSlippageProfile(const std::shared_ptr<core::OrderBook>& orderBook,
                                                               double maxQuantity,
                                                               bool isBuy,
@@ -93,11 +139,25 @@ std::map<double, double> SlippageModel::calculateSlippageProfile(const std::shar
         return profile;
     }
     
-    // Calculate slippage for each step
+    std::vector<double> quantities(steps);
+    std::vector<double> slippages(steps);
     for (int i = 1; i <= steps; ++i) {
-        double quantity = maxQuantity * i / steps;
-        double slippage = predictSlippage(orderBook, quantity, isBuy);
-        profile[quantity] = slippage;
+        quantities[i - 1] = maxQuantity * i / steps;
+    }
+    
+    if (modelType_ == ModelType::ORDERBOOK_BASED) {
+        // One capture and one walk of the book for the whole profile
+        MarketSnapshot market;
+        market.capture(*orderBook);
+        calculateSlippageCurve(market, quantities.data(), quantities.size(), isBuy, slippages.data());
+    } else {
+        for (int i = 0; i < steps; ++i) {
+            slippages[i] = predictSlippage(orderBook, quantities[i], isBuy);
+        }
+    }
+    
+    for (int i = 0; i < steps; ++i) {
+        profile.emplace_hint(profile.end(), quantities[i], slippages[i]);
     }
     
     return profile;
@@ -163,54 +223,10 @@ double SlippageModel::predictOrderBookSlippage(const std::shared_ptr<core::Order
         return 0.0;
     }
     
-    // Get reference price
-    double referencePrice = isBuy ? orderBook->getBestAsk() : orderBook->getBestBid();
-    if (referencePrice <= 0.0) {
-        return 0.0;
-    }
-    
-    // Simulate market order execution
-    double totalCost = 0.0;
-    double remainingQuantity = quantity;
-    
-    // Get the price levels
-    core::PriceLevels levels = isBuy ? orderBook->getAsks() : orderBook->getBids();
-    
-    // For sell orders, we want to start from highest price
-    if (!isBuy) {
-        std::reverse(levels.begin(), levels.end());
-    }
-    
-    // Iterate through price levels
-    for (const auto& level : levels) {
-        double levelPrice = level.price;
-        double levelQuantity = level.quantity;
-        
-        double takenQuantity = std::min(remainingQuantity, levelQuantity);
-        totalCost += levelPrice * takenQuantity;
-        remainingQuantity -= takenQuantity;
-        
-        if (remainingQuantity <= 0.0) {
-            break;
-        }
-    }
-    
-    // If there's not enough liquidity, use the last price level
-    if (remainingQuantity > 0.0 && !levels.empty()) {
-        double lastPrice = levels.back().price;
-        totalCost += lastPrice * remainingQuantity;
-    }
-    
-    // Calculate average execution price
-    double avgPrice = totalCost / quantity;
-    
-    // Calculate slippage as the difference between average execution price and reference price
-    // For buys: positive slippage means paying more than reference
-    // For sells: positive slippage means receiving less than reference
-    double slippage = isBuy ? (avgPrice - referencePrice) : (referencePrice - avgPrice);
-    
-    // Convert to percentage of reference price
-    return slippage / referencePrice;
+    // Reference price and levels from one version of the book
+    MarketSnapshot market;
+    market.capture(*orderBook);
+    return calculateSlippage(market, quantity, isBuy);
 }
 
 } // namespace models 
\ No newline at end of file
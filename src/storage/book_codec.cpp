@@ -0,0 +1,398 @@
+#include "storage/book_codec.h"
+#include "storage/stream_vbyte.h"
+#include "storage/varint.h"
+#include "core/utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace storage {
+
+namespace {
+
+constexpr int64_t kPowers[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+    1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+    100000000000000LL, 1000000000000000LL};
+
+constexpr double kDoublePowers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+// Largest tick or lot count: still exact as a double
+constexpr int64_t kMaxUnits = int64_t{1} << 53;
+
+// Sanity bound on stream indexes read from a file
+constexpr uint64_t kMaxStreams = 1 << 20;
+
+bool rescale(int64_t value, int from, int to, int64_t& out) {
+    return !__builtin_mul_overflow(value, kPowers[to - from], &out) && out < kMaxUnits && out > -kMaxUnits;
+}
+
+// Exact mantissas of every price and size; decimals holds two per level
+bool parseLevels(const BookEncoder::StringLevels& levels, std::vector<int64_t>& ticks,
+                 std::vector<int64_t>& lots, std::vector<int>& decimals,
+                 int& priceDecimals, int& sizeDecimals) {
+    ticks.resize(levels.size());
+    lots.resize(levels.size());
+    decimals.resize(levels.size() * 2);
+
+    for (size_t i = 0; i < levels.size(); ++i) {
+        int& price = decimals[2 * i];
+        int& size = decimals[2 * i + 1];
+        if (!core::utils::parseDecimal(levels[i].first, ticks[i], price) ||
+            !core::utils::parseDecimal(levels[i].second, lots[i], size) ||
+            price > kMaxDecimals || size > kMaxDecimals || lots[i] < 0) {
+            return false;
+        }
+        priceDecimals = std::max(priceDecimals, price);
+        sizeDecimals = std::max(sizeDecimals, size);
+    }
+    return true;
+}
+
+bool scaleLevels(std::vector<int64_t>& ticks, std::vector<int64_t>& lots, const std::vector<int>& decimals,
+                 int priceDecimals, int sizeDecimals) {
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        if (!rescale(ticks[i], decimals[2 * i], priceDecimals, ticks[i]) ||
+            !rescale(lots[i], decimals[2 * i + 1], sizeDecimals, lots[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Decimals needed by a book side given as doubles
+bool levelDecimals(const core::PriceLevels& levels, int& priceDecimals, int& sizeDecimals) {
+    for (const auto& level : levels) {
+        int price = exactDecimals(level.price);
+        int size = exactDecimals(level.quantity);
+        if (price < 0 || size < 0) {
+            return false;
+        }
+        priceDecimals = std::max(priceDecimals, price);
+        sizeDecimals = std::max(sizeDecimals, size);
+    }
+    return true;
+}
+
+bool toUnits(const core::PriceLevels& levels, int priceDecimals, int sizeDecimals,
+             std::vector<int64_t>& ticks, std::vector<int64_t>& lots) {
+    ticks.resize(levels.size());
+    lots.resize(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        double price = std::round(levels[i].price * kDoublePowers[priceDecimals]);
+        double size = std::round(levels[i].quantity * kDoublePowers[sizeDecimals]);
+        if (std::abs(price) >= kMaxUnits || size < 0 || size >= kMaxUnits) {
+            return false;
+        }
+        ticks[i] = static_cast<int64_t>(price);
+        lots[i] = static_cast<int64_t>(size);
+    }
+    return true;
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& value) {
+    putVarint(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+const uint8_t* getString(const uint8_t* in, const uint8_t* end, std::string& value) {
+    uint64_t length;
+    if (!(in = getVarint(in, end, length)) || length > static_cast<uint64_t>(end - in)) {
+        return nullptr;
+    }
+    value.assign(reinterpret_cast<const char*>(in), length);
+    return in + length;
+}
+
+void appendSide(const std::vector<int64_t>& ticks, const std::vector<int64_t>& lots, int64_t touch,
+                std::vector<uint64_t>& values) {
+    int64_t previous = touch;
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        values.push_back(zigzagEncode(ticks[i] - previous));
+        values.push_back(static_cast<uint64_t>(lots[i]));
+        previous = ticks[i];
+    }
+}
+
+void readSide(const uint64_t* values, size_t count, int64_t& touch, double priceScale, double sizeScale,
+              core::PriceLevels& levels) {
+    levels.resize(count);
+    int64_t ticks = touch;
+    for (size_t i = 0; i < count; ++i) {
+        ticks += zigzagDecode(values[2 * i]);
+        levels[i].price = static_cast<double>(ticks) / priceScale;
+        levels[i].quantity = static_cast<double>(values[2 * i + 1]) / sizeScale;
+        if (i == 0) {
+            touch = ticks;
+        }
+    }
+}
+
+} // namespace
+
+int exactDecimals(double value) {
+    for (int decimals = 0; decimals <= kMaxDecimals; ++decimals) {
+        double units = std::round(value * kDoublePowers[decimals]);
+        if (std::abs(units) >= kMaxUnits) {
+            return -1;
+        }
+        if (units / kDoublePowers[decimals] == value) {
+            return decimals;
+        }
+    }
+    return -1;
+}
+
+bool applyFrame(const BookFrame& frame, const BookStreamInfo& info, core::OrderBook& orderBook) {
+    std::chrono::system_clock::time_point timestamp{std::chrono::milliseconds(frame.exchangeMs)};
+    if (frame.isSnapshot()) {
+        orderBook.update(info.exchange, info.symbol, frame.bids, frame.asks, timestamp, frame.seqId);
+        return true;
+    }
+    return orderBook.applyDelta(frame.bids, frame.asks, timestamp, frame.prevSeqId, frame.seqId);
+}
+
+// BookEncoder
+
+bool BookEncoder::encode(const BookStreamInfo& info, bool snapshot, int64_t receivedNs, int64_t exchangeMs,
+                         int64_t seqId, int64_t prevSeqId, const StringLevels& bids, const StringLevels& asks,
+                         std::vector<uint8_t>& out) {
+    uint32_t index;
+    Stream& stream = lookupStream(info, index);
+
+    // Scales only grow, so an already keyed stream keeps its references exact
+    int priceDecimals = stream.keyed ? stream.priceDecimals : 0;
+    int sizeDecimals = stream.keyed ? stream.sizeDecimals : 0;
+    if (!parseLevels(bids, bidTicks_, bidLots_, bidDecimals_, priceDecimals, sizeDecimals) ||
+        !parseLevels(asks, askTicks_, askLots_, askDecimals_, priceDecimals, sizeDecimals) ||
+        !scaleLevels(bidTicks_, bidLots_, bidDecimals_, priceDecimals, sizeDecimals) ||
+        !scaleLevels(askTicks_, askLots_, askDecimals_, priceDecimals, sizeDecimals)) {
+        return false;
+    }
+    if (stream.keyed && priceDecimals > stream.priceDecimals &&
+        (!rescale(stream.bidTicks, stream.priceDecimals, priceDecimals, stream.bidTicks) ||
+         !rescale(stream.askTicks, stream.priceDecimals, priceDecimals, stream.askTicks))) {
+        stream.keyed = false; // start over from a keyframe
+    }
+
+    uint8_t flags = snapshot ? SNAPSHOT : 0;
+    if (!stream.keyed) {
+        flags |= KEYFRAME;
+    }
+    writeFrame(info, index, stream, flags, priceDecimals, sizeDecimals, receivedNs, exchangeMs,
+               seqId, prevSeqId, out);
+    return true;
+}
+
+bool BookEncoder::encodeKeyframe(const BookStreamInfo& info, int64_t receivedNs, int64_t exchangeMs,
+                                 int64_t seqId, const core::PriceLevels& bids, const core::PriceLevels& asks,
+                                 std::vector<uint8_t>& out) {
+    uint32_t index;
+    Stream& stream = lookupStream(info, index);
+
+    // Keep the stream's scale so following deltas need no rescaling
+    int priceDecimals = stream.priceDecimals;
+    int sizeDecimals = stream.sizeDecimals;
+    if (!levelDecimals(bids, priceDecimals, sizeDecimals) || !levelDecimals(asks, priceDecimals, sizeDecimals) ||
+        !toUnits(bids, priceDecimals, sizeDecimals, bidTicks_, bidLots_) ||
+        !toUnits(asks, priceDecimals, sizeDecimals, askTicks_, askLots_)) {
+        return false;
+    }
+
+    writeFrame(info, index, stream, SNAPSHOT | KEYFRAME, priceDecimals, sizeDecimals, receivedNs, exchangeMs,
+               seqId, -1, out);
+    return true;
+}
+
+void BookEncoder::reset() {
+    for (auto& stream : streams_) {
+        stream.keyed = false;
+    }
+}
+
+size_t BookEncoder::getStreamCount() const {
+    return streams_.size();
+}
+
+BookEncoder::Stream& BookEncoder::lookupStream(const BookStreamInfo& info, uint32_t& index) {
+    auto [it, inserted] = routes_.emplace(info.route, static_cast<uint32_t>(streams_.size()));
+    if (inserted) {
+        streams_.emplace_back();
+        streams_.back().route = info.route;
+    }
+    index = it->second;
+    return streams_[index];
+}
+
+void BookEncoder::writeFrame(const BookStreamInfo& info, uint32_t index, Stream& stream, uint8_t flags,
+                             int priceDecimals, int sizeDecimals, int64_t receivedNs, int64_t exchangeMs,
+                             int64_t seqId, int64_t prevSeqId, std::vector<uint8_t>& out) {
+    if (flags & KEYFRAME) {
+        uint64_t route = stream.route;
+        stream = Stream{};
+        stream.route = route;
+        stream.keyed = true;
+        flags |= SCALES;
+    } else if (priceDecimals != stream.priceDecimals || sizeDecimals != stream.sizeDecimals) {
+        flags |= SCALES;
+    }
+    stream.priceDecimals = priceDecimals;
+    stream.sizeDecimals = sizeDecimals;
+    if (prevSeqId != stream.seqId) {
+        flags |= EXPLICIT_PREV_SEQ;
+    }
+    if (bidTicks_.size() < 16 && askTicks_.size() < 16) {
+        flags |= SHORT_COUNTS;
+    }
+
+    body_.clear();
+    body_.push_back(flags);
+    putVarint(body_, index);
+    if (flags & KEYFRAME) {
+        putVarint(body_, info.route);
+        putString(body_, info.exchange);
+        putString(body_, info.symbol);
+        putString(body_, info.channel);
+    }
+    if (flags & SCALES) {
+        body_.push_back(static_cast<uint8_t>(priceDecimals << 4 | sizeDecimals));
+    }
+    putVarint(body_, zigzagEncode(receivedNs - stream.receivedNs));
+    putVarint(body_, zigzagEncode(exchangeMs - stream.exchangeMs));
+    putVarint(body_, zigzagEncode(seqId - stream.seqId));
+    if (flags & EXPLICIT_PREV_SEQ) {
+        putVarint(body_, zigzagEncode(prevSeqId - stream.seqId));
+    }
+    if (flags & SHORT_COUNTS) {
+        body_.push_back(static_cast<uint8_t>(bidTicks_.size() << 4 | askTicks_.size()));
+    } else {
+        putVarint(body_, bidTicks_.size());
+        putVarint(body_, askTicks_.size());
+    }
+
+    values_.clear();
+    appendSide(bidTicks_, bidLots_, stream.bidTicks, values_);
+    appendSide(askTicks_, askLots_, stream.askTicks, values_);
+    streamVbyteEncode(values_.data(), values_.size(), body_);
+
+    if (!bidTicks_.empty()) {
+        stream.bidTicks = bidTicks_.front();
+    }
+    if (!askTicks_.empty()) {
+        stream.askTicks = askTicks_.front();
+    }
+    stream.receivedNs = receivedNs;
+    stream.exchangeMs = exchangeMs;
+    stream.seqId = seqId;
+
+    putVarint(out, body_.size());
+    out.insert(out.end(), body_.begin(), body_.end());
+}
+
+// BookDecoder
+
+const uint8_t* BookDecoder::decode(const uint8_t* in, const uint8_t* end, BookFrame& frame) {
+    uint64_t bytes;
+    if (!(in = getVarint(in, end, bytes)) || bytes == 0 || bytes > static_cast<uint64_t>(end - in)) {
+        return nullptr;
+    }
+    const uint8_t* frameEnd = in + bytes;
+
+    frame.flags = *in++;
+    uint64_t index;
+    if (!(in = getVarint(in, frameEnd, index)) || index >= kMaxStreams) {
+        return nullptr;
+    }
+
+    if (frame.flags & KEYFRAME) {
+        if (index >= streams_.size()) {
+            streams_.resize(index + 1);
+        }
+        Stream& stream = streams_[index];
+        stream = Stream{};
+        if (!(in = getVarint(in, frameEnd, stream.info.route)) ||
+            !(in = getString(in, frameEnd, stream.info.exchange)) ||
+            !(in = getString(in, frameEnd, stream.info.symbol)) ||
+            !(in = getString(in, frameEnd, stream.info.channel))) {
+            return nullptr;
+        }
+        stream.keyed = true;
+    } else if (index >= streams_.size() || !streams_[index].keyed) {
+        frame.stream = BookFrame::kUnknownStream;
+        return frameEnd;
+    }
+    Stream& stream = streams_[index];
+
+    if (frame.flags & SCALES) {
+        if (in >= frameEnd) {
+            return nullptr;
+        }
+        int priceDecimals = *in >> 4;
+        int sizeDecimals = *in++ & 0x0F;
+        if (priceDecimals < stream.priceDecimals ||
+            !rescale(stream.bidTicks, stream.priceDecimals, priceDecimals, stream.bidTicks) ||
+            !rescale(stream.askTicks, stream.priceDecimals, priceDecimals, stream.askTicks)) {
+            return nullptr;
+        }
+        stream.priceDecimals = priceDecimals;
+        stream.sizeDecimals = sizeDecimals;
+    }
+
+    uint64_t received, exchange, seq, prevSeq, bidCount, askCount;
+    if (!(in = getVarint(in, frameEnd, received)) || !(in = getVarint(in, frameEnd, exchange)) ||
+        !(in = getVarint(in, frameEnd, seq))) {
+        return nullptr;
+    }
+    frame.prevSeqId = stream.seqId;
+    if ((frame.flags & EXPLICIT_PREV_SEQ) && !(in = getVarint(in, frameEnd, prevSeq))) {
+        return nullptr;
+    }
+    if (frame.flags & EXPLICIT_PREV_SEQ) {
+        frame.prevSeqId = stream.seqId + zigzagDecode(prevSeq);
+    }
+    // Every value takes at least one byte, so the counts are bounded by bytes
+    if (frame.flags & SHORT_COUNTS) {
+        if (in >= frameEnd) {
+            return nullptr;
+        }
+        bidCount = *in >> 4;
+        askCount = *in++ & 0x0F;
+    } else if (!(in = getVarint(in, frameEnd, bidCount)) || !(in = getVarint(in, frameEnd, askCount)) ||
+               bidCount > bytes || askCount > bytes) {
+        return nullptr;
+    }
+
+    size_t values = static_cast<size_t>(2 * (bidCount + askCount));
+    values_.resize(values);
+    if (!streamVbyteDecode(in, frameEnd, values, values_.data())) {
+        return nullptr;
+    }
+
+    stream.receivedNs += zigzagDecode(received);
+    stream.exchangeMs += zigzagDecode(exchange);
+    stream.seqId += zigzagDecode(seq);
+
+    double priceScale = kDoublePowers[stream.priceDecimals];
+    double sizeScale = kDoublePowers[stream.sizeDecimals];
+    readSide(values_.data(), bidCount, stream.bidTicks, priceScale, sizeScale, frame.bids);
+    readSide(values_.data() + 2 * bidCount, askCount, stream.askTicks, priceScale, sizeScale, frame.asks);
+
+    frame.stream = static_cast<uint32_t>(index);
+    frame.receivedNs = stream.receivedNs;
+    frame.exchangeMs = stream.exchangeMs;
+    frame.seqId = stream.seqId;
+    return frameEnd;
+}
+
+const BookStreamInfo* BookDecoder::getStream(uint32_t stream) const {
+    return stream < streams_.size() && streams_[stream].keyed ? &streams_[stream].info : nullptr;
+}
+
+void BookDecoder::reset() {
+    for (auto& stream : streams_) {
+        stream.keyed = false;
+    }
+}
+
+} // namespace storage
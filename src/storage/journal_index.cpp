@@ -0,0 +1,179 @@
+#include "storage/journal_index.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <tuple>
+
+namespace storage {
+
+std::string JournalIndex::pathFor(const std::string& segmentPath) {
+    return segmentPath + kIndexExtension;
+}
+
+bool JournalIndex::load(const std::string& segmentPath, const SegmentHeader& segment, uint64_t dataBytes) {
+    points_.clear();
+    sequences_.clear();
+    keyframes_.clear();
+
+    std::ifstream file(pathFor(segmentPath), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    const uint64_t fileBytes = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    IndexHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, kIndexMagic, sizeof(header.magic)) != 0 ||
+        header.version != kIndexVersion || header.headerBytes != sizeof(IndexHeader)) {
+        core::Logger::getInstance().warn("Ignoring damaged index for {}", segmentPath);
+        return false;
+    }
+    if (header.segmentCreatedNs != segment.createdNs || header.segmentDataBytes != dataBytes) {
+        return false; // stale: the segment was rewritten or was still open when indexed
+    }
+
+    // The counts must account for exactly the rest of the file before anything is allocated
+    uint64_t remaining = fileBytes - sizeof(IndexHeader);
+    if (header.pointCount > remaining / sizeof(IndexPoint) ||
+        header.sequenceCount > (remaining - header.pointCount * sizeof(IndexPoint)) / sizeof(SequencePoint) ||
+        header.keyframeBytes != remaining - header.pointCount * sizeof(IndexPoint) -
+                                    header.sequenceCount * sizeof(SequencePoint)) {
+        core::Logger::getInstance().warn("Ignoring truncated index for {}", segmentPath);
+        return false;
+    }
+
+    points_.resize(header.pointCount);
+    sequences_.resize(header.sequenceCount);
+    keyframes_.resize(header.keyframeBytes);
+    file.read(reinterpret_cast<char*>(points_.data()), points_.size() * sizeof(IndexPoint));
+    file.read(reinterpret_cast<char*>(sequences_.data()), sequences_.size() * sizeof(SequencePoint));
+    file.read(reinterpret_cast<char*>(keyframes_.data()), keyframes_.size());
+    if (!file || !isConsistent(segment.headerBytes + dataBytes)) {
+        core::Logger::getInstance().warn("Ignoring {} index for {}", file ? "damaged" : "truncated", segmentPath);
+        points_.clear();
+        sequences_.clear();
+        keyframes_.clear();
+        return false;
+    }
+
+    header_ = header;
+    return true;
+}
+
+bool JournalIndex::isConsistent(uint64_t segmentBytes) const {
+    // getKeyframes and the readers seeking to a point trust these ranges
+    for (const auto& point : points_) {
+        if (point.offset > segmentBytes || point.keyframeOffset > keyframes_.size() ||
+            point.keyframeBytes > keyframes_.size() - point.keyframeOffset) {
+            return false;
+        }
+    }
+    for (const auto& sequence : sequences_) {
+        if (sequence.point >= points_.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JournalIndex::save(const std::string& segmentPath) const {
+    // Written aside and renamed, so a reader never sees half an index
+    std::string path = pathFor(segmentPath);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            core::Logger::getInstance().error("Cannot create index {}", temporary);
+            return false;
+        }
+
+        IndexHeader header = header_;
+        header.pointCount = points_.size();
+        header.sequenceCount = sequences_.size();
+        header.keyframeBytes = keyframes_.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(points_.data()), points_.size() * sizeof(IndexPoint));
+        file.write(reinterpret_cast<const char*>(sequences_.data()), sequences_.size() * sizeof(SequencePoint));
+        file.write(reinterpret_cast<const char*>(keyframes_.data()), keyframes_.size());
+        if (!file) {
+            core::Logger::getInstance().error("Write to index {} failed", temporary);
+            return false;
+        }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+void JournalIndex::reset(const SegmentHeader& segment, uint64_t dataBytes, int64_t intervalNs) {
+    header_ = IndexHeader{};
+    std::memcpy(header_.magic, kIndexMagic, sizeof(header_.magic));
+    header_.version = kIndexVersion;
+    header_.headerBytes = sizeof(IndexHeader);
+    header_.segmentCreatedNs = segment.createdNs;
+    header_.segmentDataBytes = dataBytes;
+    header_.intervalNs = intervalNs;
+    points_.clear();
+    sequences_.clear();
+    keyframes_.clear();
+}
+
+void JournalIndex::addPoint(int64_t receivedNs, uint64_t offset, uint64_t record,
+                            const uint8_t* keyframes, size_t keyframeBytes) {
+    points_.push_back({receivedNs, offset, record, keyframes_.size(), keyframeBytes});
+    keyframes_.insert(keyframes_.end(), keyframes, keyframes + keyframeBytes);
+}
+
+void JournalIndex::addSequence(uint64_t route, int64_t seqId) {
+    if (!points_.empty()) {
+        sequences_.push_back({route, seqId, points_.size() - 1});
+    }
+}
+
+void JournalIndex::finish() {
+    std::sort(sequences_.begin(), sequences_.end(), [](const SequencePoint& a, const SequencePoint& b) {
+        return std::tie(a.route, a.seqId, a.point) < std::tie(b.route, b.seqId, b.point);
+    });
+}
+
+const IndexPoint* JournalIndex::findTime(int64_t receivedNs) const {
+    if (points_.empty()) {
+        return nullptr;
+    }
+    auto it = std::upper_bound(points_.begin(), points_.end(), receivedNs,
+        [](int64_t value, const IndexPoint& point) { return value < point.receivedNs; });
+    return it == points_.begin() ? &points_.front() : &*(it - 1);
+}
+
+const IndexPoint* JournalIndex::findSequence(uint64_t route, int64_t seqId) const {
+    auto it = std::upper_bound(sequences_.begin(), sequences_.end(), std::make_pair(route, seqId),
+        [](const std::pair<uint64_t, int64_t>& value, const SequencePoint& point) {
+            return value.first < point.route || (value.first == point.route && value.second < point.seqId);
+        });
+    if (it == sequences_.begin() || (it - 1)->route != route) {
+        return nullptr;
+    }
+    return &points_[(it - 1)->point];
+}
+
+const uint8_t* JournalIndex::getKeyframes(const IndexPoint& point) const {
+    return keyframes_.data() + point.keyframeOffset;
+}
+
+const std::vector<IndexPoint>& JournalIndex::getPoints() const {
+    return points_;
+}
+
+size_t JournalIndex::getSequenceCount() const {
+    return sequences_.size();
+}
+
+size_t JournalIndex::getKeyframeBytes() const {
+    return keyframes_.size();
+}
+
+int64_t JournalIndex::getIntervalNs() const {
+    return header_.intervalNs;
+}
+
+} // namespace storage
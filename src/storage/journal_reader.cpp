@@ -0,0 +1,140 @@
+#include "storage/journal_reader.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace storage {
+
+JournalReader::~JournalReader() {
+    close();
+}
+
+bool JournalReader::open(const std::string& path) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        core::Logger::getInstance().error("Cannot open journal {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    struct stat info{};
+    if (fstat(fd_, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SegmentHeader)) {
+        core::Logger::getInstance().error("Journal {} is truncated", path);
+        close();
+        return false;
+    }
+
+    mappedBytes_ = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, mappedBytes_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        core::Logger::getInstance().error("Cannot map journal {}: {}", path, std::strerror(errno));
+        mappedBytes_ = 0;
+        close();
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(mapping);
+    madvise(const_cast<uint8_t*>(base_), mappedBytes_, MADV_SEQUENTIAL);
+
+    std::memcpy(&header_, base_, sizeof(header_));
+    if (std::memcmp(header_.magic, kJournalMagic, sizeof(header_.magic)) != 0 ||
+        header_.version != kJournalVersion || header_.headerBytes < sizeof(SegmentHeader)) {
+        core::Logger::getInstance().error("{} is not a capture journal", path);
+        close();
+        return false;
+    }
+
+    // A segment that was never closed has no data size; scan to the first empty record
+    end_ = mappedBytes_;
+    if (header_.dataBytes > 0 && header_.headerBytes + header_.dataBytes <= mappedBytes_) {
+        end_ = header_.headerBytes + header_.dataBytes;
+    }
+    offset_ = header_.headerBytes;
+    return true;
+}
+
+void JournalReader::close() {
+    if (base_) {
+        munmap(const_cast<uint8_t*>(base_), mappedBytes_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    mappedBytes_ = 0;
+    end_ = 0;
+    offset_ = 0;
+}
+
+bool JournalReader::isOpen() const {
+    return base_ != nullptr;
+}
+
+bool JournalReader::next(JournalRecord& record) {
+    if (!base_ || offset_ + sizeof(RecordHeader) > end_) {
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const RecordHeader*>(base_ + offset_);
+    uint32_t length = header->length;
+    if (length == 0 || offset_ + recordSize(length) > end_) {
+        return false;
+    }
+
+    record.type = static_cast<RecordType>(header->type);
+    record.line = header->line;
+    record.session = header->session;
+    record.receivedNs = header->receivedNs;
+    record.payload = std::string_view(reinterpret_cast<const char*>(base_ + offset_ + sizeof(RecordHeader)), length);
+    offset_ += recordSize(length);
+    return true;
+}
+
+void JournalReader::rewind() {
+    offset_ = header_.headerBytes;
+}
+
+bool JournalReader::seek(size_t offset) {
+    if (!base_ || offset < header_.headerBytes || offset > end_ || offset % kRecordAlignment != 0) {
+        return false;
+    }
+    offset_ = offset;
+    return true;
+}
+
+const SegmentHeader& JournalReader::getHeader() const {
+    return header_;
+}
+
+size_t JournalReader::getOffset() const {
+    return offset_;
+}
+
+size_t JournalReader::getDataBytes() const {
+    return end_ > header_.headerBytes ? end_ - header_.headerBytes : 0;
+}
+
+std::vector<std::string> JournalReader::listSegments(const std::string& directory, const std::string& prefix) {
+    std::vector<std::string> segments;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.rfind(prefix + "-", 0) == 0 &&
+            entry.path().extension() == kJournalExtension) {
+            segments.push_back(entry.path().string());
+        }
+    }
+
+    // Names carry the run's start time and the segment index, both fixed width
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+} // namespace storage
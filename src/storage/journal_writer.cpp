@@ -0,0 +1,187 @@
+#include "storage/journal_writer.h"
+#include "core/logger.h"
+#include "core/utils.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace storage {
+
+JournalWriter::JournalWriter(std::string directory, std::string prefix, size_t segmentBytes)
+    : directory_(std::move(directory)),
+      prefix_(std::move(prefix)),
+      segmentBytes_(segmentBytes > sizeof(SegmentHeader) * 2 ? segmentBytes : kDefaultSegmentBytes) {
+}
+
+JournalWriter::~JournalWriter() {
+    close();
+}
+
+void JournalWriter::setWallClockStamps(bool enabled) {
+    wallClockStamps_ = enabled;
+}
+
+bool JournalWriter::open() {
+    if (isOpen()) {
+        return true;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        core::Logger::getInstance().error("Cannot create capture directory {}: {}", directory_, ec.message());
+        return false;
+    }
+
+    // One stamp per run keeps its segments together and in order
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%S", &utc);
+    runStamp_ = stamp;
+    segmentIndex_ = 0;
+
+    return openSegment();
+}
+
+void JournalWriter::close() {
+    closeSegment();
+}
+
+bool JournalWriter::isOpen() const {
+    return base_ != nullptr;
+}
+
+bool JournalWriter::append(RecordType type, std::string_view payload, int64_t receivedNs,
+                           uint32_t session, uint16_t line) {
+    size_t size = recordSize(payload.size());
+    if (sizeof(SegmentHeader) + size > segmentBytes_) {
+        core::Logger::getInstance().warn("Dropping {} byte record larger than a journal segment", payload.size());
+        return false;
+    }
+    if (!base_) {
+        return false;
+    }
+
+    if (offset_ + size > segmentBytes_) {
+        closeSegment();
+        ++segmentIndex_;
+        if (!openSegment()) {
+            return false;
+        }
+    }
+
+    uint8_t* slot = base_ + offset_;
+    auto* header = reinterpret_cast<RecordHeader*>(slot);
+    std::memcpy(slot + sizeof(RecordHeader), payload.data(), payload.size());
+    header->type = static_cast<uint16_t>(type);
+    header->line = line;
+    header->session = session;
+    header->reserved = 0;
+    header->receivedNs = receivedNs;
+    // Length last: a record is only visible to readers once it is complete
+    __atomic_store_n(&header->length, static_cast<uint32_t>(payload.size()), __ATOMIC_RELEASE);
+
+    offset_ += size;
+    ++segmentRecords_;
+    ++records_;
+    bytes_ += size;
+    return true;
+}
+
+uint64_t JournalWriter::getRecordCount() const {
+    return records_;
+}
+
+uint64_t JournalWriter::getBytesWritten() const {
+    return bytes_;
+}
+
+uint64_t JournalWriter::getSegmentCount() const {
+    return segments_;
+}
+
+const std::string& JournalWriter::getCurrentPath() const {
+    return currentPath_;
+}
+
+bool JournalWriter::openSegment() {
+    char name[64];
+    std::snprintf(name, sizeof(name), "-%s-%06llu", runStamp_.c_str(),
+                  static_cast<unsigned long long>(segmentIndex_));
+    currentPath_ = (std::filesystem::path(directory_) / (prefix_ + name + kJournalExtension)).string();
+
+    fd_ = ::open(currentPath_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        core::Logger::getInstance().error("Cannot create journal {}: {}", currentPath_, std::strerror(errno));
+        return false;
+    }
+
+    // Reserve the blocks now so a full disk fails here, not as SIGBUS mid-write
+#ifdef __linux__
+    int rc = posix_fallocate(fd_, 0, static_cast<off_t>(segmentBytes_));
+#else
+    int rc = ftruncate(fd_, static_cast<off_t>(segmentBytes_)) == 0 ? 0 : errno;
+#endif
+    if (rc != 0) {
+        core::Logger::getInstance().error("Cannot allocate journal {}: {}", currentPath_, std::strerror(rc));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE; // fault the pages in now rather than on the append path
+#endif
+    void* mapping = mmap(nullptr, segmentBytes_, PROT_READ | PROT_WRITE, flags, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        core::Logger::getInstance().error("Cannot map journal {}: {}", currentPath_, std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(mapping);
+    madvise(base_, segmentBytes_, MADV_SEQUENTIAL);
+
+    SegmentHeader header{};
+    std::memcpy(header.magic, kJournalMagic, sizeof(header.magic));
+    header.version = kJournalVersion;
+    header.headerBytes = sizeof(SegmentHeader);
+    header.segmentIndex = segmentIndex_;
+    header.createdNs = core::utils::systemClockNanos(std::chrono::system_clock::now());
+    header.steadyToWallNs = wallClockStamps_ ? 0 : header.createdNs - core::utils::steadyClockNanos();
+    std::memcpy(base_, &header, sizeof(header));
+
+    offset_ = sizeof(SegmentHeader);
+    segmentRecords_ = 0;
+    ++segments_;
+    return true;
+}
+
+void JournalWriter::closeSegment() {
+    if (!base_) {
+        return;
+    }
+
+    auto* header = reinterpret_cast<SegmentHeader*>(base_);
+    header->dataBytes = offset_ - sizeof(SegmentHeader);
+    header->recordCount = segmentRecords_;
+
+    // Writeback is left to the kernel; trimming drops the unused reservation
+    munmap(base_, segmentBytes_);
+    base_ = nullptr;
+    if (ftruncate(fd_, static_cast<off_t>(offset_)) != 0) {
+        core::Logger::getInstance().warn("Cannot trim journal {}: {}", currentPath_, std::strerror(errno));
+    }
+    ::close(fd_);
+    fd_ = -1;
+}
+
+} // namespace storage
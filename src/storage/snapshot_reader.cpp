@@ -0,0 +1,355 @@
+#include "storage/snapshot_reader.h"
+#include "storage/stream_vbyte.h"
+#include "storage/varint.h"
+#include "core/logger.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace storage {
+
+SnapshotReader::~SnapshotReader() {
+    close();
+}
+
+bool SnapshotReader::open(const std::string& path) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        core::Logger::getInstance().error("Cannot open snapshot file {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    struct stat info{};
+    if (fstat(fd_, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotFileHeader)) {
+        core::Logger::getInstance().error("Snapshot file {} is truncated", path);
+        close();
+        return false;
+    }
+
+    mappedBytes_ = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, mappedBytes_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        core::Logger::getInstance().error("Cannot map snapshot file {}: {}", path, std::strerror(errno));
+        mappedBytes_ = 0;
+        close();
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(mapping);
+
+    std::memcpy(&header_, base_, sizeof(header_));
+    if (std::memcmp(header_.magic, kSnapshotMagic, sizeof(header_.magic)) != 0 ||
+        header_.version != kSnapshotVersion || header_.depth == 0) {
+        // Never closed: the header is still blank, but the chunks are intact
+        if (header_.version == 0 && header_.headerBytes == 0) {
+            core::Logger::getInstance().warn("Snapshot file {} was not closed; recovering its chunks", path);
+            scanChunks();
+            if (!chunks_.empty()) {
+                return true;
+            }
+        }
+        core::Logger::getInstance().error("{} is not a snapshot file", path);
+        close();
+        return false;
+    }
+
+    if (header_.indexOffset > mappedBytes_ ||
+        header_.chunkCount > (mappedBytes_ - header_.indexOffset) / sizeof(ChunkIndexEntry) ||
+        header_.depth > mappedBytes_ / (kFieldsPerLevel * sizeof(ColumnHeader))) {
+        core::Logger::getInstance().error("Snapshot file {} has a damaged chunk index", path);
+        close();
+        return false;
+    }
+    chunks_.resize(header_.chunkCount);
+    std::memcpy(chunks_.data(), base_ + header_.indexOffset, chunks_.size() * sizeof(ChunkIndexEntry));
+
+    // Checked once here so reads can trust every offset
+    uint64_t rows = 0;
+    for (const auto& chunk : chunks_) {
+        if (!isValidChunk(chunk)) {
+            core::Logger::getInstance().error("Snapshot file {} has a damaged chunk at offset {}", path, chunk.offset);
+            close();
+            return false;
+        }
+        rows += chunk.rows;
+    }
+    if (rows != header_.rowCount) {
+        core::Logger::getInstance().error("Snapshot file {} holds {} rows, its header says {}", path, rows,
+            header_.rowCount);
+        close();
+        return false;
+    }
+
+    rowCount_ = rows;
+    columns_.assign(columnCount(header_.depth), nullptr);
+    columnBuffers_.resize(columns_.size());
+    return true;
+}
+
+void SnapshotReader::close() {
+    if (base_) {
+        munmap(const_cast<uint8_t*>(base_), mappedBytes_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    mappedBytes_ = 0;
+    chunks_.clear();
+    rowCount_ = 0;
+    chunkRows_ = 0;
+    timestamps_ = nullptr;
+    columns_.clear();
+}
+
+bool SnapshotReader::isOpen() const {
+    return base_ != nullptr;
+}
+
+size_t SnapshotReader::getDepth() const {
+    return header_.depth;
+}
+
+uint64_t SnapshotReader::getRowCount() const {
+    return rowCount_;
+}
+
+const std::vector<ChunkIndexEntry>& SnapshotReader::getChunks() const {
+    return chunks_;
+}
+
+bool SnapshotReader::loadChunk(size_t chunk) {
+    if (chunk >= chunks_.size()) {
+        return false;
+    }
+
+    const ChunkIndexEntry& entry = chunks_[chunk];
+    const uint8_t* data = base_ + entry.offset;
+    chunkRows_ = entry.rows;
+
+    const ColumnHeader* header = columnHeader(entry, 0);
+    if (header->codec == static_cast<uint8_t>(ColumnCodec::RAW)) {
+        timestamps_ = reinterpret_cast<const int64_t*>(data + header->offset);
+    } else {
+        timestampBuffer_.resize(chunkRows_);
+        if (!decodeTimestamps(entry, timestampBuffer_.data())) {
+            return false;
+        }
+        timestamps_ = timestampBuffer_.data();
+    }
+
+    for (size_t c = 1; c < columns_.size(); ++c) {
+        header = columnHeader(entry, c);
+        if (header->codec == static_cast<uint8_t>(ColumnCodec::RAW)) {
+            columns_[c] = reinterpret_cast<const double*>(data + header->offset);
+            continue;
+        }
+        // Columns load level by level, so the best prices are already in place
+        auto field = static_cast<BookField>((c - 1) % kFieldsPerLevel);
+        const double* best = c > kFieldsPerLevel ? columns_[columnIndex(field, 0)] : nullptr;
+        columnBuffers_[c].resize(chunkRows_);
+        if (!decodeColumn(entry, c, columnBuffers_[c].data(), scratch_, best)) {
+            return false;
+        }
+        columns_[c] = columnBuffers_[c].data();
+    }
+    return true;
+}
+
+size_t SnapshotReader::getChunkRows() const {
+    return chunkRows_;
+}
+
+const int64_t* SnapshotReader::timestamps() const {
+    return timestamps_;
+}
+
+const double* SnapshotReader::column(BookField field, size_t level) const {
+    size_t index = columnIndex(field, level);
+    return index < columns_.size() ? columns_[index] : nullptr;
+}
+
+bool SnapshotReader::readTimestamps(std::vector<int64_t>& out) const {
+    out.resize(rowCount_);
+    size_t row = 0;
+    for (const auto& chunk : chunks_) {
+        if (!decodeTimestamps(chunk, out.data() + row)) {
+            return false;
+        }
+        row += chunk.rows;
+    }
+    return true;
+}
+
+bool SnapshotReader::readColumn(BookField field, size_t level, std::vector<double>& out) const {
+    size_t index = columnIndex(field, level);
+    if (index >= columns_.size()) {
+        return false;
+    }
+
+    out.resize(rowCount_);
+    DecodeScratch scratch;
+    size_t row = 0;
+    for (const auto& chunk : chunks_) {
+        if (!decodeColumn(chunk, index, out.data() + row, scratch)) {
+            return false;
+        }
+        row += chunk.rows;
+    }
+    return true;
+}
+
+const ColumnHeader* SnapshotReader::columnHeader(const ChunkIndexEntry& chunk, size_t column) const {
+    return reinterpret_cast<const ColumnHeader*>(base_ + chunk.offset + sizeof(ChunkHeader)) + column;
+}
+
+bool SnapshotReader::decodeTimestamps(const ChunkIndexEntry& chunk, int64_t* out) const {
+    const ColumnHeader* header = columnHeader(chunk, 0);
+    const uint8_t* in = base_ + chunk.offset + header->offset;
+    const uint8_t* end = in + header->bytes;
+
+    if (header->codec == static_cast<uint8_t>(ColumnCodec::RAW)) {
+        std::memcpy(out, in, chunk.rows * sizeof(int64_t));
+        return true;
+    }
+
+    int64_t previous = 0;
+    for (size_t row = 0; row < chunk.rows; ++row) {
+        uint64_t delta;
+        if (!(in = getVarint(in, end, delta))) {
+            return false;
+        }
+        previous += zigzagDecode(delta);
+        out[row] = previous;
+    }
+    return true;
+}
+
+bool SnapshotReader::decodeColumn(const ChunkIndexEntry& chunk, size_t column, double* out, DecodeScratch& scratch,
+                                  const double* best) const {
+    const ColumnHeader* header = columnHeader(chunk, column);
+    const uint8_t* in = base_ + chunk.offset + header->offset;
+    const uint8_t* end = in + header->bytes;
+
+    if (header->codec == static_cast<uint8_t>(ColumnCodec::RAW)) {
+        std::memcpy(out, in, chunk.rows * sizeof(double));
+        return true;
+    }
+    if (header->codec == static_cast<uint8_t>(ColumnCodec::TICK_VARINT)) {
+        return decodeTicks(chunk, column, header->decimals, in, end, out, scratch, best);
+    }
+
+    uint64_t previous = 0;
+    for (size_t row = 0; row < chunk.rows; ++row) {
+        uint64_t bits;
+        if (!(in = getVarint(in, end, bits))) {
+            return false;
+        }
+        previous ^= bits;
+        out[row] = bitsToDouble(previous);
+    }
+    return true;
+}
+
+bool SnapshotReader::decodeTicks(const ChunkIndexEntry& chunk, size_t column, int decimals, const uint8_t* in,
+                                 const uint8_t* end, double* out, DecodeScratch& scratch, const double* best) const {
+    auto field = static_cast<BookField>((column - 1) % kFieldsPerLevel);
+    size_t level = (column - 1) / kFieldsPerLevel;
+    bool relative = (field == BookField::BID_PRICE || field == BookField::ASK_PRICE) && level > 0;
+
+    // Before the units below: decoding the best prices reuses the scratch
+    if (relative && !best) {
+        scratch.best.resize(chunk.rows);
+        if (!decodeColumn(chunk, columnIndex(field, 0), scratch.best.data(), scratch)) {
+            return false;
+        }
+        best = scratch.best.data();
+    }
+
+    std::vector<uint64_t>& units = scratch.units;
+    units.resize(chunk.rows);
+    if (!streamVbyteDecode(in, end, chunk.rows, units.data())) {
+        return false;
+    }
+
+    const double scale = std::pow(10.0, decimals);
+    if (relative) {
+        // Relative to the best price of the same row
+        for (size_t row = 0; row < chunk.rows; ++row) {
+            int64_t bestTicks = std::llround(best[row] * scale);
+            out[row] = units[row] == 0 ? 0.0 : static_cast<double>(bestTicks + zigzagDecode(units[row] - 1)) / scale;
+        }
+        return true;
+    }
+
+    int64_t previous = 0;
+    for (size_t row = 0; row < chunk.rows; ++row) {
+        previous += zigzagDecode(units[row]);
+        out[row] = static_cast<double>(previous) / scale;
+    }
+    return true;
+}
+
+bool SnapshotReader::isValidChunk(const ChunkIndexEntry& entry) const {
+    if (entry.offset > mappedBytes_ || mappedBytes_ - entry.offset < sizeof(ChunkHeader)) {
+        return false;
+    }
+    ChunkHeader chunk;
+    std::memcpy(&chunk, base_ + entry.offset, sizeof(chunk));
+
+    const size_t columns = columnCount(header_.depth);
+    const size_t headerBytes = sizeof(ChunkHeader) + columns * sizeof(ColumnHeader);
+    if (chunk.rows != entry.rows || chunk.rows == 0 || chunk.columns != columns || chunk.bytes < headerBytes ||
+        chunk.bytes > mappedBytes_ - entry.offset) {
+        return false;
+    }
+
+    const size_t rawBytes = static_cast<size_t>(chunk.rows) * 8;
+    for (size_t c = 0; c < columns; ++c) {
+        ColumnHeader column;
+        std::memcpy(&column, base_ + entry.offset + sizeof(ChunkHeader) + c * sizeof(ColumnHeader), sizeof(column));
+        if (column.offset < headerBytes || column.offset > chunk.bytes || column.bytes > chunk.bytes - column.offset) {
+            return false;
+        }
+
+        auto codec = static_cast<ColumnCodec>(column.codec);
+        bool known = c == 0 ? codec == ColumnCodec::RAW || codec == ColumnCodec::DELTA_VARINT
+                            : codec == ColumnCodec::RAW || codec == ColumnCodec::XOR_VARINT ||
+                                  (codec == ColumnCodec::TICK_VARINT && column.decimals <= 18);
+        // RAW columns are used in place as int64/double arrays
+        if (!known || (codec == ColumnCodec::RAW && (column.bytes < rawBytes || (entry.offset + column.offset) % 8 != 0))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SnapshotReader::scanChunks() {
+    // Walk the chunk headers; a partly written last chunk is ignored
+    size_t offset = sizeof(SnapshotFileHeader);
+    rowCount_ = 0;
+    while (offset + sizeof(ChunkHeader) <= mappedBytes_) {
+        ChunkHeader chunk;
+        std::memcpy(&chunk, base_ + offset, sizeof(chunk));
+        if (header_.depth == 0 && chunk.columns > 0) {
+            header_.depth = static_cast<uint32_t>((chunk.columns - 1) / kFieldsPerLevel);
+        }
+        ChunkIndexEntry entry{offset, chunk.rows, 0, chunk.firstTimestamp, chunk.lastTimestamp};
+        if (!isValidChunk(entry)) {
+            break;
+        }
+        chunks_.push_back(entry);
+        rowCount_ += chunk.rows;
+        offset += chunk.bytes;
+    }
+    columns_.assign(columnCount(header_.depth), nullptr);
+    columnBuffers_.resize(columns_.size());
+}
+
+} // namespace storage
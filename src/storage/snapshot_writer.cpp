@@ -0,0 +1,271 @@
+#include "storage/snapshot_writer.h"
+#include "storage/book_codec.h"
+#include "storage/stream_vbyte.h"
+#include "storage/varint.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace storage {
+
+SnapshotWriter::SnapshotWriter(std::string path, size_t depth, bool compress, uint32_t rowsPerChunk)
+    : path_(std::move(path)),
+      depth_(depth > 0 ? depth : 1),
+      compress_(compress),
+      rowsPerChunk_(rowsPerChunk > 0 ? rowsPerChunk : kDefaultRowsPerChunk),
+      columns_(depth_ * kFieldsPerLevel) {
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    close();
+}
+
+bool SnapshotWriter::open() {
+    if (isOpen()) {
+        return true;
+    }
+
+    file_.open(path_, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        core::Logger::getInstance().error("Cannot create snapshot file {}", path_);
+        return false;
+    }
+
+    // Rewritten with the totals on close
+    SnapshotFileHeader header{};
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset_ = sizeof(header);
+    rows_ = 0;
+    index_.clear();
+
+    timestamps_.reserve(rowsPerChunk_);
+    for (auto& column : columns_) {
+        column.reserve(rowsPerChunk_);
+    }
+    return file_.good();
+}
+
+void SnapshotWriter::close() {
+    if (!isOpen()) {
+        return;
+    }
+
+    flushChunk();
+
+    SnapshotFileHeader header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.headerBytes = sizeof(SnapshotFileHeader);
+    header.depth = static_cast<uint32_t>(depth_);
+    header.rowsPerChunk = rowsPerChunk_;
+    header.chunkCount = index_.size();
+    header.indexOffset = offset_;
+    header.rowCount = rows_;
+
+    file_.write(reinterpret_cast<const char*>(index_.data()), index_.size() * sizeof(ChunkIndexEntry));
+    offset_ += index_.size() * sizeof(ChunkIndexEntry);
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file_.close();
+}
+
+bool SnapshotWriter::isOpen() const {
+    return file_.is_open();
+}
+
+bool SnapshotWriter::append(int64_t timestampNs, const core::PriceLevels& bids, const core::PriceLevels& asks) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    timestamps_.push_back(timestampNs);
+    for (size_t level = 0; level < depth_; ++level) {
+        bool hasBid = level < bids.size();
+        bool hasAsk = level < asks.size();
+        columns_[columnIndex(BookField::BID_PRICE, level) - 1].push_back(hasBid ? bids[level].price : 0.0);
+        columns_[columnIndex(BookField::BID_QUANTITY, level) - 1].push_back(hasBid ? bids[level].quantity : 0.0);
+        columns_[columnIndex(BookField::ASK_PRICE, level) - 1].push_back(hasAsk ? asks[level].price : 0.0);
+        columns_[columnIndex(BookField::ASK_QUANTITY, level) - 1].push_back(hasAsk ? asks[level].quantity : 0.0);
+    }
+    ++rows_;
+
+    if (timestamps_.size() >= rowsPerChunk_) {
+        return flushChunk();
+    }
+    return true;
+}
+
+size_t SnapshotWriter::getDepth() const {
+    return depth_;
+}
+
+uint64_t SnapshotWriter::getRowCount() const {
+    return rows_;
+}
+
+uint64_t SnapshotWriter::getBytesWritten() const {
+    return offset_;
+}
+
+bool SnapshotWriter::flushChunk() {
+    if (timestamps_.empty()) {
+        return true;
+    }
+
+    const size_t columns = columnCount(depth_);
+    const size_t rows = timestamps_.size();
+    size_t dataOffset = alignTo8(sizeof(ChunkHeader) + columns * sizeof(ColumnHeader));
+
+    chunkBuffer_.assign(dataOffset, 0);
+    std::vector<ColumnHeader> headers(columns);
+
+    // Deeper prices are stored relative to the best one, so each side shares a scale
+    for (int side = 0; side < 2; ++side) {
+        BookField field = side == 0 ? BookField::BID_PRICE : BookField::ASK_PRICE;
+        priceDecimals_[side] = 0;
+        for (size_t level = 0; level < depth_ && priceDecimals_[side] >= 0; ++level) {
+            for (double price : columns_[columnIndex(field, level) - 1]) {
+                int decimals = exactDecimals(price);
+                if (decimals < 0) {
+                    priceDecimals_[side] = -1;
+                    break;
+                }
+                priceDecimals_[side] = std::max(priceDecimals_[side], decimals);
+            }
+        }
+    }
+
+    for (size_t c = 0; c < columns; ++c) {
+        encoded_.clear();
+        uint8_t decimals = 0;
+        ColumnCodec codec = c == 0 ? encodeTimestamps(encoded_) : encodeColumn(c, encoded_, decimals);
+
+        headers[c].codec = static_cast<uint8_t>(codec);
+        headers[c].decimals = decimals;
+        headers[c].bytes = static_cast<uint32_t>(encoded_.size());
+        headers[c].offset = chunkBuffer_.size();
+        chunkBuffer_.insert(chunkBuffer_.end(), encoded_.begin(), encoded_.end());
+        chunkBuffer_.resize(alignTo8(chunkBuffer_.size()), 0);
+    }
+
+    ChunkHeader chunk{};
+    chunk.rows = static_cast<uint32_t>(rows);
+    chunk.columns = static_cast<uint32_t>(columns);
+    chunk.bytes = chunkBuffer_.size();
+    chunk.firstTimestamp = timestamps_.front();
+    chunk.lastTimestamp = timestamps_.back();
+    std::memcpy(chunkBuffer_.data(), &chunk, sizeof(chunk));
+    std::memcpy(chunkBuffer_.data() + sizeof(chunk), headers.data(), columns * sizeof(ColumnHeader));
+
+    file_.write(reinterpret_cast<const char*>(chunkBuffer_.data()), chunkBuffer_.size());
+    if (!file_.good()) {
+        core::Logger::getInstance().error("Write to snapshot file {} failed", path_);
+        return false;
+    }
+
+    index_.push_back({offset_, chunk.rows, 0, chunk.firstTimestamp, chunk.lastTimestamp});
+    offset_ += chunkBuffer_.size();
+
+    timestamps_.clear();
+    for (auto& column : columns_) {
+        column.clear();
+    }
+    return true;
+}
+
+ColumnCodec SnapshotWriter::encodeTimestamps(std::vector<uint8_t>& out) const {
+    if (compress_) {
+        int64_t previous = 0;
+        for (int64_t timestamp : timestamps_) {
+            putVarint(out, zigzagEncode(timestamp - previous));
+            previous = timestamp;
+        }
+        if (out.size() < timestamps_.size() * sizeof(int64_t)) {
+            return ColumnCodec::DELTA_VARINT;
+        }
+        out.clear();
+    }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(timestamps_.data());
+    out.insert(out.end(), bytes, bytes + timestamps_.size() * sizeof(int64_t));
+    return ColumnCodec::RAW;
+}
+
+ColumnCodec SnapshotWriter::encodeColumn(size_t column, std::vector<uint8_t>& out, uint8_t& decimals) {
+    const std::vector<double>& values = columns_[column - 1];
+    if (compress_) {
+        // Unchanged levels XOR to zero, a single byte
+        uint64_t previous = 0;
+        for (double value : values) {
+            uint64_t bits = doubleBits(value);
+            putVarint(out, bits ^ previous);
+            previous = bits;
+        }
+
+        // Exact decimals usually do better in ticks and lots
+        auto field = static_cast<BookField>((column - 1) % kFieldsPerLevel);
+        int scale;
+        if (field == BookField::BID_PRICE || field == BookField::ASK_PRICE) {
+            scale = priceDecimals_[field == BookField::BID_PRICE ? 0 : 1];
+        } else {
+            scale = 0;
+            for (double value : values) {
+                int valueDecimals = exactDecimals(value);
+                scale = valueDecimals < 0 ? -1 : std::max(scale, valueDecimals);
+                if (scale < 0) {
+                    break;
+                }
+            }
+        }
+
+        ColumnCodec codec = ColumnCodec::XOR_VARINT;
+        alternative_.clear();
+        if (scale >= 0) {
+            encodeTicks(column, scale, alternative_);
+        }
+        if (!alternative_.empty() && alternative_.size() < out.size()) {
+            out.swap(alternative_);
+            codec = ColumnCodec::TICK_VARINT;
+            decimals = static_cast<uint8_t>(scale);
+        }
+        if (out.size() < values.size() * sizeof(double)) {
+            return codec;
+        }
+        out.clear();
+        decimals = 0;
+    }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(values.data());
+    out.insert(out.end(), bytes, bytes + values.size() * sizeof(double));
+    return ColumnCodec::RAW;
+}
+
+void SnapshotWriter::encodeTicks(size_t column, int decimals, std::vector<uint8_t>& out) {
+    const std::vector<double>& values = columns_[column - 1];
+    const double scale = std::pow(10.0, decimals);
+    auto field = static_cast<BookField>((column - 1) % kFieldsPerLevel);
+    size_t level = (column - 1) / kFieldsPerLevel;
+    bool price = field == BookField::BID_PRICE || field == BookField::ASK_PRICE;
+
+    units_.resize(values.size());
+    if (price && level > 0) {
+        const std::vector<double>& best = columns_[columnIndex(field, 0) - 1];
+        for (size_t row = 0; row < values.size(); ++row) {
+            int64_t ticks = std::llround(values[row] * scale);
+            int64_t bestTicks = std::llround(best[row] * scale);
+            units_[row] = values[row] == 0.0 ? 0 : 1 + zigzagEncode(ticks - bestTicks);
+        }
+    } else {
+        int64_t previous = 0;
+        for (size_t row = 0; row < values.size(); ++row) {
+            int64_t units = std::llround(values[row] * scale);
+            units_[row] = zigzagEncode(units - previous);
+            previous = units;
+        }
+    }
+
+    streamVbyteEncode(units_.data(), units_.size(), out);
+}
+
+} // namespace storage
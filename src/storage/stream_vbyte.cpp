@@ -0,0 +1,139 @@
+#include "storage/stream_vbyte.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STREAM_VBYTE_X86 1
+#endif
+
+namespace storage {
+
+namespace {
+
+inline unsigned lengthCode(uint64_t value) {
+    if (value < (uint64_t{1} << 8)) return 0;
+    if (value < (uint64_t{1} << 16)) return 1;
+    if (value < (uint64_t{1} << 32)) return 2;
+    return 3;
+}
+
+inline uint64_t loadValue(const uint8_t* data, unsigned length) {
+    uint64_t value = 0;
+    std::memcpy(&value, data, length); // little-endian hosts only, like the rest of the format
+    return value;
+}
+
+#ifdef STREAM_VBYTE_X86
+
+// Shuffle and total length for two values, indexed by their two 2-bit codes
+struct PairTables {
+    alignas(16) uint8_t shuffle[16][16];
+    uint8_t length[16];
+
+    PairTables() {
+        for (unsigned pair = 0; pair < 16; ++pair) {
+            unsigned first = 1u << (pair & 3);
+            unsigned second = 1u << (pair >> 2);
+            for (unsigned i = 0; i < 8; ++i) {
+                shuffle[pair][i] = i < first ? static_cast<uint8_t>(i) : 0x80;
+                shuffle[pair][8 + i] = i < second ? static_cast<uint8_t>(first + i) : 0x80;
+            }
+            length[pair] = static_cast<uint8_t>(first + second);
+        }
+    }
+};
+
+const PairTables kPairTables;
+
+__attribute__((target("ssse3")))
+const uint8_t* decodeSsse3(const uint8_t* in, const uint8_t* end, size_t count, uint64_t* out) {
+    const uint8_t* control = in;
+    const uint8_t* data = in + (count + 3) / 4;
+    size_t i = 0;
+
+    // Each step reads at most 2 x 16 bytes; the tail goes through the scalar loop
+    for (; i + 4 <= count && data + 32 <= end; i += 4) {
+        uint8_t codes = control[i / 4];
+        unsigned low = codes & 0x0F;
+        unsigned high = codes >> 4;
+
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(kPairTables.shuffle[low]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(bytes, shuffle));
+        data += kPairTables.length[low];
+
+        bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(kPairTables.shuffle[high]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 2), _mm_shuffle_epi8(bytes, shuffle));
+        data += kPairTables.length[high];
+    }
+
+    for (; i < count; ++i) {
+        unsigned length = 1u << ((control[i / 4] >> ((i % 4) * 2)) & 3);
+        if (data + length > end) {
+            return nullptr;
+        }
+        out[i] = loadValue(data, length);
+        data += length;
+    }
+    return data;
+}
+
+#endif
+
+} // namespace
+
+void streamVbyteEncode(const uint64_t* values, size_t count, std::vector<uint8_t>& out) {
+    size_t controlStart = out.size();
+    out.resize(controlStart + (count + 3) / 4, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        unsigned code = lengthCode(values[i]);
+        out[controlStart + i / 4] |= static_cast<uint8_t>(code << ((i % 4) * 2));
+
+        size_t at = out.size();
+        out.resize(at + (1u << code));
+        std::memcpy(out.data() + at, &values[i], 1u << code);
+    }
+}
+
+const uint8_t* streamVbyteDecodeScalar(const uint8_t* in, const uint8_t* end, size_t count, uint64_t* out) {
+    const uint8_t* control = in;
+    const uint8_t* data = in + (count + 3) / 4;
+    if (data > end) {
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        unsigned length = 1u << ((control[i / 4] >> ((i % 4) * 2)) & 3);
+        if (data + length > end) {
+            return nullptr;
+        }
+        out[i] = loadValue(data, length);
+        data += length;
+    }
+    return data;
+}
+
+bool streamVbyteSimdAvailable() {
+#ifdef STREAM_VBYTE_X86
+    static const bool available = __builtin_cpu_supports("ssse3");
+    return available;
+#else
+    return false;
+#endif
+}
+
+const uint8_t* streamVbyteDecode(const uint8_t* in, const uint8_t* end, size_t count, uint64_t* out) {
+#ifdef STREAM_VBYTE_X86
+    if (streamVbyteSimdAvailable()) {
+        if (in + (count + 3) / 4 > end) {
+            return nullptr;
+        }
+        return decodeSsse3(in, end, count, out);
+    }
+#endif
+    return streamVbyteDecodeScalar(in, end, count, out);
+}
+
+} // namespace storage
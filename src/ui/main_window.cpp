@@ -1,13 +1,34 @@
 #include "ui/main_window.h"
 #include "core/logger.h"
 #include <QApplication>
+#include <QHeaderView>
 #include <QStyle>
 #include <QScreen>
 #include <QDateTime>
-#include <QThread>
+#include <map>
 
 namespace ui {
 
+namespace {
+
+using FeedBooks = std::map<std::string, std::shared_ptr<core::OrderBook>>;
+
+// Book for a configured asset: the feed instrument of that name, else one of
+// its derivatives ("BTC-USDT" -> "BTC-USDT-SWAP")
+models::FeedBook findFeedBook(const FeedBooks& books, const std::string& asset) {
+    auto it = books.find(asset);
+    if (it == books.end()) {
+        std::string prefix = asset + "-";
+        it = books.lower_bound(prefix);
+        if (it != books.end() && it->first.compare(0, prefix.size(), prefix) != 0) {
+            it = books.end();
+        }
+    }
+    return it != books.end() ? models::FeedBook{it->first, it->second} : models::FeedBook{};
+}
+
+} // namespace
+
 MainWindow::MainWindow(std::shared_ptr<core::Config> config, QWidget *parent)
     : QMainWindow(parent)
     , config_(config)
@@ -40,16 +61,21 @@ MainWindow::MainWindow(std::shared_ptr<core::Config> config, QWidget *parent)
             Q_ARG(models::SimulationResult, result));
     });
 
-    // Initialize WebSocket in a separate thread
-    QThread* wsThread = new QThread(this);
-    connect(wsThread, &QThread::started, this, &MainWindow::initializeSimulator);
-    wsThread->start();
+    // Connecting is asynchronous, so this returns without waiting on the network
+    initializeSimulator();
 }
 
 MainWindow::~MainWindow() {
-    if (wsClient_) {
-        wsClient_->disconnect();
+    if (feedManager_) {
+        feedManager_->stop();
     }
+    if (msgProcessor_) {
+        msgProcessor_->stop();
+    }
+    if (engine_) {
+        engine_->stop();
+    }
+    simulator_->stopContinuousSimulation();
     simulator_->unregisterResultCallback();
 }
 
@@ -139,6 +165,14 @@ void MainWindow::setupOutputPanel() {
     outputLayout_->addRow("Net Cost:", netCostLabel_);
     outputLayout_->addRow("Maker/Taker Ratio:", makerTakerLabel_);
     outputLayout_->addRow("Internal Latency:", latencyLabel_);
+
+    // Every instrument of the simulation engine, refreshed with the diagnostics
+    engineTable_ = new QTableWidget(0, 6, this);
+    engineTable_->setHorizontalHeaderLabels({"Exchange", "Asset", "Slippage", "Impact", "Fees", "Net Cost"});
+    engineTable_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    engineTable_->verticalHeader()->setVisible(false);
+    engineTable_->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    outputLayout_->addRow(engineTable_);
 }
 
 void MainWindow::setupDiagnosticPanel() {
@@ -225,6 +259,46 @@ void MainWindow::updatePerformanceMetrics() {
         now - lastFrameTime_).count() / 1000.0;
     uiLatencyLabel_->setText(QString::asprintf("%.2f ms", uiLatency));
     lastFrameTime_ = now;
+
+    // Feed latency distributions since startup
+    if (msgProcessor_) {
+        processing::FeedLatency feed = msgProcessor_->getFeedLatency();
+        wsLatencyLabel_->setText(QString::asprintf("p50 %.2f / p99 %.2f ms",
+            feed.exchangeToReceive.p50 / 1000.0, feed.exchangeToReceive.p99 / 1000.0));
+        processingLatencyLabel_->setText(QString::asprintf("p50 %.1f / p99 %.1f µs",
+            feed.receiveToApplied.p50, feed.receiveToApplied.p99));
+    }
+
+    updateEngineView();
+}
+
+void MainWindow::updateEngineView() {
+    if (!engine_) {
+        return;
+    }
+
+    engine_->getView(engineView_);
+    engineTable_->setRowCount(static_cast<int>(engineView_.size()));
+    for (size_t i = 0; i < engineView_.size(); ++i) {
+        const models::InstrumentResult& instrument = engineView_[i];
+        const models::SimulationResult& result = instrument.result;
+        bool simulated = instrument.runs > 0;
+
+        auto setCell = [this, row = static_cast<int>(i)](int column, const QString& text) {
+            QTableWidgetItem* item = engineTable_->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                engineTable_->setItem(row, column, item);
+            }
+            item->setText(text);
+        };
+        setCell(0, QString::fromStdString(instrument.exchange));
+        setCell(1, QString::fromStdString(instrument.asset));
+        setCell(2, simulated ? QString::asprintf("%.2f%%", result.expectedSlippage) : "-");
+        setCell(3, simulated ? QString::asprintf("%.2f%%", result.expectedMarketImpact) : "-");
+        setCell(4, simulated ? QString::asprintf("$%.2f", result.expectedFees) : "-");
+        setCell(5, simulated ? QString::asprintf("$%.2f", result.netCost) : "-");
+    }
 }
 
 void MainWindow::updateAssetList(const QString& exchange) {
@@ -244,20 +318,96 @@ void MainWindow::updateFeeTiers(const QString& exchange) {
 }
 
 void MainWindow::initializeSimulator() {
-    // Initialize WebSocket client
-    auto msgProcessor = std::make_shared<processing::MessageProcessor>();
-    wsClient_ = std::make_shared<websocket::WebSocketClient>(config_, msgProcessor);
+    // Initialize message processing pipeline
+    msgProcessor_ = std::make_shared<processing::MessageProcessor>(config_);
+
+    // Initialize WebSocket sessions on the shared I/O pool
+    std::vector<std::string> endpoints = config_->getWebSocketEndpoints();
+    feedManager_ = std::make_unique<websocket::FeedManager>(config_, msgProcessor_);
+    feedManager_->start();
+    for (const auto& url : endpoints) {
+        feedManager_->addSession(url);
+    }
+    wsClient_ = feedManager_->getSessions().front();
+
+    // Book per feed instrument for the simulation engine
+    FeedBooks books;
+
+    auto subscriptions = config_->getSubscriptions();
+    if (subscriptions.empty()) {
+        // Each endpoint streams the instrument in its last path segment; the
+        // primary one drives the simulator, and redundant lines share a book
+        for (const auto& endpoint : endpoints) {
+            std::string symbol = endpoint.substr(endpoint.find_last_of('/') + 1);
+            if (books.count(symbol)) {
+                continue;
+            }
+            auto orderBook = books.empty() ? orderBook_ : std::make_shared<core::OrderBook>();
+            msgProcessor_->registerOrderBook(symbol, orderBook);
+            books.emplace(symbol, orderBook);
+        }
+    } else {
+        // OKX public feed: instruments come from websocket.subscriptions, and
+        // the first book-carrying one drives the simulator
+        subscriptionManager_ = std::make_unique<websocket::SubscriptionManager>(wsClient_, msgProcessor_);
+        bool primarySet = false;
+        for (const auto& [channelName, instrument] : subscriptions) {
+            websocket::SubscriptionManager::Channel channel;
+            if (!websocket::SubscriptionManager::parseChannel(channelName, channel)) {
+                core::Logger::getInstance().warn("Unknown channel '{}' for {}", channelName, instrument);
+                continue;
+            }
+            subscriptionManager_->add(channel, instrument);
+
+            auto orderBook = subscriptionManager_->getOrderBook(channel, instrument);
+            if (orderBook) {
+                books.emplace(instrument, orderBook);
+            }
+            if (orderBook && !primarySet) {
+                orderBook_ = orderBook;
+                primarySet = true;
+            }
+        }
+    }
+
+    // Simulation runs on its own thread, woken by each applied update of the primary book
+    simulator_->startContinuousSimulation(orderBook_);
+
+    // The feed carries the default exchange's books; other venues have none yet
+    if (config_->isSimulationEngineEnabled()) {
+        engine_ = std::make_unique<models::SimulationEngine>(config_);
+        std::string venue = config_->getDefaultExchange();
+        size_t added = engine_->addConfiguredInstruments([&](const std::string& exchange, const std::string& asset) {
+            return exchange == venue ? findFeedBook(books, asset) : models::FeedBook{};
+        });
+        if (added > 0) {
+            engine_->start();
+        } else {
+            core::Logger::getInstance().warn("No feed instrument for any configured asset; simulation engine not started");
+            engine_.reset();
+        }
+    }
+    engineTable_->setVisible(engine_ != nullptr);
+
+    msgProcessor_->setBookUpdateHandler([this](const std::shared_ptr<core::OrderBook>& orderBook) {
+        if (orderBook == orderBook_) {
+            simulator_->notifyBookUpdate();
+        }
+        if (engine_) {
+            engine_->notifyBookUpdate(orderBook);
+        }
+    });
+    msgProcessor_->start();
 
     // Connect WebSocket signals
     connect(wsClient_.get(), &websocket::WebSocketClient::connectionStatusChanged,
             this, &MainWindow::onConnectionStatusChanged, Qt::QueuedConnection);
 
-    // Start WebSocket connection
-    bool connected = wsClient_->connect();
-    if (!connected) {
-        core::Logger::getInstance().error("Failed to connect to WebSocket server");
-        emit connectionStatusChanged(false);
+    // Start WebSocket connections; status arrives via connectionStatusChanged
+    if (!feedManager_->connectAll()) {
+        core::Logger::getInstance().error("Failed to start WebSocket sessions");
+        onConnectionStatusChanged(false);
     }
 }
 
-} // namespace ui 
\ No newline at end of file
+} // namespace ui
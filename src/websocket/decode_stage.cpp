@@ -0,0 +1,355 @@
+#include "websocket/decode_stage.h"
+#include "core/logger.h"
+#include "core/utils.h"
+#include <algorithm>
+#include <functional>
+
+namespace processing {
+
+DecodeStage::DecodeStage(int numWorkers, WaitStrategy::Type waitStrategy, int spinIterations) {
+    if (numWorkers < 1) {
+        numWorkers = 1;
+    }
+
+    for (int i = 0; i < numWorkers; ++i) {
+        workers_.push_back(std::make_unique<Worker>(waitStrategy, spinIterations, arbitrationStats_));
+    }
+    inlineWorker_ = std::make_unique<Worker>(waitStrategy, spinIterations, arbitrationStats_);
+}
+
+DecodeStage::~DecodeStage() {
+    stop();
+}
+
+void DecodeStage::start() {
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    for (auto& worker : workers_) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w]() { runWorker(*w); });
+    }
+
+    core::Logger::getInstance().info("Decode stage started with {} workers", workers_.size());
+}
+
+void DecodeStage::stop() {
+    running_ = false;
+    for (auto& worker : workers_) {
+        worker->waitStrategy.notify();
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool DecodeStage::dispatch(WebSocketMessage&& message) {
+    std::string_view symbol = extractInstrumentId(message.data);
+    Worker& worker = *workers_[workerFor(symbol)];
+    if (!worker.queue.try_enqueue(std::move(message))) {
+        return false;
+    }
+    worker.waitStrategy.notify();
+    return true;
+}
+
+size_t DecodeStage::dispatchBatch(MessageBatch& batch) {
+    size_t dispatched = 0;
+    for (auto& message : batch) {
+        std::string_view symbol = extractInstrumentId(message.data);
+        Worker& worker = *workers_[workerFor(symbol)];
+        if (worker.queue.try_enqueue(std::move(message))) {
+            ++dispatched;
+        }
+    }
+    if (dispatched < batch.count) {
+        dropped_.fetch_add(batch.count - dispatched, std::memory_order_release);
+    }
+
+    // Wake each worker once per batch rather than once per message
+    for (auto& worker : workers_) {
+        if (worker->queue.size_approx() > 0) {
+            worker->waitStrategy.notify();
+        }
+    }
+    return dispatched;
+}
+
+void DecodeStage::processInline(MessageBatch& batch) {
+    processBatch(*inlineWorker_, batch);
+}
+
+void DecodeStage::registerOrderBook(const std::string& symbol, std::shared_ptr<core::OrderBook> orderBook) {
+    registerOrderBook(std::string(), symbol, orderBook);
+}
+
+void DecodeStage::registerOrderBook(const std::string& channel, const std::string& instrument,
+                                    std::shared_ptr<core::OrderBook> orderBook) {
+    std::lock_guard<std::mutex> lock(booksMutex_);
+    books_[routeKey(channel, instrument)] = orderBook;
+}
+
+std::shared_ptr<core::OrderBook> DecodeStage::getOrderBook(const std::string& symbol) const {
+    return getOrderBook(std::string(), symbol);
+}
+
+std::shared_ptr<core::OrderBook> DecodeStage::getOrderBook(const std::string& channel, const std::string& instrument) const {
+    std::lock_guard<std::mutex> lock(booksMutex_);
+    auto it = books_.find(routeKey(channel, instrument));
+    return it != books_.end() ? it->second : nullptr;
+}
+
+void DecodeStage::setBookUpdateHandler(BookUpdateHandler handler) {
+    bookUpdateHandler_ = handler;
+}
+
+void DecodeStage::beginResync(uint32_t line, uint32_t session, double budgetMs) {
+    LineResync& state = resync_[line % resync_.size()];
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    state.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    state.budgetMs = budgetMs;
+    state.session = session;
+    state.pending.store(true, std::memory_order_release);
+}
+
+bool DecodeStage::isResyncPending(uint32_t line) const {
+    return resync_[line % resync_.size()].pending.load(std::memory_order_acquire);
+}
+
+double DecodeStage::getLastResyncMs() const {
+    return lastResyncMs_.load(std::memory_order_relaxed);
+}
+
+void DecodeStage::noteResyncSnapshot(Worker& worker, const BookUpdate& update) {
+    size_t line = update.line % resync_.size();
+    LineResync& state = resync_[line];
+    uint32_t session = state.session.load(std::memory_order_acquire);
+    if (session == 0 || update.session < session) {
+        return; // no reconnect on this line yet, or a frame from before it
+    }
+
+    // Time each book once per reconnect
+    auto& resynced = worker.resynced[update.route];
+    if (resynced[line] >= session) {
+        return;
+    }
+    resynced[line] = session;
+
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    int64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() - state.startNs.load();
+    double elapsedMs = elapsedNs / 1e6;
+    core::Logger::getInstance().debug("{} {} rebuilt {:.1f} ms after line {} disconnected",
+        update.channel, update.symbol, elapsedMs, update.line);
+
+    // The line's first rebuilt book, possibly on several workers at once; only one reports
+    bool expected = true;
+    if (!state.pending.compare_exchange_strong(expected, false, std::memory_order_acq_rel)) {
+        return;
+    }
+    lastResyncMs_ = elapsedMs;
+
+    double budgetMs = state.budgetMs.load();
+    if (budgetMs > 0.0 && elapsedMs > budgetMs) {
+        core::Logger::getInstance().warn("Feed line {} resynchronised {:.1f} ms after disconnect (budget {:.0f} ms)",
+            update.line, elapsedMs, budgetMs);
+    } else {
+        core::Logger::getInstance().info("Feed line {} resynchronised {:.1f} ms after disconnect", update.line, elapsedMs);
+    }
+}
+
+void DecodeStage::setBufferPool(BufferPool* pool) {
+    bufferPool_ = pool;
+}
+
+void DecodeStage::setControlHandler(ControlHandler handler) {
+    controlHandler_ = handler;
+}
+
+void DecodeStage::setGapHandler(GapHandler handler) {
+    gapHandler_ = handler;
+}
+
+uint64_t DecodeStage::getSequenceGapCount() const {
+    return sequenceGaps_.load(std::memory_order_relaxed);
+}
+
+void DecodeStage::setLatencyTracking(bool enabled) {
+    trackLatency_ = enabled;
+}
+
+FeedLatency DecodeStage::getFeedLatency() const {
+    return {exchangeToReceive_.summary(), receiveToApplied_.summary()};
+}
+
+void DecodeStage::resetFeedLatency() {
+    exchangeToReceive_.reset();
+    receiveToApplied_.reset();
+}
+
+void DecodeStage::setArbitration(bool enabled) {
+    arbitrate_ = enabled;
+}
+
+ArbitrationSummary DecodeStage::getArbitrationSummary() const {
+    return arbitrationStats_.summary();
+}
+
+int DecodeStage::getWorkerCount() const {
+    return static_cast<int>(workers_.size());
+}
+
+size_t DecodeStage::workerFor(std::string_view symbol) const {
+    return std::hash<std::string_view>{}(symbol) % workers_.size();
+}
+
+uint64_t DecodeStage::getProcessedCount() const {
+    uint64_t total = inlineWorker_->processed.load(std::memory_order_relaxed);
+    for (const auto& worker : workers_) {
+        total += worker->processed.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t DecodeStage::getFrameCount() const {
+    uint64_t total = inlineWorker_->frames.load(std::memory_order_acquire);
+    for (const auto& worker : workers_) {
+        total += worker->frames.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+uint64_t DecodeStage::getDroppedCount() const {
+    return dropped_.load(std::memory_order_acquire);
+}
+
+void DecodeStage::runWorker(Worker& worker) {
+    MessageBatch& batch = worker.batch;
+    while (running_) {
+        batch.count = worker.queue.try_dequeue_bulk(batch.messages.begin(), batch.capacity());
+        if (batch.count > 0) {
+            worker.waitStrategy.reset();
+            processBatch(worker, batch);
+        } else {
+            worker.waitStrategy.idle([this, &worker]() {
+                return worker.queue.size_approx() > 0 || !running_;
+            });
+        }
+    }
+}
+
+void DecodeStage::processBatch(Worker& worker, MessageBatch& batch) {
+    if (worker.updates.size() < batch.count) {
+        worker.updates.resize(batch.count);
+    }
+
+    // Decode the whole batch first
+    size_t decoded = 0;
+    for (size_t i = 0; i < batch.count; ++i) {
+        const WebSocketMessage& message = batch.messages[i];
+        if (arbitrate_ && !worker.arbitrator.accept(FeedArbitrator::checksum(message.data), message.line, message.receivedNs)) {
+            continue; // the other line got here first
+        }
+
+        BookUpdate& update = worker.updates[decoded];
+        MessageKind kind = decodeMarketData(message.data, update);
+        if (kind == MessageKind::EVENT && controlHandler_) {
+            controlHandler_(message.data);
+        }
+        if (kind != MessageKind::BOOK) {
+            continue;
+        }
+        if (arbitrate_ && !worker.arbitrator.isCurrent(update.symbol, update.timestamp)) {
+            continue;
+        }
+
+        update.receivedNs = message.receivedNs;
+        update.session = message.session;
+        update.line = message.line;
+        update.wallNs = message.wallNs;
+        ++decoded;
+    }
+
+    // Raw frames are no longer needed; recycle their buffers for the feed threads
+    if (bufferPool_) {
+        for (auto& message : batch) {
+            bufferPool_->release(std::move(message.data));
+        }
+    }
+
+    // Receive stamps are monotonic; map them onto the wall clock once per batch
+    // to compare with exchange timestamps
+    int64_t wallOffsetNs = 0;
+    if (trackLatency_) {
+        wallOffsetNs = core::utils::systemClockNanos(std::chrono::system_clock::now()) - core::utils::steadyClockNanos();
+    }
+
+    // Apply in arrival order, remembering which books changed
+    worker.touched.clear();
+    for (size_t i = 0; i < decoded; ++i) {
+        const BookUpdate& update = worker.updates[i];
+        auto orderBook = lookupOrderBook(worker, update.route);
+        if (update.wallNs != 0) {
+            core::utils::advanceVirtualTime(update.wallNs);
+        }
+        if (update.snapshot) {
+            orderBook->update(update.exchange, update.symbol, update.bids, update.asks, update.timestamp, update.seqId);
+        } else if (!orderBook->applyDelta(update.bids, update.asks, update.timestamp, update.prevSeqId, update.seqId)) {
+            sequenceGaps_.fetch_add(1, std::memory_order_relaxed);
+            core::Logger::getInstance().warn("Sequence gap on {} {}: expected {}, got prevSeqId {}",
+                update.channel, update.symbol, orderBook->getSequenceId(), update.prevSeqId);
+            if (gapHandler_) {
+                gapHandler_(update.channel, update.symbol);
+            }
+            continue;
+        }
+
+        if (trackLatency_ && update.receivedNs > 0) {
+            receiveToApplied_.record(core::utils::steadyClockNanos() - update.receivedNs);
+            int64_t exchangeNs = core::utils::systemClockNanos(orderBook->getTimestamp());
+            exchangeToReceive_.record(update.receivedNs + wallOffsetNs - exchangeNs);
+        }
+
+        // Only a snapshot makes a book valid again after a reconnect
+        if (update.snapshot) {
+            noteResyncSnapshot(worker, update);
+        }
+
+        if (std::find(worker.touched.begin(), worker.touched.end(), orderBook) == worker.touched.end()) {
+            worker.touched.push_back(orderBook);
+        }
+    }
+    worker.processed.fetch_add(decoded, std::memory_order_relaxed);
+
+    // One notification per book for its final state in this batch
+    if (bookUpdateHandler_) {
+        for (const auto& orderBook : worker.touched) {
+            bookUpdateHandler_(orderBook);
+        }
+    }
+    worker.frames.fetch_add(batch.count, std::memory_order_release);
+}
+
+std::shared_ptr<core::OrderBook> DecodeStage::lookupOrderBook(Worker& worker, uint64_t route) {
+    // Each symbol is owned by exactly one worker, so the local cache needs no lock
+    auto it = worker.books.find(route);
+    if (it != worker.books.end()) {
+        return it->second;
+    }
+
+    std::shared_ptr<core::OrderBook> orderBook;
+    {
+        std::lock_guard<std::mutex> lock(booksMutex_);
+        auto& entry = books_[route];
+        if (!entry) {
+            entry = std::make_shared<core::OrderBook>();
+        }
+        orderBook = entry;
+    }
+
+    worker.books.emplace(route, orderBook);
+    return orderBook;
+}
+
+} // namespace processing
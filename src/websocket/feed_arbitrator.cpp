@@ -0,0 +1,85 @@
+#include "websocket/feed_arbitrator.h"
+#include <functional>
+
+namespace processing {
+
+ArbitrationSummary ArbitrationStats::summary() const {
+    ArbitrationSummary result;
+    for (const auto& wins : wins_) {
+        result.wins.push_back(wins.load(std::memory_order_relaxed));
+    }
+    result.duplicates = duplicates_.load(std::memory_order_relaxed);
+    result.stale = stale_.load(std::memory_order_relaxed);
+    result.unmatched = unmatched_.load(std::memory_order_relaxed);
+    result.lead = lead_.summary();
+    return result;
+}
+
+void ArbitrationStats::reset() {
+    for (auto& wins : wins_) {
+        wins.store(0, std::memory_order_relaxed);
+    }
+    duplicates_ = 0;
+    stale_ = 0;
+    unmatched_ = 0;
+    lead_.reset();
+}
+
+FeedArbitrator::FeedArbitrator(ArbitrationStats& stats, size_t window)
+    : stats_(stats), window_(window > 0 ? window : 1) {
+    order_.reserve(window_);
+    seen_.reserve(window_ * 2);
+}
+
+uint64_t FeedArbitrator::checksum(std::string_view payload) {
+    return std::hash<std::string_view>{}(payload);
+}
+
+bool FeedArbitrator::accept(uint64_t key, uint32_t line, int64_t receivedNs) {
+    auto it = seen_.find(key);
+    if (it != seen_.end()) {
+        Arrival& first = it->second;
+        if (first.line != line && !first.matched) {
+            // The other line's copy: credit the winner with its lead
+            first.matched = true;
+            stats_.recordWin(first.line, receivedNs - first.receivedNs);
+        } else {
+            stats_.recordDuplicate();
+        }
+        return false;
+    }
+
+    if (order_.size() == window_) {
+        evictOldest();
+        order_[next_] = key;
+    } else {
+        order_.push_back(key);
+    }
+    next_ = (next_ + 1) % window_;
+    seen_.emplace(key, Arrival{line, receivedNs, false});
+    return true;
+}
+
+bool FeedArbitrator::isCurrent(const std::string& symbol, const std::string& timestamp) {
+    // ISO 8601 timestamps from one source order lexicographically
+    std::string& last = lastTimestamp_[symbol];
+    if (!last.empty() && timestamp < last) {
+        stats_.recordStale();
+        return false;
+    }
+    last = timestamp;
+    return true;
+}
+
+void FeedArbitrator::evictOldest() {
+    auto it = seen_.find(order_[next_]);
+    if (it == seen_.end()) {
+        return;
+    }
+    if (!it->second.matched) {
+        stats_.recordUnmatched();
+    }
+    seen_.erase(it);
+}
+
+} // namespace processing
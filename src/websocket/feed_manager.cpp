@@ -0,0 +1,135 @@
+#include "websocket/feed_manager.h"
+#include "core/logger.h"
+#include "websocket/socket_tuning.h"
+#include <algorithm>
+
+namespace websocket {
+
+FeedManager::FeedManager(std::shared_ptr<core::Config> config, std::shared_ptr<processing::MessageProcessor> processor)
+    : config_(config), processor_(processor) {
+}
+
+FeedManager::~FeedManager() {
+    stop();
+}
+
+void FeedManager::start() {
+    if (running_) {
+        return;
+    }
+
+    int threadCount = std::max(1, config_->getIoThreads());
+    std::vector<int> cpus = config_->getIoThreadCpus();
+    int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Every session enqueues from its pool thread; the SPSC queue takes only
+    // one, so all sessions then share a single thread
+    if (threadCount > 1 && processor_->getQueueType() == processing::MessageProcessor::QueueType::SPSC) {
+        core::Logger::getInstance().error("spsc queue cannot take {} I/O threads as producers; running one", threadCount);
+        threadCount = 1;
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        auto ioThread = std::make_unique<IoThread>();
+        ioThread->cpu = i < static_cast<int>(cpus.size()) ? cpus[i] : i % hardwareThreads;
+
+        IoThread* t = ioThread.get();
+        std::string policy = config_->getIoThreadPolicy();
+        int priority = config_->getIoThreadPriority();
+        t->thread = std::thread([t, i, policy, priority]() {
+            std::string applied = applyIoThreadTuning(t->cpu, policy, priority);
+            core::Logger::getInstance().info("Feed I/O thread {}: {}", i, applied);
+
+            try {
+                t->ioc.run();
+            } catch (const std::exception& e) {
+                core::Logger::getInstance().error("Feed I/O thread error: {}", e.what());
+            }
+        });
+        threads_.push_back(std::move(ioThread));
+    }
+
+    running_ = true;
+    core::Logger::getInstance().info("Feed manager started with {} I/O threads", threadCount);
+}
+
+void FeedManager::stop() {
+    if (!running_) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<WebSocketClient>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        sessions.swap(sessions_);
+    }
+
+    // Sessions must be torn down while the pool is still running their strands
+    for (auto& session : sessions) {
+        session->disconnect();
+    }
+
+    if (config_->isArbitrationEnabled() && sessions.size() > 1) {
+        processing::ArbitrationSummary stats = processor_->getArbitrationSummary();
+        for (size_t line = 0; line < sessions.size() && line < stats.wins.size(); ++line) {
+            core::Logger::getInstance().info("Feed line {} ({}) won {} updates", line,
+                sessions[line]->getEndpoint(), stats.wins[line]);
+        }
+        core::Logger::getInstance().info("Arbitration lead p50 {:.1f} us, p99 {:.1f} us; {} unmatched, {} stale",
+            stats.lead.p50, stats.lead.p99, stats.unmatched, stats.stale);
+    }
+    sessions.clear();
+
+    for (auto& t : threads_) {
+        t->workGuard.reset();
+        t->ioc.stop();
+    }
+    for (auto& t : threads_) {
+        if (t->thread.joinable()) {
+            t->thread.join();
+        }
+    }
+    threads_.clear();
+    running_ = false;
+}
+
+std::shared_ptr<WebSocketClient> FeedManager::addSession(const std::string& endpoint) {
+    if (!running_) {
+        start();
+    }
+
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    IoThread& t = *threads_[nextThread_++ % threads_.size()];
+    auto session = std::make_shared<WebSocketClient>(config_, processor_, t.ioc, endpoint);
+    session->setLine(static_cast<uint32_t>(sessions_.size()));
+    sessions_.push_back(session);
+    return session;
+}
+
+bool FeedManager::connectAll() {
+    bool allConnected = true;
+    for (auto& session : getSessions()) {
+        // Non-blocking: every session's handshake proceeds concurrently
+        if (!session->connect()) {
+            core::Logger::getInstance().warn("Session {} could not be started", session->getEndpoint());
+            allConnected = false;
+        }
+    }
+    return allConnected;
+}
+
+std::vector<std::shared_ptr<WebSocketClient>> FeedManager::getSessions() const {
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    return sessions_;
+}
+
+size_t FeedManager::getSessionCount() const {
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    return sessions_.size();
+}
+
+int FeedManager::getThreadCount() const {
+    return static_cast<int>(threads_.size());
+}
+
+} // namespace websocket
@@ -0,0 +1,154 @@
+#include "websocket/feed_recorder.h"
+#include "core/logger.h"
+#include <chrono>
+#include <cstring>
+
+namespace processing {
+
+FeedRecorder::FeedRecorder(const std::string& directory, size_t segmentBytes)
+    : writer_(directory, "feed", segmentBytes),
+      ring_(std::make_unique<uint8_t[]>(kRingBytes)) { // zeroed, so its pages are faulted in up front
+}
+
+FeedRecorder::~FeedRecorder() {
+    stop();
+}
+
+bool FeedRecorder::start() {
+    if (running_) {
+        return true;
+    }
+    if (!writer_.open()) {
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&FeedRecorder::run, this);
+    core::Logger::getInstance().info("Capturing feed to {}", writer_.getCurrentPath());
+    return true;
+}
+
+void FeedRecorder::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    writer_.close();
+
+    CaptureStats stats = getStats();
+    core::Logger::getInstance().info("Capture closed: {} frames, {:.1f} MB in {} segments, {} dropped",
+        stats.recorded, stats.bytes / (1024.0 * 1024.0), stats.segments, stats.dropped);
+}
+
+void FeedRecorder::capture(const MessageBatch& batch) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t dropped = 0;
+
+    for (size_t i = 0; i < batch.count; ++i) {
+        const WebSocketMessage& message = batch.messages[i];
+        size_t size = storage::recordSize(message.data.size());
+        size_t offset = tail & (kRingBytes - 1);
+        size_t contiguous = kRingBytes - offset;
+        // Records never straddle the end of the ring; a short tail is skipped
+        size_t needed = size <= contiguous ? size : contiguous + size;
+
+        if (size > kRingBytes / 2) {
+            ++dropped;
+            continue;
+        }
+        if (tail + needed - cachedHead_ > kRingBytes) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail + needed - cachedHead_ > kRingBytes) {
+                ++dropped;
+                continue;
+            }
+        }
+
+        if (size > contiguous) {
+            std::memcpy(ring_.get() + offset, &kWrapMarker, sizeof(kWrapMarker));
+            tail += contiguous;
+            offset = 0;
+        }
+
+        storage::RecordHeader header{};
+        header.length = static_cast<uint32_t>(message.data.size());
+        header.type = static_cast<uint16_t>(storage::RecordType::FRAME);
+        header.line = static_cast<uint16_t>(message.line);
+        header.session = message.session;
+        header.receivedNs = message.receivedNs;
+        std::memcpy(ring_.get() + offset, &header, sizeof(header));
+        std::memcpy(ring_.get() + offset + sizeof(header), message.data.data(), message.data.size());
+        tail += size;
+    }
+
+    // One publish per batch
+    tail_.store(tail, std::memory_order_release);
+    if (dropped > 0) {
+        dropped_.fetch_add(dropped, std::memory_order_relaxed);
+    }
+}
+
+CaptureStats FeedRecorder::getStats() const {
+    CaptureStats stats;
+    stats.recorded = recorded_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    stats.segments = segments_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FeedRecorder::run() {
+    while (running_) {
+        // Polling keeps wakeups (and their syscalls) off the dispatcher
+        if (drain() == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(kIdleSleepUs));
+        }
+    }
+    drain();
+}
+
+size_t FeedRecorder::drain() {
+    const size_t start = head_.load(std::memory_order_relaxed);
+    size_t head = start;
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    size_t count = 0;
+    uint64_t failed = 0;
+
+    while (head != tail) {
+        size_t offset = head & (kRingBytes - 1);
+        // A wrap marker may sit in the last 8 bytes of the ring, too short for
+        // a header, so look at the length alone first
+        uint32_t length;
+        std::memcpy(&length, ring_.get() + offset, sizeof(length));
+        if (length == kWrapMarker) {
+            head += kRingBytes - offset;
+            continue;
+        }
+
+        storage::RecordHeader header;
+        std::memcpy(&header, ring_.get() + offset, sizeof(header));
+
+        std::string_view payload(reinterpret_cast<const char*>(ring_.get() + offset + sizeof(header)), header.length);
+        if (!writer_.append(storage::RecordType::FRAME, payload, header.receivedNs, header.session, header.line)) {
+            ++failed;
+        }
+        head += storage::recordSize(header.length);
+        ++count;
+    }
+
+    if (head == start) {
+        return 0;
+    }
+    head_.store(head, std::memory_order_release);
+    recorded_.fetch_add(count - failed, std::memory_order_relaxed);
+    dropped_.fetch_add(failed, std::memory_order_relaxed);
+    bytes_.store(writer_.getBytesWritten(), std::memory_order_relaxed);
+    segments_.store(writer_.getSegmentCount(), std::memory_order_relaxed);
+    return count;
+}
+
+} // namespace processing
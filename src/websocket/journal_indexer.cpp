@@ -0,0 +1,232 @@
+#include "websocket/journal_indexer.h"
+#include "websocket/market_data_decoder.h"
+#include "core/logger.h"
+#include "core/utils.h"
+#include <algorithm>
+#include <limits>
+
+namespace processing {
+
+JournalIndexer::JournalIndexer(int64_t intervalNs)
+    : intervalNs_(intervalNs > 0 ? intervalNs : 1000000000) {
+}
+
+bool JournalIndexer::open(const std::vector<std::string>& segments, bool rebuild) {
+    segments_ = segments;
+    indexes_.assign(segments.size(), storage::JournalIndex());
+    steadyToWallNs_.assign(segments.size(), 0);
+    firstWallNs_.assign(segments.size(), std::numeric_limits<int64_t>::min());
+    books_.clear();
+    built_ = 0;
+
+    bool readable = false;
+    bool booksCurrent = true; // books_ hold the state at the end of the previous segment
+    for (size_t i = 0; i < segments.size(); ++i) {
+        storage::JournalReader reader;
+        if (!reader.open(segments[i])) {
+            booksCurrent = false;
+            continue;
+        }
+        readable = true;
+        const storage::SegmentHeader& header = reader.getHeader();
+        steadyToWallNs_[i] = header.steadyToWallNs;
+
+        // A segment still being written has no final size, so its index is never saved
+        bool closed = header.dataBytes > 0;
+        if (!rebuild && closed && indexes_[i].load(segments[i], header, header.dataBytes)) {
+            booksCurrent = false;
+        } else {
+            if (!booksCurrent && i > 0) {
+                catchUp(i - 1);
+            }
+            indexSegment(i, closed);
+            booksCurrent = true;
+        }
+
+        const auto& points = indexes_[i].getPoints();
+        if (!points.empty()) {
+            firstWallNs_[i] = points.front().receivedNs + steadyToWallNs_[i];
+        }
+        // Keeps the list ordered for the binary search; seekTime skips segments without points
+        if (i > 0) {
+            firstWallNs_[i] = std::max(firstWallNs_[i], firstWallNs_[i - 1]);
+        }
+    }
+
+    if (built_ > 0) {
+        core::Logger::getInstance().info("Indexed {} of {} journal segments", built_, segments.size());
+    }
+    return readable;
+}
+
+bool JournalIndexer::seekTime(int64_t wallNs, SeekPoint& point) const {
+    auto it = std::upper_bound(firstWallNs_.begin(), firstWallNs_.end(), wallNs);
+    size_t segment = it == firstWallNs_.begin() ? 0 : static_cast<size_t>(it - firstWallNs_.begin()) - 1;
+
+    // Nearest segment with points, looking back first
+    while (segment > 0 && indexes_[segment].getPoints().empty()) {
+        --segment;
+    }
+    while (segment < indexes_.size() && indexes_[segment].getPoints().empty()) {
+        ++segment;
+    }
+    if (segment >= indexes_.size()) {
+        return false;
+    }
+
+    const storage::IndexPoint* found = indexes_[segment].findTime(wallNs - steadyToWallNs_[segment]);
+    toSeekPoint(segment, *found, point);
+    return true;
+}
+
+bool JournalIndexer::seekSequence(uint64_t route, int64_t seqId, SeekPoint& point) const {
+    for (size_t segment = indexes_.size(); segment-- > 0;) {
+        if (const storage::IndexPoint* found = indexes_[segment].findSequence(route, seqId)) {
+            toSeekPoint(segment, *found, point);
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<storage::JournalIndex>& JournalIndexer::getIndexes() const {
+    return indexes_;
+}
+
+size_t JournalIndexer::getBuiltCount() const {
+    return built_;
+}
+
+void JournalIndexer::indexSegment(size_t segment, bool save) {
+    storage::JournalReader reader;
+    if (!reader.open(segments_[segment])) {
+        return;
+    }
+
+    storage::JournalIndex& index = indexes_[segment];
+    index.reset(reader.getHeader(), reader.getHeader().dataBytes, intervalNs_);
+
+    storage::BookDecoder decoder;
+    storage::BookFrame frame;
+    storage::JournalRecord record;
+    int64_t lastPointNs = 0;
+    uint64_t ordinal = 0;
+    size_t offset = reader.getOffset();
+
+    for (; reader.next(record); offset = reader.getOffset(), ++ordinal) {
+        if (record.type == storage::RecordType::FRAME) {
+            if (index.getPoints().empty() || record.receivedNs - lastPointNs >= intervalNs_) {
+                addPoint(index, record.receivedNs, offset, ordinal);
+                lastPointNs = record.receivedNs;
+            }
+            applyRecord(record);
+        } else if (record.type == storage::RecordType::BOOK_KEYFRAMES) {
+            // Decoding can start at the record itself; only the sequence numbers are needed
+            index.addPoint(record.receivedNs, offset, ordinal, nullptr, 0);
+            decoder.reset();
+            const auto* in = reinterpret_cast<const uint8_t*>(record.payload.data());
+            const uint8_t* end = in + record.payload.size();
+            while (in && in < end) {
+                in = decoder.decode(in, end, frame);
+                const storage::BookStreamInfo* info = in ? decoder.getStream(frame.stream) : nullptr;
+                if (info && frame.seqId >= 0) {
+                    index.addSequence(info->route, frame.seqId);
+                }
+            }
+        }
+    }
+
+    index.finish();
+    if (save && !index.save(segments_[segment])) {
+        core::Logger::getInstance().warn("Could not save the index of {}", segments_[segment]);
+    }
+    ++built_;
+}
+
+void JournalIndexer::catchUp(size_t segment) {
+    books_.clear();
+    const auto& points = indexes_[segment].getPoints();
+    if (points.empty()) {
+        return;
+    }
+
+    const storage::IndexPoint& last = points.back();
+    storage::BookDecoder decoder;
+    storage::BookFrame frame;
+    const uint8_t* in = indexes_[segment].getKeyframes(last);
+    const uint8_t* end = in + last.keyframeBytes;
+    while (in && in < end) {
+        in = decoder.decode(in, end, frame);
+        const storage::BookStreamInfo* info = in ? decoder.getStream(frame.stream) : nullptr;
+        if (info) {
+            Book& book = books_[info->route];
+            book.info = *info;
+            book.synced = storage::applyFrame(frame, *info, *book.orderBook);
+        }
+    }
+
+    storage::JournalReader reader;
+    if (!reader.open(segments_[segment]) || !reader.seek(last.offset)) {
+        return;
+    }
+    storage::JournalRecord record;
+    while (reader.next(record)) {
+        applyRecord(record);
+    }
+}
+
+void JournalIndexer::applyRecord(const storage::JournalRecord& record) {
+    if (record.type != storage::RecordType::FRAME) {
+        return;
+    }
+
+    payload_.assign(record.payload.data(), record.payload.size());
+    if (decodeMarketData(payload_, update_) != MessageKind::BOOK) {
+        return;
+    }
+
+    Book& book = books_[update_.route];
+    book.info = {update_.route, update_.exchange, update_.symbol, update_.channel};
+    if (update_.snapshot) {
+        book.orderBook->update(update_.exchange, update_.symbol, update_.bids, update_.asks,
+                               update_.timestamp, update_.seqId);
+        book.synced = true;
+    } else if (!book.orderBook->applyDelta(update_.bids, update_.asks, update_.timestamp,
+                                           update_.prevSeqId, update_.seqId)) {
+        book.synced = false;
+    }
+}
+
+void JournalIndexer::addPoint(storage::JournalIndex& index, int64_t receivedNs, uint64_t offset, uint64_t record) {
+    // Keyframes stand alone, so the encoder starts afresh for every point
+    keyframes_.clear();
+    sequences_.clear();
+    encoder_.reset();
+    for (const auto& [route, book] : books_) {
+        if (!book.synced) {
+            continue;
+        }
+        book.orderBook->getTopLevels(std::numeric_limits<size_t>::max(), bids_, asks_);
+        int64_t exchangeMs = core::utils::systemClockNanos(book.orderBook->getTimestamp()) / 1000000;
+        int64_t seqId = book.orderBook->getSequenceId();
+        if (encoder_.encodeKeyframe(book.info, receivedNs, exchangeMs, seqId, bids_, asks_, keyframes_) &&
+            seqId >= 0) {
+            sequences_.emplace_back(route, seqId);
+        }
+    }
+
+    index.addPoint(receivedNs, offset, record, keyframes_.data(), keyframes_.size());
+    for (const auto& [route, seqId] : sequences_) {
+        index.addSequence(route, seqId);
+    }
+}
+
+void JournalIndexer::toSeekPoint(size_t segment, const storage::IndexPoint& indexPoint, SeekPoint& point) const {
+    point.segment = segment;
+    point.offset = indexPoint.offset;
+    point.receivedNs = indexPoint.receivedNs;
+    point.keyframes = indexes_[segment].getKeyframes(indexPoint);
+    point.keyframeBytes = indexPoint.keyframeBytes;
+}
+
+} // namespace processing
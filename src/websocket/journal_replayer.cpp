@@ -0,0 +1,282 @@
+#include "websocket/journal_replayer.h"
+#include "storage/book_codec.h"
+#include "storage/journal_reader.h"
+#include "core/logger.h"
+#include "core/utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unordered_set>
+
+namespace processing {
+
+JournalReplayer::JournalReplayer(std::shared_ptr<MessageProcessor> processor)
+    : processor_(processor) {
+}
+
+ReplayStats JournalReplayer::replay(const std::vector<std::string>& segments, double speed, int64_t fromWallNs) {
+    ReplayStats stats;
+    stopRequested_ = false;
+    fed_ = 0;
+
+    const uint64_t baseline = settledCount();
+    const uint64_t droppedBaseline = processor_->getDroppedCount();
+    int64_t firstWallNs = 0;
+    int64_t lastWallNs = 0;
+    int64_t startNs = 0;
+    bool clockStarted = false;
+
+    // Compacted journals: one decoder for the whole replay, as frames delta against earlier blocks
+    storage::BookDecoder books;
+    storage::BookFrame frame;
+    std::string message;
+    std::unordered_set<uint64_t> fedRoutes;
+
+    // Catches up to fromWallNs unpaced, then paces on wall time: segments from
+    // different runs or boots have unrelated steady clocks
+    auto play = [&](std::string_view payload, uint32_t session, uint32_t line, int64_t wallNs, size_t bytes) {
+        // The decode stage moves the clock on as it applies each frame
+        if (!clockStarted) {
+            clockStarted = true;
+            core::utils::setVirtualTime(std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(wallNs))));
+        }
+
+        // Between the index point and the start time: only the books matter
+        if (wallNs < fromWallNs) {
+            waitForPipeline(baseline + fed_, kMaxInFlight);
+            feed(payload, session, line, wallNs);
+            ++stats.caughtUp;
+            return;
+        }
+
+        if (startNs == 0) {
+            firstWallNs = wallNs;
+            startNs = core::utils::steadyClockNanos();
+        }
+        if (speed > 0.0) {
+            waitUntil(startNs + static_cast<int64_t>((wallNs - firstWallNs) / speed));
+        }
+        waitForPipeline(baseline + fed_, kMaxInFlight);
+        lastWallNs = wallNs;
+
+        feed(payload, session, line, wallNs);
+        ++stats.messages;
+        stats.bytes += bytes;
+    };
+
+    size_t firstSegment = 0;
+    uint64_t firstOffset = 0;
+    if (fromWallNs > 0) {
+        int64_t seekStartNs = core::utils::steadyClockNanos();
+        JournalIndexer indexer;
+        SeekPoint point;
+        if (indexer.open(segments) && indexer.seekTime(fromWallNs, point)) {
+            firstSegment = point.segment;
+            firstOffset = point.offset;
+            stats.keyframes = seedBooks(point, baseline);
+        }
+        stats.seekSeconds = (core::utils::steadyClockNanos() - seekStartNs) / 1e9;
+    }
+
+    for (size_t i = firstSegment; i < segments.size() && !stopRequested_; ++i) {
+        storage::JournalReader reader;
+        if (!reader.open(segments[i])) {
+            continue;
+        }
+        if (i == firstSegment && firstOffset > 0 && !reader.seek(firstOffset)) {
+            core::Logger::getInstance().warn("Index offset {} is outside {}", firstOffset, segments[i]);
+        }
+        const int64_t steadyToWallNs = reader.getHeader().steadyToWallNs;
+
+        storage::JournalRecord record;
+        while (!stopRequested_ && reader.next(record)) {
+            if (record.type == storage::RecordType::FRAME) {
+                play(record.payload, record.session, record.line, record.receivedNs + steadyToWallNs,
+                     record.payload.size());
+                continue;
+            }
+            if (record.type != storage::RecordType::BOOK_BLOCK && record.type != storage::RecordType::BOOK_KEYFRAMES) {
+                continue;
+            }
+
+            // Encoded frames go through the pipeline as the feed messages they were compacted from
+            const bool keyframes = record.type == storage::RecordType::BOOK_KEYFRAMES;
+            const auto* in = reinterpret_cast<const uint8_t*>(record.payload.data());
+            const uint8_t* end = in + record.payload.size();
+            while (!stopRequested_ && in && in < end) {
+                const uint8_t* frameStart = in;
+                in = books.decode(in, end, frame);
+                const storage::BookStreamInfo* info = in ? books.getStream(frame.stream) : nullptr;
+                if (!info) {
+                    continue; // delta of a book whose keyframe is before the start point
+                }
+
+                // Keyframe blocks only seed books the replay has not reached yet
+                bool known = !fedRoutes.insert(info->route).second;
+                if (keyframes && known) {
+                    continue;
+                }
+                if (!renderFrame(frame, *info, message)) {
+                    continue;
+                }
+                if (keyframes) {
+                    waitForPipeline(baseline + fed_, kMaxInFlight);
+                    feed(message, 0, 0, frame.receivedNs + steadyToWallNs);
+                    ++stats.keyframes;
+                    continue;
+                }
+                play(message, 0, 0, frame.receivedNs + steadyToWallNs, static_cast<size_t>(in - frameStart));
+            }
+            if (!in) {
+                core::Logger::getInstance().warn("Corrupt book block at offset {} of {}",
+                                                 reader.getOffset(), segments[i]);
+            }
+        }
+    }
+
+    // Done once the last frame has been applied
+    waitForPipeline(baseline + fed_, 0);
+    core::utils::clearVirtualTime();
+    stats.dropped = processor_->getDroppedCount() - droppedBaseline;
+
+    if (startNs != 0) {
+        stats.wallSeconds = (core::utils::steadyClockNanos() - startNs) / 1e9;
+        stats.capturedSeconds = (lastWallNs - firstWallNs) / 1e9;
+    }
+    if (stats.wallSeconds > 0.0) {
+        stats.messagesPerSecond = stats.messages / stats.wallSeconds;
+        stats.megabytesPerSecond = stats.bytes / (1024.0 * 1024.0) / stats.wallSeconds;
+    }
+
+    if (fromWallNs > 0) {
+        core::Logger::getInstance().info("Seeked in {:.3f} s: {} books from keyframes, {} frames to catch up",
+            stats.seekSeconds, stats.keyframes, stats.caughtUp);
+    }
+    core::Logger::getInstance().info("Replayed {} frames in {:.2f} s ({:.0f} msg/s, {:.1f} MB/s)",
+        stats.messages, stats.wallSeconds, stats.messagesPerSecond, stats.megabytesPerSecond);
+    if (stats.dropped > 0) {
+        core::Logger::getInstance().warn("{} replayed frames dropped by a full decode queue", stats.dropped);
+    }
+    return stats;
+}
+
+void JournalReplayer::stop() {
+    stopRequested_ = true;
+}
+
+double JournalReplayer::parseSpeed(const std::string& name) {
+    if (name == "max") {
+        return 0.0;
+    }
+    if (name == "realtime") {
+        return 1.0;
+    }
+
+    char* end = nullptr;
+    double speed = std::strtod(name.c_str(), &end);
+    if (end == name.c_str() || speed <= 0.0 || (*end != '\0' && std::string(end) != "x")) {
+        return -1.0;
+    }
+    return speed;
+}
+
+uint64_t JournalReplayer::seedBooks(const SeekPoint& point, uint64_t baseline) {
+    storage::BookDecoder decoder;
+    storage::BookFrame frame;
+    std::string message;
+    uint64_t books = 0;
+
+    const uint8_t* in = point.keyframes;
+    const uint8_t* end = in + point.keyframeBytes;
+    while (in && in < end) {
+        in = decoder.decode(in, end, frame);
+        const storage::BookStreamInfo* info = in ? decoder.getStream(frame.stream) : nullptr;
+        if (!info || !renderFrame(frame, *info, message)) {
+            continue;
+        }
+
+        waitForPipeline(baseline + fed_, kMaxInFlight);
+        feed(message, 0, 0);
+        ++books;
+    }
+    return books;
+}
+
+bool JournalReplayer::renderFrame(const storage::BookFrame& frame, const storage::BookStreamInfo& info,
+                                  std::string& message) {
+    // Rendered as the feed would send it, so the books are built by the pipeline itself
+    auto appendLevels = [&message](const core::PriceLevels& levels, const char* suffix) {
+        char buf[96];
+        for (size_t i = 0; i < levels.size(); ++i) {
+            int priceDecimals = std::max(0, storage::exactDecimals(levels[i].price));
+            int sizeDecimals = std::max(0, storage::exactDecimals(levels[i].quantity));
+            std::snprintf(buf, sizeof(buf), "%s[\"%.*f\",\"%.*f\"%s]", i ? "," : "",
+                          priceDecimals, levels[i].price, sizeDecimals, levels[i].quantity, suffix);
+            message += buf;
+        }
+    };
+
+    if (!info.channel.empty()) {
+        message = "{\"arg\":{\"channel\":\"" + info.channel + "\",\"instId\":\"" + info.symbol +
+                  "\"},\"action\":\"" + (frame.isSnapshot() ? "snapshot" : "update") + "\",\"data\":[{\"asks\":[";
+        appendLevels(frame.asks, ",\"0\",\"0\"");
+        message += "],\"bids\":[";
+        appendLevels(frame.bids, ",\"0\",\"0\"");
+        message += "],\"ts\":\"" + std::to_string(frame.exchangeMs) + "\",\"prevSeqId\":" +
+                   std::to_string(frame.isSnapshot() ? -1 : frame.prevSeqId) + ",\"seqId\":" +
+                   std::to_string(frame.seqId) + "}]}";
+        return true;
+    }
+
+    // The simulated feed only sends whole books
+    if (!frame.isSnapshot()) {
+        return false;
+    }
+    std::chrono::system_clock::time_point timestamp{std::chrono::milliseconds(frame.exchangeMs)};
+    message = "{\"exchange\":\"" + info.exchange + "\",\"symbol\":\"" + info.symbol +
+              "\",\"timestamp\":\"" + core::utils::formatTimestamp(timestamp) + "\",\"asks\":[";
+    appendLevels(frame.asks, "");
+    message += "],\"bids\":[";
+    appendLevels(frame.bids, "");
+    message += "]}";
+    return true;
+}
+
+void JournalReplayer::feed(std::string_view payload, uint32_t session, uint32_t line, int64_t wallNs) {
+    std::string buffer = processor_->acquireBuffer();
+    buffer.assign(payload.data(), payload.size());
+    while (!processor_->enqueue(WebSocketMessage{std::move(buffer), session, 0, line, wallNs})) {
+        std::this_thread::yield();
+    }
+    ++fed_;
+}
+
+void JournalReplayer::waitUntil(int64_t steadyNs) const {
+    // Sleep most of the gap, spin the rest; sleeps overshoot by tens of microseconds
+    constexpr int64_t kSpinNs = 200000;
+    int64_t remaining = steadyNs - core::utils::steadyClockNanos();
+    if (remaining > kSpinNs) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - kSpinNs));
+    }
+    while (!stopRequested_ && core::utils::steadyClockNanos() < steadyNs) {
+    }
+}
+
+uint64_t JournalReplayer::settledCount() const {
+    return processor_->getFrameCount() + processor_->getDroppedCount();
+}
+
+void JournalReplayer::waitForPipeline(uint64_t target, uint64_t maxBehind) const {
+    // Dropped frames count too, or one lost frame would stall the replay for good
+    while (settledCount() + maxBehind < target) {
+        if (stopRequested_ && maxBehind == 0) {
+            return; // do not wait out a long queue after stop()
+        }
+        std::this_thread::yield();
+    }
+}
+
+} // namespace processing
@@ -0,0 +1,145 @@
+#include "websocket/market_data_decoder.h"
+#include "core/logger.h"
+#include "core/utils.h"
+#include <chrono>
+#include <nlohmann/json.hpp>
+
+namespace processing {
+
+namespace {
+
+std::string_view findStringField(std::string_view payload, std::string_view key) {
+    size_t pos = payload.find(key);
+    while (pos != std::string_view::npos) {
+        size_t i = pos + key.size();
+
+        // Skip whitespace and the colon between key and value
+        while (i < payload.size() && (payload[i] == ' ' || payload[i] == ':' || payload[i] == '\t')) {
+            ++i;
+        }
+
+        if (i < payload.size() && payload[i] == '"') {
+            size_t valueStart = i + 1;
+            size_t valueEnd = payload.find('"', valueStart);
+            if (valueEnd != std::string_view::npos) {
+                return payload.substr(valueStart, valueEnd - valueStart);
+            }
+        }
+
+        pos = payload.find(key, pos + key.size());
+    }
+    return {};
+}
+
+void decodeLevels(const nlohmann::json& levels, std::vector<std::pair<std::string, std::string>>& out) {
+    out.clear();
+    if (!levels.is_array()) {
+        return;
+    }
+
+    out.reserve(levels.size());
+    for (const auto& level : levels) {
+        if (level.is_array() && level.size() >= 2) {
+            out.emplace_back(level[0].get<std::string>(), level[1].get<std::string>());
+        }
+    }
+}
+
+uint64_t fnv1a(std::string_view text, uint64_t hash = 14695981039346656037ULL) {
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int64_t parseSequence(const nlohmann::json& entry, const char* key) {
+    auto it = entry.find(key);
+    return it != entry.end() && it->is_number_integer() ? it->get<int64_t>() : -1;
+}
+
+// OKX native push: {"arg":{"channel":..,"instId":..},"action":..,"data":[{..}]}
+MessageKind decodeOkxPush(const nlohmann::json& json, BookUpdate& update) {
+    const auto& arg = json["arg"];
+    update.channel = arg.value("channel", "");
+    update.symbol = arg.value("instId", "");
+    if (update.channel == "trades") {
+        return MessageKind::TRADES;
+    }
+
+    const auto& data = json["data"];
+    if (!data.is_array() || data.empty()) {
+        return MessageKind::UNKNOWN;
+    }
+
+    // books sends a snapshot then deltas; books5 and bbo-tbt are always snapshots
+    const auto& entry = data[0];
+    update.exchange = "OKX";
+    update.snapshot = json.value("action", "snapshot") != "update";
+    update.seqId = parseSequence(entry, "seqId");
+    update.prevSeqId = parseSequence(entry, "prevSeqId");
+    update.route = routeKey(update.channel, update.symbol);
+
+    std::string ts = entry.value("ts", "");
+    int64_t ms = ts.empty() ? 0 : std::stoll(ts);
+    update.timestamp = core::utils::formatTimestamp(
+        std::chrono::system_clock::time_point(std::chrono::milliseconds(ms)));
+
+    decodeLevels(entry["bids"], update.bids);
+    decodeLevels(entry["asks"], update.asks);
+    return MessageKind::BOOK;
+}
+
+} // namespace
+
+uint64_t routeKey(std::string_view channel, std::string_view instrument) {
+    // Separator byte keeps ("ab","c") and ("a","bc") apart
+    return fnv1a(instrument, fnv1a(channel) ^ 0xff);
+}
+
+std::string_view extractInstrumentId(std::string_view payload) {
+    std::string_view symbol = findStringField(payload, "\"symbol\"");
+    return symbol.empty() ? findStringField(payload, "\"instId\"") : symbol;
+}
+
+MessageKind decodeMarketData(const std::string& payload, BookUpdate& update) {
+    try {
+        auto json = nlohmann::json::parse(payload);
+        if (!json.is_object()) {
+            return MessageKind::UNKNOWN;
+        }
+
+        if (json.contains("event")) {
+            return MessageKind::EVENT;
+        }
+
+        if (json.contains("arg") && json.contains("data")) {
+            return decodeOkxPush(json, update);
+        }
+
+        if (!json.contains("symbol")) {
+            return MessageKind::UNKNOWN;
+        }
+
+        update.exchange = json.value("exchange", "");
+        update.symbol = json["symbol"].get<std::string>();
+        update.channel.clear();
+        update.timestamp = json.value("timestamp", "");
+        update.route = routeKey({}, update.symbol);
+        update.snapshot = true;
+        update.seqId = -1;
+        update.prevSeqId = -1;
+        decodeLevels(json["bids"], update.bids);
+        decodeLevels(json["asks"], update.asks);
+        return MessageKind::BOOK;
+    } catch (const std::exception& e) {
+        core::Logger::getInstance().warn("Failed to decode order book message: {}", e.what());
+        return MessageKind::UNKNOWN;
+    }
+}
+
+bool decodeBookUpdate(const std::string& payload, BookUpdate& update) {
+    return decodeMarketData(payload, update) == MessageKind::BOOK;
+}
+
+} // namespace processing
@@ -1,51 +1,290 @@
 #include "websocket/message_processor.h"
 #include "core/logger.h"
+#include "core/utils.h"
 #include <iostream>
 
 namespace processing {
 
-MessageProcessor::MessageProcessor() : queue_(100000) {} // Queue size of 100k messages
+namespace {
+
+// The SPSC ring takes one producer thread. Several I/O threads or feed
+// sessions (extra endpoints, A/B lines) may each enqueue, so such configs
+// get the MPMC queue whatever performance.queue_type says.
+MessageProcessor::QueueType queueTypeFor(const core::Config& config) {
+    MessageProcessor::QueueType type = MessageProcessor::parseQueueType(config.getQueueType());
+    if (type != MessageProcessor::QueueType::SPSC) {
+        return type;
+    }
+
+    int ioThreads = config.getIoThreads();
+    size_t sessions = config.getWebSocketEndpoints().size();
+    if (ioThreads > 1 || sessions > 1) {
+        core::Logger::getInstance().warn(
+            "spsc queue needs a single producer but the feed has {} I/O threads and {} sessions; using mpmc",
+            ioThreads, sessions);
+        return MessageProcessor::QueueType::MPMC;
+    }
+    return type;
+}
+
+} // namespace
+
+MessageProcessor::MessageProcessor(int processingThreads, QueueType queueType,
+                                   WaitStrategy::Type waitStrategy, int spinIterations)
+    : queueType_(queueType),
+      decodeStage_(std::make_unique<DecodeStage>(processingThreads, waitStrategy, spinIterations)),
+      waitStrategy_(waitStrategy, spinIterations),
+      processingThreads_(processingThreads) {
+    decodeStage_->setBufferPool(&bufferPool_);
+
+    if (queueType_ == QueueType::SPSC) {
+        ring_ = std::make_unique<SpscRing<WebSocketMessage>>(kQueueCapacity);
+    } else {
+        queue_ = std::make_unique<moodycamel::ConcurrentQueue<WebSocketMessage>>(kQueueCapacity);
+    }
+}
+
+MessageProcessor::MessageProcessor(std::shared_ptr<core::Config> config)
+    : MessageProcessor(config->getProcessingThreads(),
+                       queueTypeFor(*config),
+                       WaitStrategy::parseType(config->getWaitStrategy()),
+                       config->getSpinIterations()) {
+    decodeStage_->setLatencyTracking(config->isMeasureLatencyEnabled());
+    decodeStage_->setArbitration(config->isArbitrationEnabled());
+    if (config->isCaptureEnabled()) {
+        enableCapture(config->getCaptureDirectory(), config->getCaptureSegmentBytes());
+    }
+}
 
 MessageProcessor::~MessageProcessor() {
     stop();
 }
 
 void MessageProcessor::start() {
+    if (running_) {
+        return;
+    }
+
     running_ = true;
-    // processor_thread_ = std::thread(&MessageProcessor::processMessages, this);
+
+    if (recorder_ && !recorder_->start()) {
+        core::Logger::getInstance().error("Feed capture disabled: journal could not be opened");
+        recorder_.reset();
+    }
+
+    // With a single processing thread the dispatcher decodes inline,
+    // avoiding a second queue hop
+    if (processingThreads_ > 1) {
+        decodeStage_->start();
+    }
+    processor_thread_ = std::thread(&MessageProcessor::processMessages, this);
 }
 
 void MessageProcessor::stop() {
     running_ = false;
-    // if (processor_thread_.joinable()) {
-    //     processor_thread_.join();
-    // }
+    waitStrategy_.notify();
+    if (processor_thread_.joinable()) {
+        processor_thread_.join();
+    }
+    decodeStage_->stop();
+    if (recorder_) {
+        recorder_->stop();
+    }
+    producer_.store(std::thread::id(), std::memory_order_relaxed);
+}
+
+bool MessageProcessor::enqueue(const std::string& message, uint32_t session, int64_t receivedNs) {
+    if (receivedNs == 0) {
+        receivedNs = core::utils::steadyClockNanos();
+    }
+    std::string buffer = bufferPool_.acquire();
+    buffer.assign(message);
+    return enqueue(std::move(buffer), session, receivedNs);
+}
+
+bool MessageProcessor::enqueue(std::string&& message, uint32_t session, int64_t receivedNs) {
+    if (receivedNs == 0) {
+        receivedNs = core::utils::steadyClockNanos();
+    }
+    return enqueue(WebSocketMessage{std::move(message), session, receivedNs});
 }
 
-bool MessageProcessor::enqueue(const std::string& message) {
-    WebSocketMessage msg{message};
-    return queue_.try_enqueue(msg);
+bool MessageProcessor::enqueue(WebSocketMessage&& msg) {
+    if (msg.receivedNs == 0) {
+        msg.receivedNs = core::utils::steadyClockNanos();
+    }
+    if (ring_ && !ownsProducerSide()) {
+        return false;
+    }
+    bool enqueued = ring_ ? ring_->try_enqueue(std::move(msg)) : queue_->try_enqueue(std::move(msg));
+    if (enqueued) {
+        waitStrategy_.notify();
+    }
+    return enqueued;
+}
+
+bool MessageProcessor::ownsProducerSide() {
+    std::thread::id self = std::this_thread::get_id();
+    std::thread::id owner = producer_.load(std::memory_order_relaxed);
+    if (owner == self) {
+        return true;
+    }
+    if (owner == std::thread::id() && producer_.compare_exchange_strong(owner, self)) {
+        return true;
+    }
+
+    // A second producer would corrupt the ring; drop its frames instead
+    if (!producerViolation_.exchange(true)) {
+        core::Logger::getInstance().error("spsc queue enqueued from a second thread; its frames are dropped, use mpmc");
+    }
+    return false;
+}
+
+std::string MessageProcessor::acquireBuffer() {
+    return bufferPool_.acquire();
 }
 
 WebSocketMessage MessageProcessor::dequeue() {
     WebSocketMessage msg;
-    queue_.try_dequeue(msg);
+    if (ring_) {
+        ring_->try_dequeue(msg);
+    } else {
+        queue_->try_dequeue(msg);
+    }
     return msg;
 }   
 
+size_t MessageProcessor::try_dequeue_bulk(MessageBatch& batch) {
+    if (ring_) {
+        batch.count = ring_->try_dequeue_bulk(batch.messages.begin(), batch.capacity());
+    } else {
+        batch.count = queue_->try_dequeue_bulk(batch.messages.begin(), batch.capacity());
+    }
+    return batch.count;
+}
+
+void MessageProcessor::registerOrderBook(const std::string& symbol, std::shared_ptr<core::OrderBook> orderBook) {
+    decodeStage_->registerOrderBook(symbol, orderBook);
+}
+
+void MessageProcessor::registerOrderBook(const std::string& channel, const std::string& instrument,
+                                         std::shared_ptr<core::OrderBook> orderBook) {
+    decodeStage_->registerOrderBook(channel, instrument, orderBook);
+}
+
+std::shared_ptr<core::OrderBook> MessageProcessor::getOrderBook(const std::string& symbol) const {
+    return decodeStage_->getOrderBook(symbol);
+}
+
+std::shared_ptr<core::OrderBook> MessageProcessor::getOrderBook(const std::string& channel, const std::string& instrument) const {
+    return decodeStage_->getOrderBook(channel, instrument);
+}
+
+void MessageProcessor::setControlHandler(ControlHandler handler) {
+    decodeStage_->setControlHandler(handler);
+}
+
+void MessageProcessor::setGapHandler(GapHandler handler) {
+    decodeStage_->setGapHandler(handler);
+}
+
+uint64_t MessageProcessor::getSequenceGapCount() const {
+    return decodeStage_->getSequenceGapCount();
+}
+
+void MessageProcessor::setBookUpdateHandler(BookUpdateHandler handler) {
+    decodeStage_->setBookUpdateHandler(handler);
+}
+
+void MessageProcessor::beginResync(uint32_t line, uint32_t session, double budgetMs) {
+    decodeStage_->beginResync(line, session, budgetMs);
+}
+
+double MessageProcessor::getLastResyncMs() const {
+    return decodeStage_->getLastResyncMs();
+}
+
+FeedLatency MessageProcessor::getFeedLatency() const {
+    return decodeStage_->getFeedLatency();
+}
+
+void MessageProcessor::resetFeedLatency() {
+    decodeStage_->resetFeedLatency();
+}
+
+void MessageProcessor::setArbitration(bool enabled) {
+    decodeStage_->setArbitration(enabled);
+}
+
+ArbitrationSummary MessageProcessor::getArbitrationSummary() const {
+    return decodeStage_->getArbitrationSummary();
+}
+
+void MessageProcessor::enableCapture(const std::string& directory, size_t segmentBytes) {
+    recorder_ = std::make_unique<FeedRecorder>(directory, segmentBytes);
+}
+
+CaptureStats MessageProcessor::getCaptureStats() const {
+    return recorder_ ? recorder_->getStats() : CaptureStats{};
+}
+
+uint64_t MessageProcessor::getProcessedCount() const {
+    return decodeStage_->getProcessedCount();
+}
+
+uint64_t MessageProcessor::getFrameCount() const {
+    return decodeStage_->getFrameCount();
+}
+
+uint64_t MessageProcessor::getDroppedCount() const {
+    return decodeStage_->getDroppedCount();
+}
+
+MessageProcessor::QueueType MessageProcessor::getQueueType() const {
+    return queueType_;
+}
+
+WaitStrategy::Type MessageProcessor::getWaitStrategy() const {
+    return waitStrategy_.getType();
+}
+
+MessageProcessor::QueueType MessageProcessor::parseQueueType(const std::string& name) {
+    if (name == "spsc") {
+        return QueueType::SPSC;
+    }
+    if (name != "mpmc") {
+        core::Logger::getInstance().warn("Unknown queue type '{}', using mpmc", name);
+    }
+    return QueueType::MPMC;
+}
+
 void MessageProcessor::processMessages() {
-    WebSocketMessage msg;
     while (running_) {
-        if (queue_.try_dequeue(msg)) {
-            // Process the message here
-            core::Logger::getInstance().info("Processing message: {}", msg.data);
-            // Add your message processing logic here
-            // Example: Parse JSON, update market data, etc.
+        if (try_dequeue_bulk(batch_) > 0) {
+            waitStrategy_.reset();
+            // Copied before dispatch moves the frames out of the batch
+            if (recorder_) {
+                recorder_->capture(batch_);
+            }
+            if (processingThreads_ > 1) {
+                // Single dispatcher preserves per-symbol ordering into the worker queues
+                size_t dispatched = decodeStage_->dispatchBatch(batch_);
+                if (dispatched < batch_.count) {
+                    core::Logger::getInstance().warn("Decode stage queue full, dropped {} messages",
+                        batch_.count - dispatched);
+                }
+            } else {
+                // Decode all, apply all, then notify once per book
+                decodeStage_->processInline(batch_);
+            }
+        } else {
+            waitStrategy_.idle([this]() { return pendingCount() > 0 || !running_; });
         }
-
-        // Optional: Small sleep to prevent busy-waiting
-        // std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
 }
 
-} // namespace processing
\ No newline at end of file
+size_t MessageProcessor::pendingCount() const {
+    return ring_ ? ring_->size_approx() : queue_->size_approx();
+}
+
+} // namespace processing
@@ -0,0 +1,104 @@
+#include "websocket/socket_tuning.h"
+#include "core/logger.h"
+#include "core/utils.h"
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+namespace websocket {
+
+namespace {
+
+#ifdef __linux__
+bool setOption(int fd, int level, int name, int value, const char* label) {
+    if (setsockopt(fd, level, name, &value, sizeof(value)) != 0) {
+        core::Logger::getInstance().warn("Could not set {} on feed socket", label);
+        return false;
+    }
+    return true;
+}
+
+int getOption(int fd, int level, int name) {
+    int value = 0;
+    socklen_t length = sizeof(value);
+    return getsockopt(fd, level, name, &value, &length) == 0 ? value : -1;
+}
+#endif
+
+} // namespace
+
+std::string applySocketTuning(boost::asio::ip::tcp::socket& socket, const core::SocketTuning& tuning) {
+#ifdef __linux__
+    int fd = socket.native_handle();
+
+    if (tuning.receiveBufferBytes > 0) {
+        setOption(fd, SOL_SOCKET, SO_RCVBUF, tuning.receiveBufferBytes, "SO_RCVBUF");
+    }
+    setOption(fd, IPPROTO_TCP, TCP_NODELAY, tuning.tcpNoDelay ? 1 : 0, "TCP_NODELAY");
+#ifdef SO_BUSY_POLL
+    if (tuning.busyPollUs > 0) {
+        setOption(fd, SOL_SOCKET, SO_BUSY_POLL, tuning.busyPollUs, "SO_BUSY_POLL");
+    }
+#endif
+    if (tuning.quickAck) {
+        setOption(fd, IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK");
+    }
+
+    std::string applied = "rcvbuf=" + std::to_string(getOption(fd, SOL_SOCKET, SO_RCVBUF)) +
+                          " nodelay=" + std::to_string(getOption(fd, IPPROTO_TCP, TCP_NODELAY));
+#ifdef SO_BUSY_POLL
+    applied += " busy_poll_us=" + std::to_string(getOption(fd, SOL_SOCKET, SO_BUSY_POLL));
+#endif
+    applied += std::string(" quick_ack=") + (tuning.quickAck ? "1" : "0");
+    return applied;
+#else
+    // Only the portable options are available here
+    boost::system::error_code ec;
+    if (tuning.receiveBufferBytes > 0) {
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(tuning.receiveBufferBytes), ec);
+    }
+    socket.set_option(boost::asio::ip::tcp::no_delay(tuning.tcpNoDelay), ec);
+
+    boost::asio::socket_base::receive_buffer_size rcvbuf;
+    socket.get_option(rcvbuf, ec);
+    return "rcvbuf=" + std::to_string(rcvbuf.value()) + " nodelay=" + (tuning.tcpNoDelay ? "1" : "0");
+#endif
+}
+
+void rearmQuickAck(boost::asio::ip::tcp::socket& socket) {
+#ifdef __linux__
+    int one = 1;
+    setsockopt(socket.native_handle(), IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+#else
+    (void)socket;
+#endif
+}
+
+std::string applyIoThreadTuning(int cpu, const std::string& policy, int priority) {
+    std::string applied;
+    if (cpu >= 0) {
+        if (core::utils::setCurrentThreadAffinity(cpu)) {
+            applied = "cpu=" + std::to_string(cpu);
+        } else {
+            core::Logger::getInstance().warn("Could not pin feed I/O thread to CPU {}", cpu);
+            applied = "cpu=any";
+        }
+    }
+
+    if (core::utils::setCurrentThreadScheduling(policy, priority)) {
+        applied += (applied.empty() ? "" : " ") + std::string("policy=") + policy;
+        if (policy != "other") {
+            applied += " priority=" + std::to_string(priority);
+        }
+    } else {
+        // Real-time policies need CAP_SYS_NICE
+        core::Logger::getInstance().warn("Could not set scheduling policy '{}' for feed I/O thread", policy);
+        applied += (applied.empty() ? "" : " ") + std::string("policy=other");
+    }
+    return applied;
+}
+
+} // namespace websocket
@@ -0,0 +1,184 @@
+#include "websocket/subscription_manager.h"
+#include "core/logger.h"
+#include <nlohmann/json.hpp>
+
+namespace websocket {
+
+SubscriptionManager::SubscriptionManager(std::shared_ptr<WebSocketClient> client,
+                                         std::shared_ptr<processing::MessageProcessor> processor)
+    : client_(client), processor_(processor) {
+    client_->setReplayProvider([this]() { return replayRequests(); });
+    processor_->setControlHandler([this](const std::string& payload) { onEvent(payload); });
+    processor_->setGapHandler([this](const std::string& channel, const std::string& instrument) {
+        onSequenceGap(channel, instrument);
+    });
+}
+
+bool SubscriptionManager::add(Channel channel, const std::string& instrument) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [it, inserted] = subscriptions_.try_emplace(Key{channel, instrument});
+        if (!inserted && it->second.state != State::FAILED && it->second.state != State::UNSUBSCRIBING) {
+            return false;
+        }
+
+        Entry& entry = it->second;
+        entry.state = State::PENDING;
+        if (channel != Channel::TRADES && !entry.orderBook) {
+            entry.orderBook = std::make_shared<core::OrderBook>();
+            processor_->registerOrderBook(channelName(channel), instrument, entry.orderBook);
+        }
+    }
+
+    // Sent now if connected, otherwise covered by the replay on connect
+    if (client_->isConnected()) {
+        client_->send(request("subscribe", channel, instrument));
+    }
+    return true;
+}
+
+bool SubscriptionManager::remove(Channel channel, const std::string& instrument) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = subscriptions_.find(Key{channel, instrument});
+        if (it == subscriptions_.end() || it->second.state == State::UNSUBSCRIBING) {
+            return false;
+        }
+        it->second.state = State::UNSUBSCRIBING;
+    }
+
+    if (client_->isConnected()) {
+        client_->send(request("unsubscribe", channel, instrument));
+    }
+    return true;
+}
+
+std::vector<SubscriptionManager::Subscription> SubscriptionManager::getSubscriptions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Subscription> result;
+    result.reserve(subscriptions_.size());
+    for (const auto& [key, entry] : subscriptions_) {
+        result.push_back({key.first, key.second, entry.state});
+    }
+    return result;
+}
+
+bool SubscriptionManager::getState(Channel channel, const std::string& instrument, State& state) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscriptions_.find(Key{channel, instrument});
+    if (it == subscriptions_.end()) {
+        return false;
+    }
+    state = it->second.state;
+    return true;
+}
+
+std::shared_ptr<core::OrderBook> SubscriptionManager::getOrderBook(Channel channel, const std::string& instrument) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscriptions_.find(Key{channel, instrument});
+    return it != subscriptions_.end() ? it->second.orderBook : nullptr;
+}
+
+const char* SubscriptionManager::channelName(Channel channel) {
+    switch (channel) {
+        case Channel::BOOKS5:
+            return "books5";
+        case Channel::BBO_TBT:
+            return "bbo-tbt";
+        case Channel::TRADES:
+            return "trades";
+        case Channel::BOOKS:
+        default:
+            return "books";
+    }
+}
+
+bool SubscriptionManager::parseChannel(const std::string& name, Channel& channel) {
+    for (Channel candidate : {Channel::BOOKS, Channel::BOOKS5, Channel::BBO_TBT, Channel::TRADES}) {
+        if (name == channelName(candidate)) {
+            channel = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string SubscriptionManager::request(const char* op, Channel channel, const std::string& instrument) {
+    nlohmann::json arg = {{"channel", channelName(channel)}, {"instId", instrument}};
+    return nlohmann::json{{"op", op}, {"args", nlohmann::json::array({arg})}}.dump();
+}
+
+std::vector<std::string> SubscriptionManager::replayRequests() {
+    // A new connection starts with no subscriptions; ask again for everything still wanted
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> requests;
+    for (auto it = subscriptions_.begin(); it != subscriptions_.end();) {
+        if (it->second.state == State::UNSUBSCRIBING) {
+            it = subscriptions_.erase(it);
+            continue;
+        }
+        it->second.state = State::PENDING;
+        requests.push_back(request("subscribe", it->first.first, it->first.second));
+        ++it;
+    }
+    return requests;
+}
+
+void SubscriptionManager::onEvent(const std::string& payload) {
+    nlohmann::json event = nlohmann::json::parse(payload, nullptr, false);
+    if (!event.is_object()) {
+        return;
+    }
+
+    std::string type = event.value("event", "");
+    if (type == "error") {
+        // OKX errors carry no arg, so the failing request cannot be identified
+        core::Logger::getInstance().warn("Subscription error {}: {}", event.value("code", ""), event.value("msg", ""));
+        return;
+    }
+
+    if (!event.contains("arg")) {
+        return;
+    }
+
+    Channel channel;
+    const auto& arg = event["arg"];
+    if (!parseChannel(arg.value("channel", ""), channel)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscriptions_.find(Key{channel, arg.value("instId", "")});
+    if (it == subscriptions_.end()) {
+        return;
+    }
+
+    if (type == "subscribe" && it->second.state == State::PENDING) {
+        it->second.state = State::ACTIVE;
+    } else if (type == "unsubscribe" && it->second.state == State::UNSUBSCRIBING) {
+        subscriptions_.erase(it);
+    }
+}
+
+void SubscriptionManager::onSequenceGap(const std::string& channelName, const std::string& instrument) {
+    Channel channel;
+    if (!parseChannel(channelName, channel)) {
+        return;
+    }
+
+    {
+        // Every delta after a gap also fails; resubscribe only once
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = subscriptions_.find(Key{channel, instrument});
+        if (it == subscriptions_.end() || it->second.state != State::ACTIVE) {
+            return;
+        }
+        it->second.state = State::PENDING;
+    }
+
+    core::Logger::getInstance().warn("Resubscribing {} {} for a fresh snapshot", channelName, instrument);
+    client_->send(request("unsubscribe", channel, instrument));
+    client_->send(request("subscribe", channel, instrument));
+}
+
+} // namespace websocket
@@ -0,0 +1,85 @@
+#include "websocket/wait_strategy.h"
+#include "core/logger.h"
+#include <chrono>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+namespace processing {
+
+namespace {
+
+// Upper bound on a single park so a missed stop() can never hang a consumer
+constexpr long kMaxParkNs = 10 * 1000 * 1000;
+
+} // namespace
+
+WaitStrategy::WaitStrategy(Type type, int spinIterations)
+    : type_(type),
+      spinIterations_(spinIterations > 0 ? spinIterations : 1) {
+}
+
+WaitStrategy::Type WaitStrategy::getType() const {
+    return type_;
+}
+
+WaitStrategy::Type WaitStrategy::parseType(const std::string& name) {
+    if (name == "busy_spin") {
+        return Type::BUSY_SPIN;
+    }
+    if (name == "park") {
+        return Type::PARK;
+    }
+    if (name != "spin_yield") {
+        core::Logger::getInstance().warn("Unknown wait strategy '{}', using spin_yield", name);
+    }
+    return Type::SPIN_YIELD;
+}
+
+const char* WaitStrategy::typeName(Type type) {
+    switch (type) {
+        case Type::BUSY_SPIN:
+            return "busy_spin";
+        case Type::PARK:
+            return "park";
+        case Type::SPIN_YIELD:
+        default:
+            return "spin_yield";
+    }
+}
+
+#ifdef __linux__
+
+void WaitStrategy::park(uint32_t epoch) {
+    // Returns immediately if the producer bumped the epoch since we read it
+    timespec timeout{0, kMaxParkNs};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, &timeout, nullptr, 0);
+}
+
+void WaitStrategy::wake() {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+#else
+
+void WaitStrategy::park(uint32_t epoch) {
+    std::unique_lock<std::mutex> lock(parkMutex_);
+    parkCondition_.wait_for(lock, std::chrono::nanoseconds(kMaxParkNs), [this, epoch]() {
+        return epoch_.load(std::memory_order_acquire) != epoch;
+    });
+}
+
+void WaitStrategy::wake() {
+    {
+        std::lock_guard<std::mutex> lock(parkMutex_);
+    }
+    parkCondition_.notify_one();
+}
+
+#endif
+
+} // namespace processing
@@ -2,6 +2,7 @@
 #include "websocket/message_processor.h"
 
 #include "core/logger.h"
+#include "core/utils.h"
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/connect.hpp>
@@ -9,8 +10,11 @@
 #include <boost/beast/ssl.hpp>
 #include <boost/asio/ssl/error.hpp>
 #include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/strand.hpp>
 #include <iostream>
 #include <thread>
+#include <future>
+#include <algorithm>
 
 namespace websocket {
 
@@ -20,11 +24,38 @@ namespace net = boost::asio;
 namespace ssl = net::ssl;
 using tcp = net::ip::tcp;
 
+namespace {
+
+// Upper bound on subscriptions merged into one request frame
+constexpr size_t kMaxArgsPerRequest = 100;
+
+// First reconnect attempt fires within this many milliseconds
+constexpr int kInitialBackoffMs = 100;
+
+// Sized for a full-depth L2 frame so steady-state reads never reallocate
+constexpr std::size_t kReadBufferCapacity = 256 * 1024;
+
+} // namespace
+
 WebSocketClient::WebSocketClient(std::shared_ptr<core::Config> config, std::shared_ptr<processing::MessageProcessor> msgProcessor)
-    : config_(config), connected_(false), processor_(msgProcessor)
+    : config_(config), processor_(msgProcessor), connected_(false), jitter_(std::random_device{}())
 {
     // Parse WebSocket URL from config
-    std::string url = config_->getWebSocketEndpoint();
+    parseEndpoint(config_->getWebSocketEndpoint());
+    socketTuning_ = config_->getSocketTuning();
+}
+
+WebSocketClient::WebSocketClient(std::shared_ptr<core::Config> config,
+                                 std::shared_ptr<processing::MessageProcessor> msgProcessor,
+                                 net::io_context& ioc,
+                                 const std::string& endpoint)
+    : config_(config), ioc_(&ioc), processor_(msgProcessor), connected_(false), jitter_(std::random_device{}())
+{
+    parseEndpoint(endpoint);
+    socketTuning_ = config_->getSocketTuning();
+}
+
+void WebSocketClient::parseEndpoint(const std::string& url) {
     size_t protocolEnd = url.find("://");
     if (protocolEnd == std::string::npos) {
         throw std::runtime_error("Invalid WebSocket URL format");
@@ -36,10 +67,21 @@ WebSocketClient::WebSocketClient(std::shared_ptr<core::Config> config, std::shar
         pathStart = url.length();
     }
 
+    // ws:// is plain TCP (local mock server, test rigs); anything else is TLS
+    std::string scheme = url.substr(0, protocolEnd);
+    secure_ = scheme != "ws";
+
+    endpoint_ = url;
     host_ = url.substr(hostStart, pathStart - hostStart);
-    path_ = url.substr(pathStart);
-    port_ = "443"; // Default to secure WebSocket port
+    path_ = pathStart < url.length() ? url.substr(pathStart) : "/";
+    port_ = secure_ ? "443" : "80";
 
+    // Explicit port, e.g. ws://127.0.0.1:9443/ws
+    size_t portStart = host_.rfind(':');
+    if (portStart != std::string::npos) {
+        port_ = host_.substr(portStart + 1);
+        host_ = host_.substr(0, portStart);
+    }
 }
 
 WebSocketClient::~WebSocketClient() {
@@ -47,45 +89,49 @@ WebSocketClient::~WebSocketClient() {
 }
 
 bool WebSocketClient::connect() {
-    try {
-        // Create I/O context
-        ioc_ = std::make_unique<net::io_context>();
-        ctx_ = std::make_unique<ssl::context>(ssl::context::sslv23_client);
-
-        tcp::resolver resolver{*ioc_};
-        auto const results = resolver.resolve(host_, port_);
-
-        ws_ = std::make_unique<websocket::stream<beast::ssl_stream<tcp::socket>>>(beast::ssl_stream<tcp::socket>{*ioc_, *ctx_});
-
-        net::connect(ws_->next_layer().next_layer(), results.begin(), results.end());
-
-        ws_->next_layer().handshake(ssl::stream_base::client);
+    if (started_.exchange(true)) {
+        return true;
+    }
 
-        if (!SSL_set_tlsext_host_name(ws_->next_layer().native_handle(), host_.c_str())) {
-            beast::error_code ec{static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()};
-            throw beast::system_error{ec};
+    try {
+        // Without a shared pool, create an I/O context and keep it alive between sessions
+        if (!ioc_) {
+            ownedIoc_ = std::make_unique<net::io_context>();
+            ioc_ = ownedIoc_.get();
+            workGuard_ = std::make_unique<net::executor_work_guard<net::io_context::executor_type>>(ioc_->get_executor());
         }
 
-        // Perform WebSocket handshake
-        ws_->handshake(host_, path_);
-        std::cout << "[Connected] WebSocket handshake completed.\n";
-        connected_ = true;
-        emit connectionStatusChanged(true);
-
-        // Start async read
-        do_read();
+        strand_ = std::make_unique<net::strand<net::io_context::executor_type>>(net::make_strand(*ioc_));
+        ctx_ = std::make_unique<ssl::context>(ssl::context::sslv23_client);
+        pingTimer_ = std::make_unique<net::steady_timer>(*strand_);
+        reconnectTimer_ = std::make_unique<net::steady_timer>(*strand_);
+        connectTimer_ = std::make_unique<net::steady_timer>(*strand_);
+        resolver_ = std::make_unique<tcp::resolver>(*strand_);
+        stopping_ = false;
 
         // Run the I/O service in a separate thread
-        std::thread([this]() {
-            try {
-                ioc_->run();
-            } catch (const std::exception& e) {
-                core::Logger::getInstance().error("WebSocket I/O error: {}", e.what());
-                connected_ = false;
-                emit connectionStatusChanged(false);
-            }
-        }).detach();
+        if (ownedIoc_) {
+            ioThread_ = std::thread([this]() {
+                std::vector<int> cpus = config_->getIoThreadCpus();
+                std::string applied = applyIoThreadTuning(cpus.empty() ? -1 : cpus.front(),
+                    config_->getIoThreadPolicy(), config_->getIoThreadPriority());
+                core::Logger::getInstance().info("Feed I/O thread: {}", applied);
+
+                try {
+                    ioc_->run();
+                } catch (const std::exception& e) {
+                    core::Logger::getInstance().error("WebSocket I/O error: {}", e.what());
+                    connected_ = false;
+                    emit connectionStatusChanged(false);
+                }
+            });
+        }
 
+        // All session state lives on the strand, including the first connect.
+        // Nothing here waits on the network; the result arrives via connectionStatusChanged.
+        net::post(*strand_, [this, self = shared_from_this()]() {
+            openSession();
+        });
         return true;
 
     } catch (const std::exception& e) {
@@ -96,36 +142,341 @@ bool WebSocketClient::connect() {
     }
 }
 
-void WebSocketClient::do_read() {
-    if (!ws_ || !connected_) {
+void WebSocketClient::openSession() {
+    // Completions from an abandoned attempt carry a stale tag and are ignored
+    uint32_t attempt = ++connectAttempt_;
+
+    connectTimer_->expires_after(std::chrono::milliseconds(config_->getConnectTimeoutMs()));
+    connectTimer_->async_wait([this, self = shared_from_this(), attempt](beast::error_code ec) {
+        if (!ec && attempt == connectAttempt_ && !stopping_) {
+            failConnect(attempt, "connect timed out");
+        }
+    });
+
+    resolver_->async_resolve(host_, port_,
+        [this, self = shared_from_this(), attempt](beast::error_code ec, tcp::resolver::results_type results) {
+            onResolve(attempt, ec, results);
+        });
+}
+
+void WebSocketClient::onResolve(uint32_t attempt, beast::error_code ec, tcp::resolver::results_type results) {
+    if (attempt != connectAttempt_ || stopping_) {
+        return;
+    }
+    if (ec) {
+        failConnect(attempt, "resolve: " + ec.message());
         return;
     }
 
-    ws_->async_read(
-        buffer_,
-        [this](beast::error_code ec, std::size_t bytes_transferred) {
+    if (secure_) {
+        ws_ = std::make_unique<websocket::stream<beast::ssl_stream<tcp::socket>>>(beast::ssl_stream<tcp::socket>{*strand_, *ctx_});
+    } else {
+        plainWs_ = std::make_unique<websocket::stream<tcp::socket>>(tcp::socket{*strand_});
+    }
+
+    withStream([this, attempt, &results](auto& ws) {
+        net::async_connect(beast::get_lowest_layer(ws), results,
+            [this, self = shared_from_this(), attempt](beast::error_code ec, const tcp::endpoint&) {
+                onConnect(attempt, ec);
+            });
+    });
+}
+
+void WebSocketClient::onConnect(uint32_t attempt, beast::error_code ec) {
+    if (attempt != connectAttempt_ || stopping_) {
+        return;
+    }
+    if (ec) {
+        failConnect(attempt, "connect: " + ec.message());
+        return;
+    }
+
+    // Tune the raw socket before any handshake traffic
+    withStream([this](auto& ws) {
+        std::string applied = applySocketTuning(beast::get_lowest_layer(ws), socketTuning_);
+        core::Logger::getInstance().info("Feed socket {}: {}", endpoint_, applied);
+        std::lock_guard<std::mutex> lock(tuningMutex_);
+        appliedTuning_ = applied;
+    });
+
+    if (!secure_) {
+        startWebSocketHandshake(attempt);
+        return;
+    }
+
+    // SNI must be in the ClientHello, i.e. set before the TLS handshake starts
+    if (!SSL_set_tlsext_host_name(ws_->next_layer().native_handle(), host_.c_str())) {
+        beast::error_code sniError{static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()};
+        failConnect(attempt, "SNI: " + sniError.message());
+        return;
+    }
+
+    ws_->next_layer().async_handshake(ssl::stream_base::client,
+        [this, self = shared_from_this(), attempt](beast::error_code ec) {
+            if (attempt != connectAttempt_ || stopping_) {
+                return;
+            }
             if (ec) {
-                core::Logger::getInstance().error("WebSocket read error: {}", ec.message());
-                connected_ = false;
-                emit connectionStatusChanged(false);
+                failConnect(attempt, "TLS handshake: " + ec.message());
                 return;
             }
+            startWebSocketHandshake(attempt);
+        });
+}
+
+void WebSocketClient::startWebSocketHandshake(uint32_t attempt) {
+    // Offer permessage-deflate. With context takeover the stream keeps one
+    // inflate window for the whole session instead of resetting per message.
+    if (config_->isCompressionEnabled()) {
+        websocket::permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_max_window_bits = 15;
+        pmd.client_max_window_bits = 15;
+        pmd.server_no_context_takeover = false;
+        pmd.client_no_context_takeover = false;
+        withStream([&](auto& ws) { ws.set_option(pmd); });
+    }
 
-            auto data = beast::buffers_to_string(buffer_.data());
-            processor_->enqueue(data);
-            buffer_.consume(buffer_.size());
+    // The Host header carries the port unless it is the scheme default
+    std::string hostHeader = host_;
+    if (port_ != (secure_ ? "443" : "80")) {
+        hostHeader += ":" + port_;
+    }
+
+    handshakeResponse_ = {};
+    withStream([&](auto& ws) {
+        ws.async_handshake(handshakeResponse_, hostHeader, path_,
+            [this, self = shared_from_this(), attempt](beast::error_code ec) {
+                onWebSocketHandshake(attempt, ec);
+            });
+    });
+}
+
+void WebSocketClient::onWebSocketHandshake(uint32_t attempt, beast::error_code ec) {
+    if (attempt != connectAttempt_ || stopping_) {
+        return;
+    }
+    if (ec) {
+        failConnect(attempt, "WebSocket handshake: " + ec.message());
+        return;
+    }
 
-            // Continue reading
-            do_read();
+    connectTimer_->cancel();
+    std::cout << "[Connected] WebSocket handshake completed.\n";
+
+    if (config_->isCompressionEnabled()) {
+        auto extensions = handshakeResponse_[beast::http::field::sec_websocket_extensions];
+        if (extensions.find("permessage-deflate") != beast::string_view::npos) {
+            core::Logger::getInstance().info("permessage-deflate negotiated: {}", std::string(extensions));
+        } else {
+            core::Logger::getInstance().warn("Server declined permessage-deflate, receiving uncompressed");
+        }
+    }
+
+    withStream([this](auto& ws) {
+        // Any control frame (pong, ping, close) counts as proof of life
+        ws.control_callback([this](websocket::frame_type, beast::string_view) {
+            lastActivity_ = std::chrono::steady_clock::now();
         });
+    });
+
+    // Replay subscriptions ahead of anything queued while disconnected, so the
+    // new session starts complete. A write cut off by the disconnect is gone
+    // with the old stream; stale pings are dropped.
+    writing_ = false;
+    writeQueue_.erase(std::remove_if(writeQueue_.begin(), writeQueue_.end(),
+        [](const PendingWrite& write) { return write.kind == PendingWrite::Kind::PING; }), writeQueue_.end());
+    std::vector<std::string> replay;
+    {
+        std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+        replay = subscriptions_;
+    }
+    if (replayProvider_) {
+        for (auto& request : replayProvider_()) {
+            replay.push_back(std::move(request));
+        }
+    }
+    for (auto it = replay.rbegin(); it != replay.rend(); ++it) {
+        writeQueue_.push_front(makePendingWrite(*it));
+    }
+
+    ++session_;
+    reconnectAttempt_ = 0;
+    lastActivity_ = std::chrono::steady_clock::now();
+    buffer_.consume(buffer_.size());
+    buffer_.reserve(kReadBufferCapacity);
+    connected_ = true;
+    emit connectionStatusChanged(true);
+
+    // Start async read, drain the write queue and keep the session alive
+    do_read();
+    flushWrites();
+    schedulePing();
+}
+
+void WebSocketClient::failConnect(uint32_t attempt, const std::string& reason) {
+    if (attempt != connectAttempt_) {
+        return;
+    }
+
+    // Invalidate whatever is still in flight for this attempt
+    ++connectAttempt_;
+    connectTimer_->cancel();
+    resolver_->cancel();
+    closeSocket();
+
+    core::Logger::getInstance().error("WebSocket connection to {} failed: {}", endpoint_, reason);
+    scheduleReconnect();
+}
+
+void WebSocketClient::do_read() {
+    if (!connected_) {
+        return;
+    }
+
+    withStream([this](auto& ws) {
+        ws.async_read(
+            buffer_,
+            [this, self = shared_from_this(), session = session_](beast::error_code ec, std::size_t) {
+                // Stamp first: this is the closest user space gets to the socket
+                int64_t receivedNs = core::utils::steadyClockNanos();
+
+                if (session != session_ || stopping_) {
+                    return; // completion from a torn-down session
+                }
+
+                if (ec) {
+                    handleDisconnect("read error: " + ec.message());
+                    return;
+                }
+
+                lastActivity_ = std::chrono::steady_clock::now();
+                if (socketTuning_.quickAck) {
+                    withStream([](auto& ws) { rearmQuickAck(beast::get_lowest_layer(ws)); });
+                }
+
+                // Copy the (inflated) frame into a recycled buffer; buffer_ keeps its capacity
+                auto frame = buffer_.data();
+                std::string data = processor_->acquireBuffer();
+                data.assign(static_cast<const char*>(frame.data()), frame.size());
+                processor_->enqueue(processing::WebSocketMessage{std::move(data), session_, receivedNs, line_});
+                buffer_.consume(buffer_.size());
+
+                // Continue reading
+                do_read();
+            });
+    });
+}
+
+void WebSocketClient::handleDisconnect(const std::string& reason) {
+    if (!connected_) {
+        return;
+    }
+
+    core::Logger::getInstance().warn("WebSocket disconnected ({}), reconnecting", reason);
+    connected_ = false;
+    emit connectionStatusChanged(false);
+
+    // The next session's first snapshot rebuilds the book; time it from here
+    processor_->beginResync(line_, session_ + 1, config_->getReconnectIntervalMs());
+
+    pingTimer_->cancel();
+    closeSocket();
+    scheduleReconnect();
+}
+
+void WebSocketClient::scheduleReconnect() {
+    if (stopping_) {
+        return;
+    }
+
+    // Exponential backoff capped at the configured interval, with jitter so a
+    // fleet of clients does not reconnect in lockstep
+    int maxDelayMs = std::max(config_->getReconnectIntervalMs(), kInitialBackoffMs);
+    int delayMs = std::min(maxDelayMs, kInitialBackoffMs << std::min(reconnectAttempt_, 16));
+    delayMs = delayMs / 2 + std::uniform_int_distribution<int>(0, delayMs / 2)(jitter_);
+    ++reconnectAttempt_;
+
+    reconnectTimer_->expires_after(std::chrono::milliseconds(delayMs));
+    reconnectTimer_->async_wait([this, self = shared_from_this()](beast::error_code ec) {
+        if (ec || stopping_) {
+            return;
+        }
+
+        ++reconnectCount_;
+        openSession();
+    });
+}
+
+void WebSocketClient::schedulePing() {
+    auto interval = std::chrono::milliseconds(config_->getPingIntervalMs());
+    pingTimer_->expires_after(interval);
+    pingTimer_->async_wait([this, self = shared_from_this(), interval, session = session_](beast::error_code ec) {
+        if (ec || session != session_ || stopping_ || !connected_) {
+            return;
+        }
+
+        // Nothing heard for two ping intervals: the peer is gone even if TCP hasn't noticed
+        if (std::chrono::steady_clock::now() - lastActivity_ > 2 * interval) {
+            handleDisconnect("keepalive timeout");
+            return;
+        }
+
+        // One queued ping is enough; a backlog of them carries no information
+        bool pingQueued = std::any_of(writeQueue_.begin(), writeQueue_.end(),
+            [](const PendingWrite& write) { return write.kind == PendingWrite::Kind::PING; });
+        if (!pingQueued) {
+            writeQueue_.push_back(PendingWrite{PendingWrite::Kind::PING, {}, {}, {}});
+            flushWrites();
+        }
+        schedulePing();
+    });
+}
+
+void WebSocketClient::closeSocket() {
+    beast::error_code ec;
+    withStream([&ec](auto& ws) {
+        beast::get_lowest_layer(ws).close(ec);
+    });
 }
 
 void WebSocketClient::disconnect() {
-    if (ws_ && connected_) {
-        try {
-            ws_->close(websocket::close_code::normal);
-        } catch (...) {
+    if (!started_.exchange(false)) {
+        return;
+    }
+
+    stopping_ = true;
+
+    // Tear the session down on its strand; pending handlers see stopping_ and exit
+    std::promise<void> closed;
+    auto done = closed.get_future();
+    auto teardown = [this, &closed]() {
+        ++connectAttempt_;
+        pingTimer_->cancel();
+        reconnectTimer_->cancel();
+        connectTimer_->cancel();
+        resolver_->cancel();
+        closeSocket();
+        closed.set_value();
+    };
+
+    if (ioc_->stopped()) {
+        teardown();
+    } else {
+        net::post(*strand_, teardown);
+    }
+    done.wait();
+
+    if (ownedIoc_) {
+        workGuard_.reset();
+        if (ioThread_.joinable()) {
+            ioThread_.join();
         }
+        ownedIoc_.reset();
+        ioc_ = nullptr;
+    }
+
+    if (connected_) {
         connected_ = false;
         emit connectionStatusChanged(false);
     }
@@ -136,16 +487,128 @@ bool WebSocketClient::isConnected() const {
 }
 
 bool WebSocketClient::send(const std::string& message) {
-    if (!ws_ || !connected_) {
+    if (!started_ || !strand_) {
         return false;
     }
-    try {
-        ws_->write(net::buffer(message));
-        return true;
-    } catch (const std::exception& e) {
-        core::Logger::getInstance().error("Failed to send message: {}", e.what());
-        return false;
+
+    // Never touches the stream from the caller's thread; the strand owns it
+    net::post(*strand_, [this, self = shared_from_this(), write = makePendingWrite(message)]() mutable {
+        writeQueue_.push_back(std::move(write));
+        flushWrites();
+    });
+    return true;
+}
+
+WebSocketClient::PendingWrite WebSocketClient::makePendingWrite(const std::string& message) {
+    // OKX subscribe/unsubscribe requests carry an args array; consecutive ones
+    // with the same op can be merged into a single frame
+    nlohmann::json request = nlohmann::json::parse(message, nullptr, false);
+    if (request.is_object() && request.size() == 2 && request.contains("op") && request["op"].is_string() &&
+        request.contains("args") && request["args"].is_array()) {
+        std::string op = request["op"];
+        if (op == "subscribe" || op == "unsubscribe") {
+            return PendingWrite{PendingWrite::Kind::BATCHABLE, message, op, std::move(request["args"])};
+        }
+    }
+    return PendingWrite{PendingWrite::Kind::FRAME, message, {}, {}};
+}
+
+void WebSocketClient::flushWrites() {
+    if (writing_ || !connected_ || writeQueue_.empty()) {
+        return;
+    }
+
+    PendingWrite write = std::move(writeQueue_.front());
+    writeQueue_.pop_front();
+    writing_ = true;
+
+    if (write.kind == PendingWrite::Kind::PING) {
+        withStream([this](auto& ws) {
+            ws.async_ping({}, [this, self = shared_from_this(), session = session_](beast::error_code ec) {
+                onWriteComplete(session, ec, "ping");
+            });
+        });
+        return;
     }
+
+    currentWrite_ = std::move(write.payload);
+    if (write.kind == PendingWrite::Kind::BATCHABLE) {
+        // Fold the following requests with the same op into this frame
+        size_t merged = 0;
+        while (!writeQueue_.empty() && write.args.size() < kMaxArgsPerRequest) {
+            PendingWrite& next = writeQueue_.front();
+            if (next.kind != PendingWrite::Kind::BATCHABLE || next.op != write.op ||
+                write.args.size() + next.args.size() > kMaxArgsPerRequest) {
+                break;
+            }
+            for (auto& arg : next.args) {
+                write.args.push_back(std::move(arg));
+            }
+            writeQueue_.pop_front();
+            ++merged;
+        }
+        if (merged > 0) {
+            currentWrite_ = nlohmann::json{{"op", write.op}, {"args", std::move(write.args)}}.dump();
+        }
+    }
+
+    withStream([this](auto& ws) {
+        ws.text(true);
+        ws.async_write(net::buffer(currentWrite_),
+            [this, self = shared_from_this(), session = session_](beast::error_code ec, std::size_t) {
+                onWriteComplete(session, ec, "write");
+            });
+    });
+}
+
+void WebSocketClient::onWriteComplete(uint32_t session, beast::error_code ec, const char* operation) {
+    if (session != session_ || stopping_) {
+        return; // the new session reset the queue state
+    }
+
+    writing_ = false;
+    if (ec) {
+        handleDisconnect(std::string(operation) + " failed: " + ec.message());
+        return;
+    }
+    flushWrites();
+}
+
+bool WebSocketClient::subscribe(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+        subscriptions_.push_back(message);
+    }
+    return connected_ ? send(message) : true;
+}
+
+void WebSocketClient::setReplayProvider(std::function<std::vector<std::string>()> provider) {
+    replayProvider_ = provider;
+}
+
+const std::string& WebSocketClient::getEndpoint() const {
+    return endpoint_;
+}
+
+void WebSocketClient::setLine(uint32_t line) {
+    line_ = line;
+}
+
+uint32_t WebSocketClient::getLine() const {
+    return line_;
+}
+
+std::string WebSocketClient::getAppliedTuning() const {
+    std::lock_guard<std::mutex> lock(tuningMutex_);
+    return appliedTuning_;
+}
+
+int WebSocketClient::getReconnectCount() const {
+    return reconnectCount_;
+}
+
+double WebSocketClient::getLastRecoveryTimeMs() const {
+    return processor_->getLastResyncMs();
 }
 
 void WebSocketClient::setMessageHandler(std::function<void(const std::string&)> handler) {
@@ -154,4 +617,4 @@ void WebSocketClient::setMessageHandler(std::function<void(const std::string&)>
     // For now, you can implement a synchronous receive method if needed.
 }
 
-} // namespace websocket 
\ No newline at end of file
+} // namespace websocket 
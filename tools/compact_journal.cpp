@@ -0,0 +1,286 @@
+// Compacts captured feed journals for long-term storage. Every book message
+// is re-encoded with storage::BookEncoder (ticks, lots, stream-VByte levels)
+// into BOOK_BLOCK records; at a fixed interval the books rebuilt so far are
+// written as a BOOK_KEYFRAMES record, where a reader can start decoding.
+// Other frames (subscription acks, trades) are dropped, as are the fields
+// of a level beyond price and size.
+//
+// The output is then read back: books rebuilt from it are compared with the
+// books built from the JSON, and both decoders are timed.
+//
+// Usage: compact_journal [options] DIR|SEGMENT...
+//   --out DIR          output directory (default compact)
+//   --keyframe-ms N    keyframe interval in capture time (default 1000)
+//   --block-kb N       target size of a BOOK_BLOCK record (default 64)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/orderbook.h"
+#include "core/utils.h"
+#include "storage/book_codec.h"
+#include "storage/journal_reader.h"
+#include "storage/journal_writer.h"
+#include "storage/stream_vbyte.h"
+#include "websocket/market_data_decoder.h"
+
+namespace {
+
+struct Options {
+    std::vector<std::string> inputs;
+    std::string outDir = "compact";
+    int64_t keyframeNs = 1000000000;
+    size_t blockBytes = 64 * 1024;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        if (arg.rfind("--", 0) != 0) {
+            options.inputs.push_back(arg);
+            continue;
+        }
+
+        const char* value = next();
+        if (!value) return false;
+
+        if (arg == "--out") options.outDir = value;
+        else if (arg == "--keyframe-ms") options.keyframeNs = std::atoll(value) * 1000000;
+        else if (arg == "--block-kb") options.blockBytes = std::strtoull(value, nullptr, 10) * 1024;
+        else return false;
+    }
+    return !options.inputs.empty() && options.keyframeNs > 0 && options.blockBytes > 0;
+}
+
+struct Book {
+    std::shared_ptr<core::OrderBook> orderBook = std::make_shared<core::OrderBook>();
+    storage::BookStreamInfo info;
+    bool synced = false; // false until a snapshot, and again after a sequence gap
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool sameLevels(const core::PriceLevels& a, const core::PriceLevels& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].price != b[i].price || a[i].quantity != b[i].quantity) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: compact_journal [--out DIR] [--keyframe-ms N] [--block-kb N] DIR|SEGMENT...\n";
+        return 1;
+    }
+
+    std::vector<std::string> segments;
+    for (const auto& input : options.inputs) {
+        if (std::filesystem::is_directory(input)) {
+            auto found = storage::JournalReader::listSegments(input);
+            segments.insert(segments.end(), found.begin(), found.end());
+        } else {
+            segments.push_back(input);
+        }
+    }
+
+    // Inputs may come from several runs with unrelated steady clocks
+    storage::JournalWriter writer(options.outDir, "book");
+    writer.setWallClockStamps(true);
+    if (!writer.open()) {
+        return 1;
+    }
+
+    std::unordered_map<uint64_t, Book> books;
+    storage::BookEncoder encoder;
+    processing::BookUpdate update;
+    std::string payload;
+    std::vector<uint8_t> block;
+    int64_t blockStartNs = 0;
+    int64_t lastKeyframeNs = std::numeric_limits<int64_t>::min() / 2;
+    core::PriceLevels bids;
+    core::PriceLevels asks;
+
+    uint64_t inputFrames = 0;
+    uint64_t bookFrames = 0;
+    uint64_t jsonBytes = 0;
+    uint64_t unencodable = 0;
+    uint64_t keyframes = 0;
+    double jsonSeconds = 0.0;
+
+    auto flushBlock = [&]() {
+        if (!block.empty()) {
+            writer.append(storage::RecordType::BOOK_BLOCK,
+                          {reinterpret_cast<const char*>(block.data()), block.size()}, blockStartNs);
+            block.clear();
+        }
+    };
+
+    auto writeKeyframes = [&](int64_t receivedNs) {
+        flushBlock();
+        encoder.reset();
+        for (auto& [route, book] : books) {
+            if (!book.synced) {
+                continue;
+            }
+            book.orderBook->getTopLevels(std::numeric_limits<size_t>::max(), bids, asks);
+            int64_t exchangeMs = core::utils::systemClockNanos(book.orderBook->getTimestamp()) / 1000000;
+            if (encoder.encodeKeyframe(book.info, receivedNs, exchangeMs, book.orderBook->getSequenceId(),
+                                       bids, asks, block)) {
+                ++keyframes;
+            }
+        }
+        if (!block.empty()) {
+            writer.append(storage::RecordType::BOOK_KEYFRAMES,
+                          {reinterpret_cast<const char*>(block.data()), block.size()}, receivedNs);
+            block.clear();
+        }
+    };
+
+    for (const auto& path : segments) {
+        storage::JournalReader reader;
+        if (!reader.open(path)) {
+            continue;
+        }
+
+        storage::JournalRecord record;
+        while (reader.next(record)) {
+            if (record.type != storage::RecordType::FRAME) {
+                continue;
+            }
+            ++inputFrames;
+
+            payload.assign(record.payload.data(), record.payload.size());
+            auto decodeStart = std::chrono::steady_clock::now();
+            processing::MessageKind kind = processing::decodeMarketData(payload, update);
+            jsonSeconds += secondsSince(decodeStart);
+            if (kind != processing::MessageKind::BOOK) {
+                continue;
+            }
+            ++bookFrames;
+            jsonBytes += record.payload.size();
+            const int64_t wallNs = record.receivedNs + reader.getHeader().steadyToWallNs;
+
+            if (wallNs - lastKeyframeNs >= options.keyframeNs) {
+                writeKeyframes(wallNs);
+                lastKeyframeNs = wallNs;
+            }
+
+            Book& book = books[update.route];
+            book.info = {update.route, update.exchange, update.symbol, update.channel};
+            if (update.snapshot) {
+                book.orderBook->update(update.exchange, update.symbol, update.bids, update.asks,
+                                       update.timestamp, update.seqId);
+                book.synced = true;
+            } else if (!book.orderBook->applyDelta(update.bids, update.asks, update.timestamp,
+                                                   update.prevSeqId, update.seqId)) {
+                book.synced = false;
+            }
+
+            if (block.empty()) {
+                blockStartNs = wallNs;
+            }
+            int64_t exchangeMs = core::utils::systemClockNanos(core::utils::parseISOTimestamp(update.timestamp)) / 1000000;
+            if (!encoder.encode(book.info, update.snapshot, wallNs, exchangeMs, update.seqId,
+                                update.prevSeqId, update.bids, update.asks, block)) {
+                ++unencodable;
+                continue;
+            }
+            if (block.size() >= options.blockBytes) {
+                flushBlock();
+            }
+        }
+    }
+    flushBlock();
+    writer.close();
+
+    uint64_t compactBytes = writer.getBytesWritten();
+    std::printf("%llu frames in, %llu book messages (%.1f MB of JSON), %llu not encodable\n",
+                static_cast<unsigned long long>(inputFrames), static_cast<unsigned long long>(bookFrames),
+                jsonBytes / (1024.0 * 1024.0), static_cast<unsigned long long>(unencodable));
+    std::printf("%.1f MB out in %llu segments, %llu keyframes: %.1fx smaller than the JSON\n",
+                compactBytes / (1024.0 * 1024.0), static_cast<unsigned long long>(writer.getSegmentCount()),
+                static_cast<unsigned long long>(keyframes),
+                compactBytes > 0 ? static_cast<double>(jsonBytes) / compactBytes : 0.0);
+
+    // Read back: time the decoder alone, then rebuild the books and compare
+    auto output = storage::JournalReader::listSegments(options.outDir, "book");
+    storage::BookDecoder decoder;
+    storage::BookFrame frame;
+    uint64_t decodedFrames = 0;
+    double codecSeconds = 0.0;
+    std::unordered_map<uint64_t, std::shared_ptr<core::OrderBook>> rebuilt;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& path : output) {
+            storage::JournalReader reader;
+            if (!reader.open(path)) {
+                return 1;
+            }
+            decoder.reset();
+
+            storage::JournalRecord record;
+            auto start = std::chrono::steady_clock::now();
+            while (reader.next(record)) {
+                const auto* in = reinterpret_cast<const uint8_t*>(record.payload.data());
+                const uint8_t* end = in + record.payload.size();
+                while (in && in < end) {
+                    in = decoder.decode(in, end, frame);
+                    const storage::BookStreamInfo* info = in ? decoder.getStream(frame.stream) : nullptr;
+                    if (!info || pass == 0) {
+                        decodedFrames += info ? 1 : 0;
+                        continue;
+                    }
+                    auto& orderBook = rebuilt[info->route];
+                    if (!orderBook) {
+                        orderBook = std::make_shared<core::OrderBook>();
+                    }
+                    storage::applyFrame(frame, *info, *orderBook);
+                }
+                if (!in) {
+                    std::fprintf(stderr, "Malformed block in %s\n", path.c_str());
+                    return 1;
+                }
+            }
+            if (pass == 0) {
+                codecSeconds += secondsSince(start);
+            }
+        }
+    }
+
+    size_t matching = 0;
+    for (const auto& [route, book] : books) {
+        auto it = rebuilt.find(route);
+        if (it != rebuilt.end() && sameLevels(book.orderBook->getBids(), it->second->getBids()) &&
+            sameLevels(book.orderBook->getAsks(), it->second->getAsks())) {
+            ++matching;
+        }
+    }
+
+    std::printf("JSON decode:  %10.0f msg/s %8.1f MB/s\n", bookFrames / jsonSeconds,
+                jsonBytes / (1024.0 * 1024.0) / jsonSeconds);
+    std::printf("codec decode: %10.0f msg/s %8.1f MB/s of JSON equivalent (%s)\n",
+                decodedFrames / codecSeconds, jsonBytes / (1024.0 * 1024.0) / codecSeconds,
+                storage::streamVbyteSimdAvailable() ? "SSSE3" : "scalar");
+    std::printf("books matching after read-back: %zu/%zu\n", matching, books.size());
+    return matching == books.size() ? 0 : 1;
+}
@@ -0,0 +1,603 @@
+// Imports vendor L2 history in the tardis.dev incremental_book_L2 CSV layout
+//
+//   exchange,symbol,timestamp,local_timestamp,is_snapshot,side,price,amount
+//
+// into capture journals, so backfilled days go through journal_replay,
+// journal_index and compact_journal like live captures.
+//
+// Rows with the same symbol, receive time and snapshot flag make up one
+// feed message, written as an OKX books push (snapshot or update) with a
+// per-symbol sequence number. Receive stamps are the vendor's
+// local_timestamp; the exchange's timestamp becomes the message ts.
+//
+// Files are mapped and cut into chunks at message boundaries. Worker
+// threads parse and render chunks in parallel; the writer takes them back
+// through a bounded reorder buffer, merges the files' messages by
+// local_timestamp, adds the sequence numbers and appends. One file per
+// symbol, as tardis ships them, so gives one journal in receive order.
+// Files must be uncompressed and each in local_timestamp order; input that
+// is not is rejected.
+//
+// Usage: import_tardis [options] FILE.csv...
+//   --out DIR          output directory (default import)
+//   --channel NAME     OKX channel to file the books under (default books)
+//   --threads N        parsing threads (default: all cores)
+//   --chunk-mb N       input per parsing task (default 8)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/utils.h"
+#include "storage/book_codec.h"
+#include "storage/journal_writer.h"
+
+namespace {
+
+struct Options {
+    std::vector<std::string> inputs;
+    std::string outDir = "import";
+    std::string channel = "books";
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkBytes = 8 * 1024 * 1024;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        if (arg.rfind("--", 0) != 0) {
+            options.inputs.push_back(arg);
+            continue;
+        }
+
+        const char* value = next();
+        if (!value) return false;
+
+        if (arg == "--out") options.outDir = value;
+        else if (arg == "--channel") options.channel = value;
+        else if (arg == "--threads") options.threads = std::strtoull(value, nullptr, 10);
+        else if (arg == "--chunk-mb") options.chunkBytes = std::strtoull(value, nullptr, 10) * 1024 * 1024;
+        else return false;
+    }
+    return !options.inputs.empty() && options.threads > 0 && options.chunkBytes > 0;
+}
+
+// Read-only mapping of one input file
+class MappedFile {
+public:
+    ~MappedFile() {
+        if (data_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info{};
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size_ = static_cast<size_t>(info.st_size);
+            void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                data_ = static_cast<const char*>(mapping);
+                madvise(mapping, size_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        return data_ != nullptr;
+    }
+
+    std::string_view text() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Positions of the needed fields in a file's header line
+struct Columns {
+    int symbol = -1;
+    int timestamp = -1;
+    int localTimestamp = -1;
+    int isSnapshot = -1;
+    int side = -1;
+    int price = -1;
+    int amount = -1;
+    int count = 0;
+};
+
+struct Row {
+    std::string_view symbol;
+    int64_t timestampUs = 0;
+    int64_t localTimestampUs = 0;
+    bool snapshot = false;
+    bool bid = false;
+    std::string_view price;
+    std::string_view amount;
+
+    // Rows of one feed message share these
+    bool sameMessage(const Row& other) const {
+        return localTimestampUs == other.localTimestampUs && snapshot == other.snapshot && symbol == other.symbol;
+    }
+};
+
+bool parseColumns(std::string_view header, Columns& columns) {
+    int index = 0;
+    size_t start = 0;
+    while (start <= header.size()) {
+        size_t end = std::min(header.find(',', start), header.size());
+        std::string_view name = header.substr(start, end - start);
+        if (!name.empty() && name.back() == '\r') name.remove_suffix(1);
+
+        if (name == "symbol") columns.symbol = index;
+        else if (name == "timestamp") columns.timestamp = index;
+        else if (name == "local_timestamp") columns.localTimestamp = index;
+        else if (name == "is_snapshot") columns.isSnapshot = index;
+        else if (name == "side") columns.side = index;
+        else if (name == "price") columns.price = index;
+        else if (name == "amount") columns.amount = index;
+        ++index;
+        start = end + 1;
+    }
+    columns.count = index;
+    return columns.symbol >= 0 && columns.timestamp >= 0 && columns.localTimestamp >= 0 &&
+           columns.isSnapshot >= 0 && columns.side >= 0 && columns.price >= 0 && columns.amount >= 0;
+}
+
+bool parseMicros(std::string_view text, int64_t& value) {
+    if (text.empty() || text.size() > 18) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return true;
+}
+
+// One line without its newline; false for lines that are not a book row
+bool parseRow(std::string_view line, const Columns& columns, Row& row) {
+    std::string_view fields[16];
+    int count = 0;
+    size_t start = 0;
+    while (count < 16 && start <= line.size()) {
+        size_t end = std::min(line.find(',', start), line.size());
+        fields[count++] = line.substr(start, end - start);
+        start = end + 1;
+    }
+    if (count < columns.count || count > 16) {
+        return false;
+    }
+    if (!fields[count - 1].empty() && fields[count - 1].back() == '\r') {
+        fields[count - 1].remove_suffix(1);
+    }
+
+    std::string_view side = fields[columns.side];
+    row.symbol = fields[columns.symbol];
+    row.snapshot = fields[columns.isSnapshot] == "true";
+    row.bid = side == "bid" || side == "buy";
+    row.price = fields[columns.price];
+    row.amount = fields[columns.amount];
+    return !row.symbol.empty() && (row.bid || side == "ask" || side == "sell") &&
+           parseMicros(fields[columns.timestamp], row.timestampUs) &&
+           parseMicros(fields[columns.localTimestamp], row.localTimestampUs);
+}
+
+// Plain decimals are copied as they are; other forms (1e-05) are rewritten
+// exactly. False if the value is not a usable non-negative number.
+bool appendDecimal(std::string_view text, std::string& out) {
+    int64_t mantissa = 0;
+    int decimals = 0;
+    if (core::utils::parseDecimal(text, mantissa, decimals)) {
+        if (mantissa < 0) {
+            return false;
+        }
+        out.append(text.data(), text.size());
+        return true;
+    }
+
+    double value = core::utils::parseDecimalDouble(text, -1.0);
+    if (!(value >= 0.0) || value > 1e15) {
+        return false;
+    }
+    int digits = storage::exactDecimals(value);
+    char buf[48];
+    int length = std::snprintf(buf, sizeof(buf), "%.*f", digits >= 0 ? digits : storage::kMaxDecimals, value);
+    if (digits < 0) {
+        while (length > 1 && buf[length - 1] == '0' && buf[length - 2] != '.') {
+            --length;
+        }
+    }
+    out.append(buf, length);
+    return true;
+}
+
+struct Chunk {
+    size_t file;
+    std::string_view text;  // whole lines, starting and ending at message boundaries
+    int64_t neededUs;       // last local_timestamp of the file's previous chunk; -1 for the first
+};
+
+struct Message {
+    std::string_view symbol;  // into the mapped file
+    int64_t receivedNs;
+    bool snapshot;
+    size_t begin;             // rendered JSON in ChunkResult::text, up to the sequence numbers
+    size_t end;
+};
+
+struct ChunkResult {
+    size_t file = 0;
+    std::string text;
+    std::vector<Message> messages;
+    uint64_t rows = 0;
+    uint64_t rejected = 0;
+};
+
+// Cuts a file into chunks of about chunkBytes, moving each cut forward past
+// the rows of the message it falls into
+void splitFile(size_t file, std::string_view body, const Columns& columns, size_t chunkBytes,
+               std::vector<Chunk>& chunks) {
+    size_t start = 0;
+    int64_t neededUs = -1;
+    while (start < body.size()) {
+        size_t cut = start + chunkBytes;
+        if (cut >= body.size()) {
+            chunks.push_back({file, body.substr(start), neededUs});
+            return;
+        }
+        cut = body.find('\n', cut);
+        if (cut == std::string_view::npos) {
+            chunks.push_back({file, body.substr(start), neededUs});
+            return;
+        }
+
+        // The row ending at the cut decides which message the following rows must not belong to
+        size_t lineStart = body.rfind('\n', cut - 1);
+        lineStart = lineStart == std::string_view::npos || lineStart < start ? start : lineStart + 1;
+        Row last;
+        Row row;
+        bool known = parseRow(body.substr(lineStart, cut - lineStart), columns, last);
+        ++cut;
+        while (known && cut < body.size()) {
+            size_t lineEnd = std::min(body.find('\n', cut), body.size());
+            if (!parseRow(body.substr(cut, lineEnd - cut), columns, row) || !row.sameMessage(last)) {
+                break;
+            }
+            cut = lineEnd + 1;
+        }
+        cut = std::min(cut, body.size());
+        chunks.push_back({file, body.substr(start, cut - start), neededUs});
+        neededUs = known ? last.localTimestampUs : neededUs;
+        start = cut;
+    }
+}
+
+void renderChunk(const Chunk& chunk, const Columns& columns, const std::string& channel, ChunkResult& result) {
+    std::string bids;
+    std::string asks;
+    Row first;
+    Row row;
+    bool open = false;
+
+    auto flush = [&]() {
+        if (!open) {
+            return;
+        }
+        open = false;
+        if (bids.empty() && asks.empty()) {
+            return;
+        }
+        Message message{first.symbol, first.localTimestampUs * 1000, first.snapshot, result.text.size(), 0};
+        result.text += "{\"arg\":{\"channel\":\"";
+        result.text += channel;
+        result.text += "\",\"instId\":\"";
+        result.text.append(first.symbol.data(), first.symbol.size());
+        result.text += first.snapshot ? "\"},\"action\":\"snapshot\",\"data\":[{\"asks\":[" :
+                                        "\"},\"action\":\"update\",\"data\":[{\"asks\":[";
+        result.text += asks;
+        result.text += "],\"bids\":[";
+        result.text += bids;
+        result.text += "],\"ts\":\"";
+        result.text += std::to_string(first.timestampUs / 1000);
+        result.text += "\",";
+        message.end = result.text.size();
+        result.messages.push_back(message);
+    };
+
+    std::string_view text = chunk.text;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = std::min(text.find('\n', start), text.size());
+        std::string_view line = text.substr(start, end - start);
+        start = end + 1;
+        if (line.empty() || line == "\r") {
+            continue;
+        }
+        if (!parseRow(line, columns, row)) {
+            ++result.rejected;
+            continue;
+        }
+
+        if (!open || !row.sameMessage(first)) {
+            flush();
+            first = row;
+            open = true;
+            bids.clear();
+            asks.clear();
+        }
+
+        // Snapshots list the levels that exist; a zero there carries nothing
+        if (row.snapshot && core::utils::parseDecimalDouble(row.amount, -1.0) == 0.0) {
+            continue;
+        }
+        std::string& side = row.bid ? bids : asks;
+        size_t mark = side.size();
+        side += side.empty() ? "[\"" : ",[\"";
+        bool valid = appendDecimal(row.price, side);
+        side += "\",\"";
+        valid = valid && appendDecimal(row.amount, side);
+        side += "\",\"0\",\"0\"]";
+        if (!valid) {
+            side.resize(mark);
+            ++result.rejected;
+            continue;
+        }
+        ++result.rows;
+    }
+    flush();
+}
+
+// Hands chunk results from the parsing threads to the writer in chunk order.
+// Parsing stays at most `window` chunks ahead of writing, which bounds memory.
+class ReorderBuffer {
+public:
+    explicit ReorderBuffer(size_t window) : window_(window) {}
+
+    // Blocks until chunk index may be parsed
+    void waitForSlot(size_t index) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        slotFreed_.wait(lock, [&] { return index < next_ + window_; });
+    }
+
+    void put(size_t index, ChunkResult&& result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.emplace(index, std::move(result));
+        }
+        readyChanged_.notify_all();
+    }
+
+    // Next chunk in order
+    ChunkResult take() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        readyChanged_.wait(lock, [&] { return !ready_.empty() && ready_.begin()->first == next_; });
+        ChunkResult result = std::move(ready_.begin()->second);
+        ready_.erase(ready_.begin());
+        ++next_;
+        lock.unlock();
+        slotFreed_.notify_all();
+        return result;
+    }
+
+private:
+    const size_t window_;
+    std::mutex mutex_;
+    std::condition_variable readyChanged_;
+    std::condition_variable slotFreed_;
+    std::map<size_t, ChunkResult> ready_;
+    size_t next_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: import_tardis [--out DIR] [--channel NAME] [--threads N] [--chunk-mb N] FILE.csv...\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<MappedFile> files(options.inputs.size());
+    std::vector<Columns> columns(options.inputs.size());
+    std::vector<Chunk> chunks;
+    uint64_t inputBytes = 0;
+    for (size_t i = 0; i < options.inputs.size(); ++i) {
+        if (!files[i].open(options.inputs[i])) {
+            std::cerr << "Cannot read " << options.inputs[i] << "\n";
+            return 1;
+        }
+        std::string_view text = files[i].text();
+        size_t headerEnd = std::min(text.find('\n'), text.size());
+        if (!parseColumns(text.substr(0, headerEnd), columns[i])) {
+            std::cerr << options.inputs[i] << " is not an incremental_book_L2 CSV file\n";
+            return 1;
+        }
+        inputBytes += text.size();
+        if (headerEnd < text.size()) {
+            splitFile(i, text.substr(headerEnd + 1), columns[i], options.chunkBytes, chunks);
+        }
+    }
+
+    storage::JournalWriter writer(options.outDir, "feed");
+    writer.setWallClockStamps(true);
+    if (!writer.open()) {
+        return 1;
+    }
+
+    // Parsed in the order the merge runs out of each file's previous chunk,
+    // so the writer rarely holds chunks it cannot use yet
+    std::vector<size_t> order(chunks.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return std::tie(chunks[a].neededUs, chunks[a].file) < std::tie(chunks[b].neededUs, chunks[b].file);
+    });
+
+    ReorderBuffer reorder(2 * options.threads);
+    std::atomic<size_t> nextTask{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < std::min(options.threads, chunks.size()); ++t) {
+        workers.emplace_back([&] {
+            for (size_t task = nextTask++; task < chunks.size(); task = nextTask++) {
+                reorder.waitForSlot(task);
+                const Chunk& chunk = chunks[order[task]];
+                ChunkResult result;
+                result.file = chunk.file;
+                renderChunk(chunk, columns[chunk.file], options.channel, result);
+                reorder.put(task, std::move(result));
+            }
+        });
+    }
+
+    // Rendered chunks not yet written, per file
+    struct Pending {
+        std::deque<ChunkResult> results;
+        size_t message = 0;       // next one in results.front()
+        size_t chunksLeft = 0;    // not yet taken from the reorder buffer
+        int64_t lastNs = 0;
+    };
+    std::vector<Pending> pending(files.size());
+    for (const Chunk& chunk : chunks) {
+        ++pending[chunk.file].chunksLeft;
+    }
+
+    uint64_t rows = 0;
+    uint64_t rejected = 0;
+    size_t taken = 0;
+    // Takes chunks in parse order until the file has a message or none are left
+    auto fill = [&](size_t file) {
+        while (pending[file].results.empty() && pending[file].chunksLeft > 0) {
+            ChunkResult result = reorder.take();
+            ++taken;
+            rows += result.rows;
+            rejected += result.rejected;
+            Pending& owner = pending[result.file];
+            --owner.chunksLeft;
+            if (!result.messages.empty()) {
+                owner.results.push_back(std::move(result));
+            }
+        }
+    };
+
+    // K-way merge on each file's next message: (receive time, file)
+    using Head = std::pair<int64_t, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (size_t file = 0; file < pending.size(); ++file) {
+        fill(file);
+        if (!pending[file].results.empty()) {
+            heads.push({pending[file].results.front().messages.front().receivedNs, file});
+        }
+    }
+
+    // Sequence numbers follow the symbol across chunks and files
+    std::unordered_map<std::string_view, int64_t> sequences;
+    std::string payload;
+    uint64_t messages = 0;
+    uint64_t snapshots = 0;
+    int64_t firstNs = 0;
+    int64_t lastNs = 0;
+    bool failed = false;
+    bool unsorted = false;
+
+    while (!heads.empty()) {
+        size_t file = heads.top().second;
+        heads.pop();
+        Pending& source = pending[file];
+        const ChunkResult& result = source.results.front();
+        const Message& message = result.messages[source.message];
+
+        if (message.receivedNs < source.lastNs) {
+            std::cerr << options.inputs[file] << " is not in local_timestamp order\n";
+            unsorted = true;
+            break;
+        }
+        source.lastNs = message.receivedNs;
+
+        auto [it, inserted] = sequences.try_emplace(message.symbol, 0);
+        int64_t prevSeqId = message.snapshot || inserted ? -1 : it->second;
+        int64_t seqId = ++it->second;
+
+        payload.assign(result.text, message.begin, message.end - message.begin);
+        payload += "\"prevSeqId\":";
+        payload += std::to_string(prevSeqId);
+        payload += ",\"seqId\":";
+        payload += std::to_string(seqId);
+        payload += "}]}";
+
+        if (!failed && !writer.append(storage::RecordType::FRAME, payload, message.receivedNs)) {
+            failed = true;
+        }
+        firstNs = messages == 0 ? message.receivedNs : firstNs;
+        lastNs = message.receivedNs;
+        ++messages;
+        snapshots += message.snapshot ? 1 : 0;
+
+        if (++source.message == result.messages.size()) {
+            source.results.pop_front();
+            source.message = 0;
+            fill(file);
+        }
+        if (!source.results.empty()) {
+            heads.push({source.results.front().messages[source.message].receivedNs, file});
+        }
+    }
+
+    // Workers may be waiting on the reorder window after an early stop
+    while (taken < chunks.size()) {
+        reorder.take();
+        ++taken;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    writer.close();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu files, %.1f MB in %zu chunks on %zu threads: %llu rows (%llu rejected) -> %llu messages "
+                "(%llu snapshots) for %zu symbols\n",
+                options.inputs.size(), inputBytes / (1024.0 * 1024.0), chunks.size(), workers.size(),
+                static_cast<unsigned long long>(rows), static_cast<unsigned long long>(rejected),
+                static_cast<unsigned long long>(messages), static_cast<unsigned long long>(snapshots),
+                sequences.size());
+    std::printf("%.2f hours of data imported in %.2f s (%.1f MB/s, %.0f rows/s), %llu segments in %s\n",
+                (lastNs - firstNs) / 3.6e12, seconds, inputBytes / (1024.0 * 1024.0) / seconds, rows / seconds,
+                static_cast<unsigned long long>(writer.getSegmentCount()), options.outDir.c_str());
+    if (failed) {
+        std::cerr << "Writing the journal failed\n";
+        return 1;
+    }
+    if (unsorted) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,355 @@
+// Builds the seek indexes of captured feed journals (raw or compacted with
+// compact_journal) and checks them: books rebuilt from a seek (nearest index
+// point, its keyframes, then the records up to the target) are compared
+// with books rebuilt by reading from the start, at random capture times and
+// at random book sequence numbers, and both ways are timed.
+//
+// Indexes are saved next to their segments (<segment>.idx) and reused by
+// journal_replay --from.
+//
+// Usage: journal_index [options] DIR|SEGMENT...
+//   --interval-ms N     capture time between index points of raw journals (default 1000)
+//   --seeks N           random seeks to check (default 20)
+//   --rebuild           index every segment again
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/orderbook.h"
+#include "storage/book_codec.h"
+#include "storage/journal_reader.h"
+#include "websocket/journal_indexer.h"
+#include "websocket/market_data_decoder.h"
+
+namespace {
+
+struct Options {
+    std::vector<std::string> inputs;
+    int64_t intervalNs = 1000000000;
+    size_t seeks = 20;
+    bool rebuild = false;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        if (arg == "--rebuild") {
+            options.rebuild = true;
+            continue;
+        }
+        if (arg.rfind("--", 0) != 0) {
+            options.inputs.push_back(arg);
+            continue;
+        }
+
+        const char* value = next();
+        if (!value) return false;
+
+        if (arg == "--interval-ms") options.intervalNs = std::atoll(value) * 1000000;
+        else if (arg == "--seeks") options.seeks = std::strtoull(value, nullptr, 10);
+        else return false;
+    }
+    return !options.inputs.empty() && options.intervalNs > 0;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool sameLevels(const core::PriceLevels& a, const core::PriceLevels& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].price != b[i].price || a[i].quantity != b[i].quantity) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Books rebuilt from raw frames or compacted blocks, whichever the records hold
+class Books {
+public:
+    struct Book {
+        std::shared_ptr<core::OrderBook> orderBook = std::make_shared<core::OrderBook>();
+        bool synced = false;
+    };
+
+    void applyKeyframes(const uint8_t* in, size_t bytes) {
+        const uint8_t* end = in + bytes;
+        while (in && in < end) {
+            in = decoder_.decode(in, end, frame_);
+            apply(frame_);
+        }
+    }
+
+    // Returns true as soon as the book of stopRoute reaches stopSeqId;
+    // the rest of the record is then left unapplied
+    bool apply(const storage::JournalRecord& record, uint64_t stopRoute = 0, int64_t stopSeqId = -2) {
+        if (record.type == storage::RecordType::FRAME) {
+            payload_.assign(record.payload.data(), record.payload.size());
+            if (processing::decodeMarketData(payload_, update_) != processing::MessageKind::BOOK) {
+                return false;
+            }
+            Book& book = books_[update_.route];
+            if (update_.snapshot) {
+                book.orderBook->update(update_.exchange, update_.symbol, update_.bids, update_.asks,
+                                       update_.timestamp, update_.seqId);
+                book.synced = true;
+            } else if (!book.orderBook->applyDelta(update_.bids, update_.asks, update_.timestamp,
+                                                   update_.prevSeqId, update_.seqId)) {
+                book.synced = false;
+            }
+            return update_.route == stopRoute && update_.seqId == stopSeqId;
+        }
+
+        const auto* in = reinterpret_cast<const uint8_t*>(record.payload.data());
+        const uint8_t* end = in + record.payload.size();
+        while (in && in < end) {
+            in = decoder_.decode(in, end, frame_);
+            const storage::BookStreamInfo* info = in ? apply(frame_) : nullptr;
+            if (info && info->route == stopRoute && frame_.seqId == stopSeqId) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::unordered_map<uint64_t, Book>& get() const { return books_; }
+
+    bool atSequence(uint64_t route, int64_t seqId) const {
+        auto it = books_.find(route);
+        return it != books_.end() && it->second.orderBook->getSequenceId() == seqId;
+    }
+
+private:
+    const storage::BookStreamInfo* apply(const storage::BookFrame& frame) {
+        const storage::BookStreamInfo* info = decoder_.getStream(frame.stream);
+        if (info) {
+            Book& book = books_[info->route];
+            book.synced = storage::applyFrame(frame, *info, *book.orderBook) && (book.synced || frame.isSnapshot());
+        }
+        return info;
+    }
+
+    std::unordered_map<uint64_t, Book> books_;
+    storage::BookDecoder decoder_;
+    storage::BookFrame frame_;
+    processing::BookUpdate update_;
+    std::string payload_;
+};
+
+struct BookState {
+    core::PriceLevels bids;
+    core::PriceLevels asks;
+    int64_t seqId = -1;
+};
+
+struct Target {
+    int64_t wallNs;
+    double scanSeconds = 0.0;  // reading from the start up to wallNs
+    std::unordered_map<uint64_t, BookState> expected; // synced books read from the start
+};
+
+void capture(const Books& books, std::unordered_map<uint64_t, BookState>& states) {
+    states.clear();
+    for (const auto& [route, book] : books.get()) {
+        if (book.synced) {
+            BookState& state = states[route];
+            book.orderBook->getTopLevels(std::numeric_limits<size_t>::max(), state.bids, state.asks);
+            state.seqId = book.orderBook->getSequenceId();
+        }
+    }
+}
+
+// Reads from a seek point up to (not including) the first record at or after
+// wallNs, or until the book of stopRoute reaches stopSeqId
+void readFrom(const std::vector<std::string>& segments, const processing::SeekPoint& point, int64_t wallNs,
+              Books& books, uint64_t stopRoute = 0, int64_t stopSeqId = -2) {
+    books.applyKeyframes(point.keyframes, point.keyframeBytes);
+    if (books.atSequence(stopRoute, stopSeqId)) {
+        return;
+    }
+    for (size_t i = point.segment; i < segments.size(); ++i) {
+        storage::JournalReader reader;
+        if (!reader.open(segments[i]) || (i == point.segment && !reader.seek(point.offset))) {
+            continue;
+        }
+        storage::JournalRecord record;
+        while (reader.next(record)) {
+            if (record.receivedNs + reader.getHeader().steadyToWallNs >= wallNs ||
+                books.apply(record, stopRoute, stopSeqId)) {
+                return;
+            }
+        }
+    }
+}
+
+// Returns false if a book differs; counts the books compared
+bool compareBooks(const std::unordered_map<uint64_t, BookState>& expected, const Books& actual, size_t& compared,
+                  uint64_t onlyRoute = 0) {
+    for (const auto& [route, state] : expected) {
+        if (onlyRoute != 0 && route != onlyRoute) {
+            continue;
+        }
+        ++compared;
+        auto it = actual.get().find(route);
+        if (it == actual.get().end() || !sameLevels(state.bids, it->second.orderBook->getBids()) ||
+            !sameLevels(state.asks, it->second.orderBook->getAsks())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int checkSegments(const std::string& label, const std::vector<std::string>& segments, const Options& options) {
+    processing::JournalIndexer indexer(options.intervalNs);
+    auto indexStart = std::chrono::steady_clock::now();
+    if (!indexer.open(segments, options.rebuild)) {
+        return 1;
+    }
+    double indexSeconds = secondsSince(indexStart);
+
+    size_t points = 0;
+    size_t sequences = 0;
+    uint64_t keyframeBytes = 0;
+    uint64_t indexBytes = 0;
+    uint64_t segmentBytes = 0;
+    int64_t firstWallNs = std::numeric_limits<int64_t>::max();
+    int64_t lastWallNs = std::numeric_limits<int64_t>::min();
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const auto& index = indexer.getIndexes()[i];
+        points += index.getPoints().size();
+        sequences += index.getSequenceCount();
+        keyframeBytes += index.getKeyframeBytes();
+        std::error_code ec;
+        segmentBytes += std::filesystem::file_size(segments[i], ec);
+        indexBytes += std::filesystem::file_size(storage::JournalIndex::pathFor(segments[i]), ec);
+
+        storage::JournalReader reader;
+        if (!index.getPoints().empty() && reader.open(segments[i])) {
+            int64_t steadyToWallNs = reader.getHeader().steadyToWallNs;
+            firstWallNs = std::min(firstWallNs, index.getPoints().front().receivedNs + steadyToWallNs);
+            lastWallNs = std::max(lastWallNs, index.getPoints().back().receivedNs + steadyToWallNs);
+        }
+    }
+    std::printf("%s: %zu segments (%zu indexed, %zu loaded) in %.2f s: %zu points, %zu sequence entries, "
+                "%.1f MB of keyframes, index %.2f%% of the journal\n",
+                label.c_str(), segments.size(), indexer.getBuiltCount(), segments.size() - indexer.getBuiltCount(),
+                indexSeconds, points, sequences, keyframeBytes / (1024.0 * 1024.0),
+                segmentBytes > 0 ? 100.0 * indexBytes / segmentBytes : 0.0);
+    if (points == 0 || options.seeks == 0) {
+        return 0;
+    }
+
+    // Reference books at each target, read from the start in one pass
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int64_t> pick(firstWallNs, lastWallNs + options.intervalNs);
+    std::vector<Target> targets(options.seeks);
+    for (auto& target : targets) {
+        target.wallNs = pick(rng);
+    }
+    std::sort(targets.begin(), targets.end(), [](const Target& a, const Target& b) { return a.wallNs < b.wallNs; });
+
+    {
+        Books scanned;
+        size_t next = 0;
+        auto scanStart = std::chrono::steady_clock::now();
+        for (const auto& path : segments) {
+            storage::JournalReader reader;
+            if (!reader.open(path)) {
+                continue;
+            }
+            storage::JournalRecord record;
+            while (next < targets.size() && reader.next(record)) {
+                for (int64_t wallNs = record.receivedNs + reader.getHeader().steadyToWallNs;
+                     next < targets.size() && targets[next].wallNs <= wallNs; ++next) {
+                    targets[next].scanSeconds = secondsSince(scanStart);
+                    capture(scanned, targets[next].expected);
+                }
+                scanned.apply(record);
+            }
+        }
+        for (; next < targets.size(); ++next) {
+            targets[next].scanSeconds = secondsSince(scanStart);
+            capture(scanned, targets[next].expected);
+        }
+    }
+
+    size_t matching = 0;
+    size_t compared = 0;
+    size_t sequenceChecks = 0;
+    size_t sequenceMatching = 0;
+    double seekSeconds = 0.0;
+    double scanSeconds = 0.0;
+    for (const auto& target : targets) {
+        auto seekStart = std::chrono::steady_clock::now();
+        processing::SeekPoint point;
+        Books sought;
+        if (indexer.seekTime(target.wallNs, point)) {
+            readFrom(segments, point, target.wallNs, sought);
+        }
+        seekSeconds += secondsSince(seekStart);
+        scanSeconds += target.scanSeconds;
+        matching += compareBooks(target.expected, sought, compared) ? 1 : 0;
+
+        // The same state again, found by one book's sequence number
+        for (const auto& [route, state] : target.expected) {
+            if (state.seqId < 0 || !indexer.seekSequence(route, state.seqId, point)) {
+                continue;
+            }
+            Books bySequence;
+            readFrom(segments, point, std::numeric_limits<int64_t>::max(), bySequence, route, state.seqId);
+            size_t ignored = 0;
+            ++sequenceChecks;
+            sequenceMatching += compareBooks(target.expected, bySequence, ignored, route) ? 1 : 0;
+            break;
+        }
+    }
+
+    std::printf("%s: seeks matching a full read: %zu/%zu (%zu books compared); by sequence number %zu/%zu\n",
+                label.c_str(), matching, targets.size(), compared, sequenceMatching, sequenceChecks);
+    std::printf("%s: %.2f ms per seek against %.2f ms reading from the start (%.0fx)\n", label.c_str(),
+                1e3 * seekSeconds / targets.size(), 1e3 * scanSeconds / targets.size(),
+                seekSeconds > 0.0 ? scanSeconds / seekSeconds : 0.0);
+    return matching == targets.size() && sequenceMatching == sequenceChecks ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: journal_index [--interval-ms N] [--seeks N] [--rebuild] DIR|SEGMENT...\n";
+        return 1;
+    }
+
+    // Raw captures and compacted journals are separate streams, each indexed on its own
+    int status = 0;
+    for (const auto& input : options.inputs) {
+        if (!std::filesystem::is_directory(input)) {
+            status |= checkSegments(input, {input}, options);
+            continue;
+        }
+        for (const char* prefix : {"feed", "book"}) {
+            auto segments = storage::JournalReader::listSegments(input, prefix);
+            if (!segments.empty()) {
+                status |= checkSegments(input + " (" + prefix + ")", segments, options);
+            }
+        }
+    }
+    return status;
+}
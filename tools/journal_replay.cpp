@@ -0,0 +1,163 @@
+// Replays captured feed journals through the live decode -> OrderBook ->
+// Simulator path and reports end-to-end throughput. With --speed max this is
+// the main pipeline benchmark.
+//
+// Usage: journal_replay [options] DIR|SEGMENT...
+//   --speed S        max (default), realtime, or a multiple such as 10x
+//   --config PATH    pipeline settings (default config.json; capture is ignored)
+//   --simulate       run the Simulator on every applied book update
+//   --repeat N       replay the input N times (default 1)
+//   --from TIME      start at a capture time, YYYY-MM-DDThh:mm:ss[.fff] UTC;
+//                    indexes segments (journal_index) on first use
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/config.h"
+#include "core/logger.h"
+#include "core/utils.h"
+#include "models/simulator.h"
+#include "storage/journal_reader.h"
+#include "websocket/journal_replayer.h"
+
+namespace {
+
+struct Options {
+    std::vector<std::string> inputs;
+    std::string speed = "max";
+    std::string configPath = "config.json";
+    bool simulate = false;
+    int repeat = 1;
+    int64_t fromWallNs = 0;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        if (arg == "--simulate") {
+            options.simulate = true;
+            continue;
+        }
+        if (arg.rfind("--", 0) != 0) {
+            options.inputs.push_back(arg);
+            continue;
+        }
+
+        const char* value = next();
+        if (!value) return false;
+
+        if (arg == "--speed") options.speed = value;
+        else if (arg == "--config") options.configPath = value;
+        else if (arg == "--repeat") options.repeat = std::atoi(value);
+        else if (arg == "--from") {
+            std::string time = value;
+            if (time.size() < 19) return false;
+            options.fromWallNs = core::utils::systemClockNanos(core::utils::parseISOTimestamp(time));
+        }
+        else return false;
+    }
+    return !options.inputs.empty() && options.repeat > 0;
+}
+
+std::vector<std::string> collectSegments(const std::vector<std::string>& inputs) {
+    std::vector<std::string> segments;
+    for (const auto& input : inputs) {
+        if (std::filesystem::is_directory(input)) {
+            auto found = storage::JournalReader::listSegments(input);
+            segments.insert(segments.end(), found.begin(), found.end());
+        } else {
+            segments.push_back(input);
+        }
+    }
+    return segments;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: journal_replay [--speed max|realtime|Nx] [--config PATH] [--simulate]\n"
+                     "                      [--repeat N] [--from TIME] DIR|SEGMENT...\n";
+        return 1;
+    }
+
+    double speed = processing::JournalReplayer::parseSpeed(options.speed);
+    if (speed < 0.0) {
+        std::cerr << "Unknown speed '" << options.speed << "'\n";
+        return 1;
+    }
+
+    std::vector<std::string> segments = collectSegments(options.inputs);
+    if (segments.empty()) {
+        std::cerr << "No journal segments found\n";
+        return 1;
+    }
+
+    auto config = std::make_shared<core::Config>();
+    if (!config->load(options.configPath)) {
+        std::cerr << "Could not load " << options.configPath << "\n";
+        return 1;
+    }
+    core::Logger::getInstance().init();
+    core::Logger::getInstance().setLevel(config->getLogLevel());
+
+    // Built from the individual settings so a capture-enabled config does not re-record the replay
+    auto processor = std::make_shared<processing::MessageProcessor>(
+        config->getProcessingThreads(),
+        processing::MessageProcessor::parseQueueType(config->getQueueType()),
+        processing::WaitStrategy::parseType(config->getWaitStrategy()),
+        config->getSpinIterations());
+
+    models::Simulator simulator(config);
+    std::mutex simulatorMutex;
+    uint64_t simulations = 0;
+    if (options.simulate) {
+        simulator.init();
+        // Workers call in concurrently; the simulator's parameters are shared
+        processor->setBookUpdateHandler([&](const std::shared_ptr<core::OrderBook>& orderBook) {
+            std::lock_guard<std::mutex> lock(simulatorMutex);
+            simulator.simulate(orderBook);
+            ++simulations;
+        });
+    }
+    processor->start();
+
+    processing::JournalReplayer replayer(processor);
+    std::printf("%zu segments, speed %s, %d processing threads%s\n", segments.size(), options.speed.c_str(),
+                config->getProcessingThreads(), options.simulate ? ", simulating" : "");
+    std::printf("%-5s %12s %10s %10s %12s %10s\n", "run", "messages", "wall s", "capture s", "msg/s", "MB/s");
+
+    processing::ReplayStats lastStats;
+    for (int run = 1; run <= options.repeat; ++run) {
+        processing::ReplayStats stats = replayer.replay(segments, speed, options.fromWallNs);
+        std::printf("%-5d %12llu %10.3f %10.3f %12.0f %10.1f\n", run,
+                    static_cast<unsigned long long>(stats.messages), stats.wallSeconds, stats.capturedSeconds,
+                    stats.messagesPerSecond, stats.megabytesPerSecond);
+        lastStats = stats;
+    }
+
+    if (options.fromWallNs > 0) {
+        std::printf("seek: %.3f s to the index point, %llu books seeded, %llu frames to catch up (last run)\n",
+                    lastStats.seekSeconds, static_cast<unsigned long long>(lastStats.keyframes),
+                    static_cast<unsigned long long>(lastStats.caughtUp));
+    }
+
+    processing::FeedLatency latency = processor->getFeedLatency();
+    std::printf("receive->applied p50 %.1f us, p99 %.1f us; %llu book updates, %llu sequence gaps, %llu simulations\n",
+                latency.receiveToApplied.p50, latency.receiveToApplied.p99,
+                static_cast<unsigned long long>(processor->getProcessedCount()),
+                static_cast<unsigned long long>(processor->getSequenceGapCount()),
+                static_cast<unsigned long long>(simulations));
+
+    processor->stop();
+    return 0;
+}
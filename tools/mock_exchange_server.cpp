@@ -0,0 +1,274 @@
+// Local stand-in for the gomarket L2 feed, for offline and reproducible
+// benchmarking of the WebSocket path.
+//
+// Streams recorded frames (one JSON message per line) or synthetic OKX book
+// snapshots to every client at a fixed rate, with optional bursts and forced
+// disconnects. Point the client at it from config.json, e.g.
+//   "endpoint": "ws://127.0.0.1:9443/ws/l2-orderbook/okx/BTC-USDT-SWAP"
+//
+// Usage: mock_exchange_server [options]
+//   --port N                listen port (default 9443)
+//   --tls CERT KEY          serve wss:// with the given PEM certificate and key
+//   --file PATH             replay recorded frames from PATH, looping
+//   --symbol SYM            instrument for synthetic frames (default BTC-USDT-SWAP)
+//   --levels N              depth per side for synthetic frames (default 50)
+//   --rate N                messages per second, 0 = as fast as possible (default 100)
+//   --burst-every MS        every MS milliseconds...
+//   --burst-size N          ...send N extra frames back to back
+//   --disconnect-every MS   drop each connection after MS milliseconds
+//   --max-messages N        stop each connection after N frames (0 = unlimited)
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+#include "core/utils.h"
+
+namespace {
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+using tcp = net::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    unsigned short port = 9443;
+    std::string certFile;
+    std::string keyFile;
+    std::string recordFile;
+    std::string symbol = "BTC-USDT-SWAP";
+    int levels = 50;
+    double rate = 100.0;
+    int burstEveryMs = 0;
+    int burstSize = 0;
+    int disconnectEveryMs = 0;
+    uint64_t maxMessages = 0;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* value = nullptr;
+
+        if (arg == "--tls") {
+            const char* cert = next();
+            const char* key = next();
+            if (!cert || !key) return false;
+            options.certFile = cert;
+            options.keyFile = key;
+            continue;
+        }
+
+        value = next();
+        if (!value) return false;
+
+        if (arg == "--port") options.port = static_cast<unsigned short>(std::atoi(value));
+        else if (arg == "--file") options.recordFile = value;
+        else if (arg == "--symbol") options.symbol = value;
+        else if (arg == "--levels") options.levels = std::atoi(value);
+        else if (arg == "--rate") options.rate = std::atof(value);
+        else if (arg == "--burst-every") options.burstEveryMs = std::atoi(value);
+        else if (arg == "--burst-size") options.burstSize = std::atoi(value);
+        else if (arg == "--disconnect-every") options.disconnectEveryMs = std::atoi(value);
+        else if (arg == "--max-messages") options.maxMessages = std::strtoull(value, nullptr, 10);
+        else return false;
+    }
+    return true;
+}
+
+// Produces the next frame, either from a recording or synthesised around a random-walk mid
+class FrameSource {
+public:
+    FrameSource(const Options& options, const std::vector<std::string>& recorded)
+        : options_(options), recorded_(recorded), rng_(42) {}
+
+    const std::string& next() {
+        if (!recorded_.empty()) {
+            const std::string& frame = recorded_[index_];
+            index_ = (index_ + 1) % recorded_.size();
+            return frame;
+        }
+
+        std::uniform_real_distribution<double> drift(-0.5, 0.5);
+        std::uniform_real_distribution<double> qty(0.001, 5.0);
+        mid_ += drift(rng_);
+
+        // Stamp with send time so the client can measure exchange -> receive latency
+        char level[64];
+        frame_ = "{\"timestamp\":\"" + core::utils::formatTimestamp(core::utils::currentTime()) +
+                 "\",\"exchange\":\"OKX\",\"symbol\":\"" + options_.symbol + "\",\"asks\":[";
+        for (int i = 0; i < options_.levels; ++i) {
+            std::snprintf(level, sizeof(level), "%s[\"%.1f\",\"%.3f\"]", i ? "," : "", mid_ + 0.1 * (i + 1), qty(rng_));
+            frame_ += level;
+        }
+        frame_ += "],\"bids\":[";
+        for (int i = 0; i < options_.levels; ++i) {
+            std::snprintf(level, sizeof(level), "%s[\"%.1f\",\"%.3f\"]", i ? "," : "", mid_ - 0.1 * (i + 1), qty(rng_));
+            frame_ += level;
+        }
+        frame_ += "]}";
+        return frame_;
+    }
+
+private:
+    const Options& options_;
+    const std::vector<std::string>& recorded_;
+    size_t index_ = 0;
+    std::mt19937 rng_;
+    double mid_ = 95000.0;
+    std::string frame_;
+};
+
+template <typename Stream>
+void streamFrames(websocket::stream<Stream>& ws, const Options& options,
+                  const std::vector<std::string>& recorded, int connectionId) {
+    FrameSource source(options, recorded);
+    auto start = Clock::now();
+    auto interval = options.rate > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate))
+        : Clock::duration::zero();
+    auto nextSend = start;
+    auto nextBurst = start + std::chrono::milliseconds(options.burstEveryMs);
+    uint64_t sent = 0;
+
+    while (options.maxMessages == 0 || sent < options.maxMessages) {
+        auto now = Clock::now();
+
+        if (options.disconnectEveryMs > 0 && now - start >= std::chrono::milliseconds(options.disconnectEveryMs)) {
+            // Drop without a close frame, like a network failure
+            std::printf("[%d] injecting disconnect after %llu frames\n", connectionId,
+                        static_cast<unsigned long long>(sent));
+            beast::get_lowest_layer(ws).close();
+            return;
+        }
+
+        int frames = 1;
+        if (options.burstEveryMs > 0 && now >= nextBurst) {
+            frames += options.burstSize;
+            nextBurst += std::chrono::milliseconds(options.burstEveryMs);
+        }
+
+        for (int i = 0; i < frames; ++i) {
+            ws.write(net::buffer(source.next()));
+            ++sent;
+        }
+
+        if (interval > Clock::duration::zero()) {
+            nextSend += interval;
+            std::this_thread::sleep_until(nextSend);
+        }
+    }
+
+    std::printf("[%d] sent %llu frames, closing\n", connectionId, static_cast<unsigned long long>(sent));
+    ws.close(websocket::close_code::normal);
+}
+
+template <typename Stream>
+void acceptAndStream(websocket::stream<Stream>& ws, const Options& options,
+                     const std::vector<std::string>& recorded, int connectionId) {
+    // Accept compression if the client offers it
+    websocket::permessage_deflate pmd;
+    pmd.server_enable = true;
+    ws.set_option(pmd);
+
+    ws.accept();
+    streamFrames(ws, options, recorded, connectionId);
+}
+
+void serveConnection(tcp::socket socket, ssl::context* ctx, const Options& options,
+                     const std::vector<std::string>& recorded, int connectionId) {
+    try {
+        if (ctx) {
+            websocket::stream<beast::ssl_stream<tcp::socket>> ws(std::move(socket), *ctx);
+            ws.next_layer().handshake(ssl::stream_base::server);
+            acceptAndStream(ws, options, recorded, connectionId);
+        } else {
+            websocket::stream<tcp::socket> ws(std::move(socket));
+            acceptAndStream(ws, options, recorded, connectionId);
+        }
+    } catch (const std::exception& e) {
+        std::printf("[%d] connection ended: %s\n", connectionId, e.what());
+    }
+}
+
+std::vector<std::string> loadRecording(const std::string& path) {
+    std::vector<std::string> frames;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            frames.push_back(line);
+        }
+    }
+    return frames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: mock_exchange_server [--port N] [--tls CERT KEY] [--file PATH] [--symbol SYM]\n"
+                     "                            [--levels N] [--rate N] [--burst-every MS] [--burst-size N]\n"
+                     "                            [--disconnect-every MS] [--max-messages N]\n";
+        return 1;
+    }
+
+    // Connection events from several threads, flushed as they happen
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    std::vector<std::string> recorded;
+    if (!options.recordFile.empty()) {
+        recorded = loadRecording(options.recordFile);
+        if (recorded.empty()) {
+            std::cerr << "No frames in " << options.recordFile << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        std::unique_ptr<ssl::context> ctx;
+        if (!options.certFile.empty()) {
+            ctx = std::make_unique<ssl::context>(ssl::context::tls_server);
+            ctx->use_certificate_chain_file(options.certFile);
+            ctx->use_private_key_file(options.keyFile, ssl::context::pem);
+        }
+
+        net::io_context ioc;
+        tcp::acceptor acceptor(ioc, tcp::endpoint(tcp::v4(), options.port));
+        std::printf("Mock exchange listening on %s://127.0.0.1:%u (%s, %.0f msg/s)\n",
+                    ctx ? "wss" : "ws", options.port,
+                    recorded.empty() ? "synthetic" : options.recordFile.c_str(), options.rate);
+
+        // One thread per client keeps pacing independent across connections
+        int connectionId = 0;
+        for (;;) {
+            tcp::socket socket(ioc);
+            acceptor.accept(socket);
+            socket.set_option(tcp::no_delay(true));
+            std::printf("[%d] client connected\n", ++connectionId);
+            std::thread(serveConnection, std::move(socket), ctx.get(), std::cref(options),
+                        std::cref(recorded), connectionId).detach();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Mock exchange failed: " << e.what() << "\n";
+        return 1;
+    }
+}